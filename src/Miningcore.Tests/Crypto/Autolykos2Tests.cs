@@ -0,0 +1,56 @@
+using System.Linq;
+using Miningcore.Blockchain.Ergo;
+using Miningcore.Extensions;
+using Miningcore.Native;
+using Miningcore.Tests.Util;
+using Xunit;
+
+namespace Miningcore.Tests.Crypto;
+
+public unsafe class Autolykos2Tests : TestBase
+{
+    // msg[i] = i * 7 + 1 followed by the nonce 0011223344556677
+    private static readonly byte[] coinbase = Enumerable.Range(0, 32)
+        .Select(i => (byte) (i * 7 + 1))
+        .Concat("0011223344556677".HexToByteArray())
+        .ToArray();
+
+    private static bool Verify(uint height, byte[] target, byte[] hit)
+    {
+        fixed (byte* coinbasePtr = coinbase)
+        {
+            fixed (byte* targetPtr = target)
+            {
+                fixed (byte* hitPtr = hit)
+                {
+                    return Multihash.autolykos2_verify(coinbasePtr, (uint) coinbase.Length, height, ErgoJob.CalcN(height), targetPtr, hitPtr);
+                }
+            }
+        }
+    }
+
+    [Theory]
+    [InlineData(500000, "6a3b0591e4b7fd9eccf2d2c3c20d73e262e7700d32c0bd9c56456b7e876d91a5")]
+    [InlineData(1234567, "127695a908aa5c3728873e467373014f708ccf85ff9a03e88278ed55cc5b417f")]
+    [InlineData(9300000, "7515eda361d611766eaca51fe7d043636ac7ec1325c86569192e85809aabfc0c")]
+    public void Autolykos2_Verify_Hit(uint height, string expected)
+    {
+        var hit = new byte[32];
+        var target = Enumerable.Repeat((byte) 0xff, 32).ToArray();
+
+        Assert.True(Verify(height, target, hit));
+        Assert.Equal(expected, hit.ToHexString());
+    }
+
+    [Fact]
+    public void Autolykos2_Verify_Rejects_Hit_Equal_To_Target()
+    {
+        var hit = new byte[32];
+        var target = "127695a908aa5c3728873e467373014f708ccf85ff9a03e88278ed55cc5b417f".HexToByteArray();
+
+        Assert.False(Verify(1234567, target, hit));
+
+        target[31]++;
+        Assert.True(Verify(1234567, target, hit));
+    }
+}
@@ -199,4 +199,13 @@ public class Blake3Tests : TestBase
         
         Assert.NotEqual(hash1.ToHexString(), hash2.ToHexString());
     }
+
+    [Fact]
+    public void Blake3_Reports_Backend()
+    {
+        var backends = new[] { "avx512", "avx2", "sse41", "sse2", "neon", "portable" };
+
+        Assert.Contains(Native.Blake3.Backend, backends);
+        Assert.True(Native.Blake3.GetSimdLanes() >= 1);
+    }
 }
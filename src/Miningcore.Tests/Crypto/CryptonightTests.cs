@@ -22,6 +22,36 @@ public class CryptonightTests : TestBase
         Assert.True(ctx.IsValid);
     }
 
+    [Fact]
+    public void Crytonight_Context_HugePages_Info()
+    {
+        using(var ctx = new Cryptonight.Context())
+        {
+            // force lazy handle creation
+            var foo = ctx.Handle;
+
+            var (allocated, total) = Cryptonight.GetHugePagesInfo();
+
+            // a 20 MB scratchpad spans ten 2 MB pages
+            Assert.True(total >= 10);
+            Assert.True(allocated <= total);
+        }
+    }
+
+    [Fact]
+    public void Crytonight_Context_Memory_Pool_Info()
+    {
+        using(var ctx = new Cryptonight.Context())
+        {
+            // force lazy handle creation
+            var foo = ctx.Handle;
+
+            var (pooled, fallback, _) = Cryptonight.GetMemoryPoolInfo();
+
+            Assert.True(pooled + fallback >= 1);
+        }
+    }
+
     [Fact]
     public void Crytonight_Hash_CN_0()
     {
@@ -88,6 +118,26 @@ public class CryptonightTests : TestBase
         Assert.Equal("f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc", result);
     }
 
+    [Fact]
+    public void Crytonight_Hash_CN_R_Alternating_Heights()
+    {
+        var vectors = new[]
+        {
+            (Height: 1806260ul, Input: "5468697320697320612074657374205468697320697320612074657374205468697320697320612074657374", Expected: "f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc"),
+            (Height: 1806261ul, Input: "4c6f72656d20697073756d20646f6c6f722073697420616d65742c20636f6e73656374657475722061646970697363696e67", Expected: "5bb833deca2bdd7252a9ccd7b4ce0b6a4854515794b56c207262f7a5b9bdb566"),
+            (Height: 1806262ul, Input: "656c69742c2073656420646f20656975736d6f642074656d706f7220696e6369646964756e74207574206c61626f7265", Expected: "1ee6728da60fbd8d7d55b2b1ade487a3cf52a2c3ac6f520db12c27d8921f6cab"),
+        };
+
+        // revisit each height so compiled programs get served from the cache
+        foreach(var vector in vectors.Concat(vectors.Reverse()))
+        {
+            var hash = new byte[32];
+            Cryptonight.CryptonightHash(vector.Input.HexToByteArray(), hash, CN_R, vector.Height);
+
+            Assert.Equal(vector.Expected, hash.ToHexString());
+        }
+    }
+
     [Fact]
     public void Crytonight_Hash_CN_RTO()
     {
@@ -276,4 +326,44 @@ public class CryptonightTests : TestBase
         Assert.Equal("35e083d4b9c64c2a68820a431f61311998a8cd1864dba4077e25b7f121d54bd1", result);
     }
 
+    [Fact]
+    public void AstroBWT_Hash()
+    {
+        var value = "0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601".HexToByteArray();
+
+        // the multi-threaded sort must produce the same suffix array
+        foreach(var sortThreads in new[] { 1, 3 })
+        {
+            var hash = new byte[32];
+            Cryptonight.AstroBWTHash(value, hash, sortThreads);
+
+            Assert.Equal("7e8844f2d6b7a43498fe6d226527689023da8a52f9fc4ec69e5aaaa63edce1c1", hash.ToHexString());
+        }
+    }
+
+    [Fact]
+    public void Argon_Implementation_Selectable()
+    {
+        var value = "0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601".HexToByteArray();
+        var selected = Cryptonight.GetArgon2Implementation();
+
+        Assert.False(string.IsNullOrEmpty(selected));
+        Assert.False(Cryptonight.SetArgon2Implementation("bogus"));
+
+        try
+        {
+            // the portable implementation must agree with the optimized one
+            Assert.True(Cryptonight.SetArgon2Implementation("x86_64"));
+
+            var hash = new byte[32];
+            Cryptonight.ArgonHash(value, hash, AR2_CHUKWA, 10);
+
+            Assert.Equal("c158a105ae75c7561cfd029083a47a87653d51f914128e21c1971d8b10c49034", hash.ToHexString());
+        }
+        finally
+        {
+            Cryptonight.SetArgon2Implementation(selected);
+        }
+    }
+
 }
@@ -1,4 +1,6 @@
 using System;
+using System.Collections.Generic;
+using System.Linq;
 using Miningcore.Extensions;
 using Miningcore.Native;
 using Xunit;
@@ -16,6 +18,75 @@ public class CrytonoteTests : TestBase
         Assert.Equal("0106e5b3afd505583cf50bcc743d04d831d2b119dc94ad88679e359076ee3f18d258ee138b3b421c0300a4487286e262e95b8d2163a0c8b73527e8c9425adbdc4e532cf0ef4241f9ffbe9e01", result);
     }
 
+    [Fact]
+    public void Crytonote_HashingBlobTemplate_Should_Match_ConvertBlob()
+    {
+        var blob = "0106e5b3afd505583cf50bcc743d04d831d2b119dc94ad88679e359076ee3f18d258ee138b3b421c0300a401d90101ff9d0106d6d6a88702023c62e43372a58cb588147e20be53a27083f5c522f33c722b082ab7518c48cda280b4c4c32102609ec96e2499ee267d70efefc49f26e330526d3ef455314b7b5ba268a6045f8c80c0fc82aa0202fe5cc0fa56c4277d1a47827edce4725571529d57f33c73ada481ef84c323f30a8090cad2c60e02d88bf5e72a611c8b8464ce29e3b1adbfe1ae163886d9150fe511171cada98fcb80e08d84ddcb0102441915aaf9fbaf70ff454c701a6ae2bd59bb94dc0b888bf7e5d06274ee9238ca80c0caf384a302024078526e2132def44bde2806242652f5944e632f7d94290dd6ee5dda1929f5ee2b016e29f25f07ec2a8df59f0e118a6c9a4b769b745dc0c729071f6e0399d2585745020800000000012e7f76".HexToByteArray();
+
+        // the 8-byte extra nonce of the miner tx extra
+        const int reservedOffset = 321;
+
+        using var tmpl = CryptonoteBindings.HashingBlobTemplate.Create(blob, reservedOffset, 8);
+        Assert.NotNull(tmpl);
+
+        var extraNonce = new byte[] { 0x01, 0x02, 0x03, 0x04 };
+        var nonce = new byte[] { 0xaa, 0xbb, 0xcc, 0xdd };
+        var result = new byte[tmpl.Size];
+
+        tmpl.GetHashingBlob(extraNonce, nonce, result);
+
+        extraNonce.CopyTo(blob, reservedOffset);
+        nonce.CopyTo(blob, 39);
+
+        Assert.Equal(CryptonoteBindings.ConvertBlob(blob, blob.Length).ToHexString(), result.ToHexString());
+
+        // outside the miner tx
+        Assert.Null(CryptonoteBindings.HashingBlobTemplate.Create(blob, 10, 4));
+    }
+
+    [Theory]
+    [InlineData(1)]
+    [InlineData(3)]
+    [InlineData(100)]
+    public void Crytonote_HashingBlobTemplate_Should_Match_ConvertBlob_With_Transactions(int txCount)
+    {
+        var template = "0106e5b3afd505583cf50bcc743d04d831d2b119dc94ad88679e359076ee3f18d258ee138b3b421c0300a401d90101ff9d0106d6d6a88702023c62e43372a58cb588147e20be53a27083f5c522f33c722b082ab7518c48cda280b4c4c32102609ec96e2499ee267d70efefc49f26e330526d3ef455314b7b5ba268a6045f8c80c0fc82aa0202fe5cc0fa56c4277d1a47827edce4725571529d57f33c73ada481ef84c323f30a8090cad2c60e02d88bf5e72a611c8b8464ce29e3b1adbfe1ae163886d9150fe511171cada98fcb80e08d84ddcb0102441915aaf9fbaf70ff454c701a6ae2bd59bb94dc0b888bf7e5d06274ee9238ca80c0caf384a302024078526e2132def44bde2806242652f5944e632f7d94290dd6ee5dda1929f5ee2b016e29f25f07ec2a8df59f0e118a6c9a4b769b745dc0c729071f6e0399d2585745020800000000012e7f76".HexToByteArray();
+        const int reservedOffset = 321;
+
+        // append the varint count and the transaction hashes
+        var blob = new List<byte>(template);
+
+        for(var v = (uint) txCount; ; v >>= 7)
+        {
+            blob.Add((byte) (v >= 0x80 ? (v & 0x7f) | 0x80 : v));
+
+            if(v < 0x80)
+                break;
+        }
+
+        var random = new Random(txCount);
+        var txHashes = new byte[txCount * 32];
+        random.NextBytes(txHashes);
+        blob.AddRange(txHashes);
+
+        var blobBytes = blob.ToArray();
+
+        using var tmpl = CryptonoteBindings.HashingBlobTemplate.Create(blobBytes, reservedOffset, 4);
+        Assert.NotNull(tmpl);
+
+        var result = new byte[tmpl.Size];
+
+        for(var i = 0; i < 10; i++)
+        {
+            var extraNonce = BitConverter.GetBytes(i * 7919);
+            tmpl.GetHashingBlob(extraNonce, ReadOnlySpan<byte>.Empty, result);
+
+            extraNonce.CopyTo(blobBytes, reservedOffset);
+
+            Assert.Equal(CryptonoteBindings.ConvertBlob(blobBytes, blobBytes.Length).ToHexString(), result.ToHexString());
+        }
+    }
+
     [Fact]
     public void Crytonote_DecodeAddress()
     {
@@ -50,6 +121,35 @@ public class CrytonoteTests : TestBase
         Assert.Equal(19ul, result);
     }
 
+    [Fact]
+    public void Crytonote_DecodeAddresses_Should_Match_Single_Decodes()
+    {
+        var addresses = new[]
+        {
+            "48nhyWcSey31ngSEhV8j8NPm6B8PistCQJBjjDjmTvRSTWYg6iocAw131vE2JPh3ps33vgQDKLrUx3fcErusYWcMJBxpm1d",
+            "84k5FLcuZeQ9vUmTfRJkpxCxdppVF5wWdPpxhU4SdTZmAD1i1YH81rPf8XRAsbpc7Na4GG7A8xscjQbqMETLZCXZ7Cdfb7X",
+            "4BrL51JCc9NGQ71kWhnYoDRffsDZy7m1HUU7MRU4nUMXAHNFBEJhkTZV9HdaL4gfuNBxLPc3BeMkLGaPbF5vWtANQsGwTGg55Kq4p3ENE7",
+            "not an address",
+            // longer than any address, turned down before the cache
+            string.Concat(Enumerable.Repeat("4BrL51JCc9NGQ71kWhnYoDRffsDZy7m1HUU7MRU4nUMXAHNFBEJhkTZV9HdaL4gfuNBxLPc3BeMkLGaPbF5vWtANQsGwTGg55Kq4p3ENE7", 2)),
+        };
+
+        // enough to be spread over several threads
+        var batch = Enumerable.Range(0, 1000).Select(i => addresses[i % addresses.Length]).ToArray();
+        var result = CryptonoteBindings.DecodeAddresses(batch);
+
+        for(var i = 0; i < batch.Length; i++)
+        {
+            Assert.Equal(CryptonoteBindings.DecodeAddress(batch[i]), result[i].AddressPrefix);
+            Assert.Equal(CryptonoteBindings.DecodeIntegratedAddress(batch[i]), result[i].IntegratedAddressPrefix);
+        }
+
+        Assert.Equal((18ul, 0ul), result[0]);
+        Assert.Equal((0ul, 19ul), result[2]);
+        Assert.Equal((0ul, 0ul), result[3]);
+        Assert.Equal((0ul, 0ul), result[4]);
+    }
+
     [Fact]
     public void Cryptonote_CryptonightHashFast()
     {
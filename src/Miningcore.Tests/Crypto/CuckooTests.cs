@@ -0,0 +1,87 @@
+using System.Linq;
+using Miningcore.Native;
+using Miningcore.Tests.Util;
+using Xunit;
+using static Miningcore.Native.Cuckoo;
+
+namespace Miningcore.Tests.Crypto;
+
+public class CuckooTests : TestBase
+{
+    // blake2b-256 of the 76 byte header[i] = i * 7 + 1 with the little-endian nonce 15 at offset 39,
+    // and a 32-cycle of its graph solved offline; no C29s mainnet header and solution ship with the tree
+    private static readonly SipHashKeys c29sKeys = new()
+    {
+        K0 = 0xed61d9410fd2a565,
+        K1 = 0x85bc237c0cee255f,
+        K2 = 0x2202287d9e6045b9,
+        K3 = 0xe6260b1458d3463a,
+    };
+
+    private static readonly uint[] c29sCycle =
+    {
+        0x8b8634, 0x100fde6, 0x2be2791, 0x3c3223b, 0x3ce429a, 0x450b33b, 0x47c5d01, 0x5cf8e7b,
+        0x7506c07, 0x80a801e, 0x81ac93a, 0x9878d30, 0x9a2c377, 0xa32202d, 0xb8b132d, 0xdad723a,
+        0xddab58e, 0xee98fea, 0xf02283c, 0xf135d8d, 0xf5c76d0, 0x104e2c89, 0x10e7601e, 0x165aaf58,
+        0x190514ea, 0x19851469, 0x1b1cff18, 0x1c100c5a, 0x1c3e81ff, 0x1cf9d57d, 0x1e92f288, 0x1f80a71a,
+    };
+
+    private static uint[] MakeProofs(int proofSize, params int[] steps)
+    {
+        return steps.SelectMany(step => Enumerable.Range(0, proofSize).Select(i => (uint) (i * step + 7))).ToArray();
+    }
+
+    [Fact]
+    public void C29s_Verify_Batch_Accepts_Valid_Cycle()
+    {
+        var tampered = c29sCycle.ToArray();
+        tampered[7]++;
+
+        var edges = c29sCycle.Concat(tampered).ToArray();
+        var keys = new[] { c29sKeys, c29sKeys };
+        var results = new VerifyCode[2];
+        VerifyBatch(Variant.C29s, edges, keys, results);
+
+        Assert.Equal(new[] { VerifyCode.Ok, VerifyCode.NonMatching }, results);
+    }
+
+    [Fact]
+    public void C29s_Verify_Batch_Rejects_Malformed_Proofs()
+    {
+        var edges = MakeProofs(32, 1000, 1000, 1000, 2000);
+        edges[32 + 31] = 1u << 29;
+        edges[64 + 5] = 1;
+
+        var keys = new SipHashKeys[4];
+        var results = new VerifyCode[4];
+        VerifyBatch(Variant.C29s, edges, keys, results);
+
+        Assert.Equal(new[] { VerifyCode.NonMatching, VerifyCode.TooBig, VerifyCode.TooSmall, VerifyCode.NonMatching }, results);
+    }
+
+    [Fact]
+    public void C29v_Verify_Batch_Rejects_Unbalanced_Proofs()
+    {
+        // all edges odd, so the 17th edge exceeds its direction's share of the cycle
+        var edges = MakeProofs(32, 1000, 1000);
+        edges[32 + 5] = 1;
+
+        var keys = new SipHashKeys[2];
+        var results = new VerifyCode[2];
+        VerifyBatch(Variant.C29v, edges, keys, results);
+
+        Assert.Equal(new[] { VerifyCode.Unbalanced, VerifyCode.TooSmall }, results);
+    }
+
+    [Fact]
+    public void C29b_Verify_Batch_Uses_Variant_Proof_Size()
+    {
+        var edges = MakeProofs(GetProofSize(Variant.C29b), 1000);
+
+        var keys = new SipHashKeys[1];
+        var results = new VerifyCode[1];
+        VerifyBatch(Variant.C29b, edges, keys, results);
+
+        Assert.Equal(VerifyCode.NonMatching, results[0]);
+    }
+}
@@ -0,0 +1,53 @@
+using System.Linq;
+using Miningcore.Extensions;
+using Miningcore.Native;
+using Miningcore.Tests.Util;
+using Xunit;
+using static Miningcore.Native.KawPow;
+
+namespace Miningcore.Tests.Crypto;
+
+public class KawPowTests : TestBase
+{
+    private const int BlockNumber = 100;
+    private const ulong Nonce = 0x1122334455667788;
+    private const string FinalHash = "60b7b1368aa216f57e7324d1153d488ecf36b44b5a374bc2e126fd75d2903fe8";
+    private const string MixHash = "782647e3b4fa936f3de952763e99fcdc9ad0cd8df4c9c15a6991560f39f829af";
+
+    private static readonly byte[] headerHash = Enumerable.Range(0, 32).Select(i => (byte) (i * 7 + 1)).ToArray();
+
+    [Fact]
+    public void KawPow_Verify_Valid_Share()
+    {
+        var finalHash = new byte[32];
+        var result = Verify(BlockNumber, headerHash, Nonce, MixHash.HexToByteArray(), FinalHash.HexToByteArray(), finalHash);
+
+        Assert.Equal(VerifyCode.Ok, result);
+        Assert.Equal(FinalHash, finalHash.ToHexString());
+    }
+
+    [Fact]
+    public void KawPow_Verify_Above_Boundary()
+    {
+        var boundary = FinalHash.HexToByteArray();
+        boundary[31]--;
+
+        var finalHash = new byte[32];
+        var result = Verify(BlockNumber, headerHash, Nonce, MixHash.HexToByteArray(), boundary, finalHash);
+
+        Assert.Equal(VerifyCode.AboveBoundary, result);
+        Assert.Equal(FinalHash, finalHash.ToHexString());
+    }
+
+    [Fact]
+    public void KawPow_Verify_Rejects_Forged_Mix()
+    {
+        var mixHash = MixHash.HexToByteArray();
+        mixHash[5] ^= 0x10;
+
+        var boundary = Enumerable.Repeat((byte) 0xff, 32).ToArray();
+        var result = Verify(BlockNumber, headerHash, Nonce, mixHash, boundary, new byte[32]);
+
+        Assert.Equal(VerifyCode.MixMismatch, result);
+    }
+}
@@ -1,4 +1,5 @@
 using System;
+using System.Linq;
 using System.Text;
 using Miningcore.Extensions;
 using Miningcore.Native;
@@ -87,4 +88,22 @@ public class RandomARQTests : TestBase
 
         RandomARQ.DeleteSeed(realm, seedHex);
     }
+
+    [Fact]
+    public void CalculateHashOnSeed()
+    {
+        var buf = new byte[32];
+
+        RandomARQ.CreateSeed(realm, seedHex);
+        var seed = RandomARQ.GetSeed(realm, seedHex);
+
+        RandomARQ.CalculateHash(seed, input2, buf);
+        Assert.Equal(hashExpected2, buf.ToHexString());
+
+        RandomARQ.DeleteSeed(realm, seedHex);
+
+        // the deleted seed's handle is closed, the result is cleared
+        RandomARQ.CalculateHash(seed, input1, buf);
+        Assert.True(buf.All(x => x == 0));
+    }
 }
@@ -87,4 +87,49 @@ public class RandomXTests : TestBase
 
         RandomX.DeleteSeed(realm, seedHex);
     }
+
+    [Fact]
+    public void CalculateHashOnSeed()
+    {
+        var buf = new byte[32];
+
+        RandomX.CreateSeed(realm, seedHex);
+        var seed = RandomX.GetSeed(realm, seedHex);
+
+        RandomX.CalculateHash(seed, input2, buf);
+        Assert.Equal(hashExpected2, buf.ToHexString());
+
+        RandomX.DeleteSeed(realm, seedHex);
+
+        // the deleted seed's handle is closed, the result is cleared
+        RandomX.CalculateHash(seed, input1, buf);
+        Assert.True(buf.All(x => x == 0));
+    }
+
+    [Fact]
+    public void PrepareAndActivateSeed()
+    {
+        var nextSeedHex = Encoding.UTF8.GetBytes("test key 001").ToHexString();
+        var buf = new byte[32];
+
+        RandomX.ActivateSeed(realm, seedHex);
+        RandomX.PrepareSeed(realm, nextSeedHex);
+
+        // the active seed keeps hashing while the next one is prepared
+        RandomX.CalculateHash(realm, seedHex, input1, buf);
+        Assert.Equal(hashExpected1, buf.ToHexString());
+
+        // switching retires the previous seed
+        RandomX.ActivateSeed(realm, nextSeedHex);
+        Assert.NotNull(RandomX.GetSeed(realm, nextSeedHex));
+        Assert.Null(RandomX.GetSeed(realm, seedHex));
+
+        // a seed prepared for a switch that never came is released by the next activation
+        RandomX.CreateSeed(realm, seedHex);
+        RandomX.ActivateSeed(realm, nextSeedHex);
+        Assert.Null(RandomX.GetSeed(realm, seedHex));
+        Assert.Equal(1, RandomX.realms[realm].Count);
+
+        RandomX.DeleteSeed(realm, nextSeedHex);
+    }
 }
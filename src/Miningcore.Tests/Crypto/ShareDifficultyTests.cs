@@ -0,0 +1,75 @@
+using System;
+using System.Linq;
+using Miningcore.Blockchain.Bitcoin;
+using Miningcore.Blockchain.Cryptonote;
+using Miningcore.Crypto;
+using Miningcore.Extensions;
+using Miningcore.Tests.Util;
+using Miningcore.Util;
+using Xunit;
+
+namespace Miningcore.Tests.Crypto;
+
+public class ShareDifficultyTests : TestBase
+{
+    [Fact]
+    public void ShareDifficulty_Diff1_Hash_Is_One()
+    {
+        Assert.Equal(1.0, ShareDifficulty.Compute(BitcoinConstants.Diff1Bytes, BitcoinConstants.Diff1Bytes));
+        Assert.Equal(2.0, ShareDifficulty.Compute(ShareDifficulty.ToUInt256Bytes(BitcoinConstants.Diff1 / 2), BitcoinConstants.Diff1Bytes));
+    }
+
+    [Fact]
+    public void ShareDifficulty_Matches_BigRational()
+    {
+        var random = new Random(7);
+        var hash = new byte[32];
+
+        for(var i = 0; i < 1000; i++)
+        {
+            random.NextBytes(hash);
+            hash[31 - i % 8] = 0;
+
+            // BigRational rounds twice on its way to double, so allow for an ulp either way
+            var expected = (double) new BigRational(BitcoinConstants.Diff1, hash.AsSpan().ToBigInteger());
+            var actual = ShareDifficulty.Compute(hash, BitcoinConstants.Diff1Bytes);
+            Assert.True(Math.Abs(actual - expected) <= expected * 1e-15);
+
+            expected = (double) new BigRational(CryptonoteConstants.Diff1b, hash.AsSpan().ToBigInteger());
+            actual = ShareDifficulty.Compute(hash, CryptonoteConstants.Diff1bBytes);
+            Assert.True(Math.Abs(actual - expected) <= expected * 1e-15);
+        }
+    }
+
+    [Fact]
+    public void ShareDifficulty_Is_Correctly_Rounded()
+    {
+        // (2^54 + 6) / 1 lies halfway between two doubles and rounds to the even mantissa
+        var diff1 = "0000000000000000000000000000000000000000000000000040000000000006".HexToByteArray().Reverse().ToArray();
+        var one = ShareDifficulty.ToUInt256Bytes(1);
+
+        Assert.Equal(Math.Pow(2, 54) + 8, ShareDifficulty.Compute(one, diff1));
+    }
+
+    [Fact]
+    public void ShareDifficulty_Zero_Hash_Is_Infinite()
+    {
+        Assert.Equal(double.PositiveInfinity, ShareDifficulty.Compute(new byte[32], BitcoinConstants.Diff1Bytes));
+    }
+
+    [Fact]
+    public void ShareDifficulty_Meets_Target()
+    {
+        var target = "00000000000404cb000000000000000000000000000000000000000000000000".HexToByteArray().Reverse().ToArray();
+        var hash = (byte[]) target.Clone();
+
+        Assert.True(ShareDifficulty.MeetsTarget(hash, target));
+
+        hash[0] = 1;
+        Assert.False(ShareDifficulty.MeetsTarget(hash, target));
+
+        hash[0] = 0;
+        hash[24] = 0xca;
+        Assert.True(ShareDifficulty.MeetsTarget(hash, target));
+    }
+}
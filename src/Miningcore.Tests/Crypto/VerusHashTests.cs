@@ -33,6 +33,24 @@ public class VerusHashTests : TestBase
         Assert.False(Array.TrueForAll(result1, b => b == 0));
     }
 
+    [Fact]
+    public void VerusHash_Should_Match_Native_Test_Vector()
+    {
+        // regression value of test_verushash.cpp for the 80-byte pattern, identical on every kernel set;
+        // agreement with VerusCoin is checked natively with reference vectors (make test VERUS_VECTORS=...)
+        var testInput = new byte[80];
+
+        for (int i = 0; i < testInput.Length; i++)
+            testInput[i] = (byte) i;
+
+        var hasher = new VerusHash();
+        var result = new byte[32];
+
+        hasher.Digest(testInput, result);
+
+        Assert.Equal("f2946f3019322d0e835e7f6c9d39364004de96d753a430e65c0a53e97d233cb1", result.ToHexString());
+    }
+
     [Fact]
     public void VerusHash_Should_Enforce_80_Byte_Input_Length()
     {
@@ -1,5 +1,6 @@
 using System.Globalization;
 using System.Numerics;
+using Miningcore.Crypto;
 
 namespace Miningcore.Blockchain.Bitcoin;
 
@@ -65,6 +66,7 @@ public class BitcoinConstants
     public const decimal SatoshisPerBitcoin = 100000000;
     public static readonly double Pow2x32 = Math.Pow(2, 32);
     public static readonly BigInteger Diff1 = BigInteger.Parse("00ffff0000000000000000000000000000000000000000000000000000", NumberStyles.HexNumber);
+    public static readonly byte[] Diff1Bytes = ShareDifficulty.ToUInt256Bytes(Diff1);
     public const int CoinbaseMinConfimations = 102;
 
     /// <summary>
@@ -1,5 +1,6 @@
 using System.Globalization;
 using System.Text.RegularExpressions;
+using Miningcore.Crypto;
 using Miningcore.Extensions;
 using Org.BouncyCastle.Math;
 
@@ -23,6 +24,7 @@ public static class CryptonoteConstants
 
     public static readonly BigInteger Diff1 = new("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", 16);
     public static readonly System.Numerics.BigInteger Diff1b = System.Numerics.BigInteger.Parse("00FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", NumberStyles.HexNumber);
+    public static readonly byte[] Diff1bBytes = ShareDifficulty.ToUInt256Bytes(Diff1b);
 
 #if DEBUG
     public const int PayoutMinBlockConfirmations = 2;
@@ -1,5 +1,6 @@
 using Miningcore.Blockchain.Cryptonote.DaemonResponses;
 using Miningcore.Configuration;
+using Miningcore.Crypto;
 using Miningcore.Extensions;
 using Miningcore.Native;
 using Miningcore.Stratum;
@@ -10,7 +11,7 @@ using Contract = Miningcore.Contracts.Contract;
 
 namespace Miningcore.Blockchain.Cryptonote;
 
-public class CryptonoteJob
+public class CryptonoteJob : IDisposable
 {
     public CryptonoteJob(GetBlockTemplateResponse blockTemplate, byte[] instanceId, string jobId,
         CryptonoteCoinTemplate coin, PoolConfig poolConfig, ClusterConfig clusterConfig, string prevHash, string randomXRealm)
@@ -26,15 +27,18 @@ public class CryptonoteJob
         PrevHash = prevHash;
         RandomXRealm = randomXRealm;
 
-        hashFunc = hashFuncs[coin.Hash];
+        hashFunc = coin.Hash switch
+        {
+            CryptonightHashType.RandomX => HashRandomX,
+            CryptonightHashType.RandomARQ => HashRandomARQ,
+            _ => hashFuncs[coin.Hash]
+        };
     }
 
     protected delegate void HashFunc(string realm, string seedHex, ReadOnlySpan<byte> data, Span<byte> result, ulong height);
 
     protected static readonly Dictionary<CryptonightHashType, HashFunc> hashFuncs = new()
     {
-        { CryptonightHashType.RandomX, (realm, seedHex, data, result, _) => RandomX.CalculateHash(realm, seedHex, data, result) },
-        { CryptonightHashType.RandomARQ, (realm, seedHex, data, result, _) => RandomARQ.CalculateHash(realm, seedHex, data, result) },
         { CryptonightHashType.Crytonight0, (_, _, data, result, height) => Cryptonight.CryptonightHash(data, result, CN_0, height) },
         { CryptonightHashType.Crytonight1, (_, _, data, result, height) => Cryptonight.CryptonightHash(data, result, CN_1, height) },
         { CryptonightHashType.Crytonight2, (_, _, data, result, height) => Cryptonight.CryptonightHash(data, result, CN_2, height) },
@@ -61,15 +65,62 @@ public class CryptonoteJob
     };
 
     private byte[] blobTemplate;
+    private CryptonoteBindings.HashingBlobTemplate hashingBlobTemplate;
     private int extraNonce;
     private readonly HashFunc hashFunc;
 
+    // the job's RandomX seed, looked up on its first share rather than for every one
+    private RandomX.GenContext randomXSeed;
+    private RandomARQ.GenContext randomARQSeed;
+
+    private void HashRandomX(string realm, string seedHex, ReadOnlySpan<byte> data, Span<byte> result, ulong height)
+    {
+        randomXSeed ??= RandomX.GetSeed(realm, seedHex);
+
+        RandomX.CalculateHash(randomXSeed, data, result);
+    }
+
+    private void HashRandomARQ(string realm, string seedHex, ReadOnlySpan<byte> data, Span<byte> result, ulong height)
+    {
+        randomARQSeed ??= RandomARQ.GetSeed(realm, seedHex);
+
+        RandomARQ.CalculateHash(randomARQSeed, data, result);
+    }
+
     private void PrepareBlobTemplate(byte[] instanceId)
     {
         blobTemplate = BlockTemplate.Blob.HexToByteArray();
 
         // inject instanceId
         instanceId.CopyTo(blobTemplate, BlockTemplate.ReservedOffset + CryptonoteConstants.ExtraNonceSize);
+
+        // parsed once; shares only patch the extranonce and nonce (null if the layout doesn't allow it)
+        hashingBlobTemplate = CryptonoteBindings.HashingBlobTemplate.Create(blobTemplate,
+            BlockTemplate.ReservedOffset, CryptonoteConstants.ExtraNonceSize);
+    }
+
+    private byte[] ConvertBlob(ReadOnlySpan<byte> blob, uint workerExtraNonce, ReadOnlySpan<byte> nonce)
+    {
+        if(hashingBlobTemplate != null)
+        {
+            Span<byte> extraNonceBytes = stackalloc byte[CryptonoteConstants.ExtraNonceSize];
+            BitConverter.TryWriteBytes(extraNonceBytes, workerExtraNonce.ToBigEndian());
+
+            var result = new byte[hashingBlobTemplate.Size];
+
+            try
+            {
+                hashingBlobTemplate.GetHashingBlob(extraNonceBytes, nonce, result);
+                return result;
+            }
+
+            catch(ObjectDisposedException)
+            {
+                // the job was replaced while this share was processed
+            }
+        }
+
+        return CryptonoteBindings.ConvertBlob(blob, blobTemplate.Length);
     }
 
     private string EncodeBlob(uint workerExtraNonce)
@@ -81,7 +132,7 @@ public class CryptonoteJob
         var bytes = BitConverter.GetBytes(workerExtraNonce.ToBigEndian());
         bytes.CopyTo(blob[BlockTemplate.ReservedOffset..]);
 
-        return CryptonoteBindings.ConvertBlob(blob, blobTemplate.Length).ToHexString();
+        return ConvertBlob(blob, workerExtraNonce, ReadOnlySpan<byte>.Empty).ToHexString();
     }
 
     private string EncodeTarget(double difficulty, int size = 4)
@@ -152,11 +203,11 @@ public class CryptonoteJob
         bytes.CopyTo(blob[BlockTemplate.ReservedOffset..]);
 
         // inject nonce
-        bytes = nonce.HexToByteArray();
-        bytes.CopyTo(blob[CryptonoteConstants.BlobNonceOffset..]);
+        var nonceBytes = nonce.HexToByteArray();
+        nonceBytes.CopyTo(blob[CryptonoteConstants.BlobNonceOffset..]);
 
         // convert
-        var blobConverted = CryptonoteBindings.ConvertBlob(blob, blobTemplate.Length);
+        var blobConverted = ConvertBlob(blob, workerExtraNonce, nonceBytes);
         if(blobConverted == null)
             throw new StratumException(StratumError.MinusOne, "malformed blob");
 
@@ -169,8 +220,7 @@ public class CryptonoteJob
             throw new StratumException(StratumError.MinusOne, "bad hash");
 
         // check difficulty
-        var headerValue = headerHash.ToBigInteger();
-        var shareDiff = (double) new BigRational(CryptonoteConstants.Diff1b, headerValue);
+        var shareDiff = ShareDifficulty.Compute(headerHash, CryptonoteConstants.Diff1bBytes);
         var stratumDifficulty = context.Difficulty;
         var ratio = shareDiff / stratumDifficulty;
         var isBlockCandidate = shareDiff >= BlockTemplate.Difficulty;
@@ -214,5 +264,13 @@ public class CryptonoteJob
         return (result, blob.ToHexString());
     }
 
+    /// <summary>
+    /// Frees the native hashing blob template; shares still arriving for the job fall back to ConvertBlob
+    /// </summary>
+    public void Dispose()
+    {
+        hashingBlobTemplate?.Dispose();
+    }
+
     #endregion // API-Surface
 }
@@ -90,8 +90,12 @@ public class CryptonoteJobManager : JobManagerBase<CryptonoteJob>
 
                 // init job
                 job = new CryptonoteJob(blockTemplate, instanceId, NextJobId(), coin, poolConfig, clusterConfig, newHash, randomXRealm);
+                var previousJob = currentJob;
                 currentJob = job;
 
+                // shares of the previous job no longer validate once the chain moved on
+                previousJob?.Dispose();
+
                 // update stats
                 BlockchainStats.LastNetworkBlockTime = clock.Now;
                 BlockchainStats.BlockHeight = job.BlockTemplate.Height;
@@ -139,13 +143,9 @@ public class CryptonoteJobManager : JobManagerBase<CryptonoteJob>
                     {
                         RandomX.WithLock(() =>
                         {
-                            // delete old seed
-                            if(currentSeedHash != null)
-                                RandomX.DeleteSeed(randomXRealm, currentSeedHash);
-
-                            // activate new one
+                            // switch to the new seed (prepared in advance unless this is the first one) and release the old one
                             currentSeedHash = blockTemplate.SeedHash;
-                            RandomX.CreateSeed(randomXRealm, currentSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
+                            RandomX.ActivateSeed(randomXRealm, currentSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
                         });
                     }
 
@@ -153,6 +153,11 @@ public class CryptonoteJobManager : JobManagerBase<CryptonoteJob>
                         currentSeedHash = blockTemplate.SeedHash;
                 }
 
+                // build the upcoming seed in the background while the current one validates shares
+                if(poolConfig.EnableInternalStratum == true && !string.IsNullOrEmpty(blockTemplate.NextSeedHash) &&
+                   blockTemplate.NextSeedHash != currentSeedHash)
+                    RandomX.PrepareSeed(randomXRealm, blockTemplate.NextSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
+
                 break;
             }
 
@@ -167,13 +172,9 @@ public class CryptonoteJobManager : JobManagerBase<CryptonoteJob>
                     {
                         RandomARQ.WithLock(() =>
                         {
-                            // delete old seed
-                            if(currentSeedHash != null)
-                                RandomARQ.DeleteSeed(randomXRealm, currentSeedHash);
-
-                            // activate new one
+                            // switch to the new seed (prepared in advance unless this is the first one) and release the old one
                             currentSeedHash = blockTemplate.SeedHash;
-                            RandomARQ.CreateSeed(randomXRealm, currentSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
+                            RandomARQ.ActivateSeed(randomXRealm, currentSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
                         });
                     }
 
@@ -181,6 +182,11 @@ public class CryptonoteJobManager : JobManagerBase<CryptonoteJob>
                         currentSeedHash = blockTemplate.SeedHash;
                 }
 
+                // build the upcoming seed in the background while the current one validates shares
+                if(poolConfig.EnableInternalStratum == true && !string.IsNullOrEmpty(blockTemplate.NextSeedHash) &&
+                   blockTemplate.NextSeedHash != currentSeedHash)
+                    RandomARQ.PrepareSeed(randomXRealm, blockTemplate.NextSeedHash, randomXFlagsOverride, randomXFlagsAdd, extraPoolConfig.RandomXVMCount);
+
                 break;
             }
         }
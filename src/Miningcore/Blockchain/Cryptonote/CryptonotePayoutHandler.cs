@@ -441,14 +441,27 @@ public class CryptonotePayoutHandler : PayoutHandlerBase,
                 return;
             }
 #endif
+        // decode all payout addresses at once
+        var addresses = balances
+            .Select(x =>
+            {
+                ExtractAddressAndPaymentId(x.Address, out var address, out _);
+                return address;
+            })
+            .Distinct()
+            .ToArray();
+
+        var decodedAddresses = addresses
+            .Zip(CryptonoteBindings.DecodeAddresses(addresses))
+            .ToDictionary(x => x.First, x => x.Second);
+
         // validate addresses
         balances = balances
             .Where(x =>
             {
                 ExtractAddressAndPaymentId(x.Address, out var address, out _);
 
-                var addressPrefix = CryptonoteBindings.DecodeAddress(address);
-                var addressIntegratedPrefix = CryptonoteBindings.DecodeIntegratedAddress(address);
+                var (addressPrefix, addressIntegratedPrefix) = decodedAddresses[address];
 
                 switch(networkType)
                 {
@@ -495,7 +508,7 @@ public class CryptonotePayoutHandler : PayoutHandlerBase,
 
                 var hasPaymentId = paymentId != null;
                 var isIntegratedAddress = false;
-                var addressIntegratedPrefix = CryptonoteBindings.DecodeIntegratedAddress(address);
+                var addressIntegratedPrefix = decodedAddresses[address].IntegratedAddressPrefix;
 
                 switch(networkType)
                 {
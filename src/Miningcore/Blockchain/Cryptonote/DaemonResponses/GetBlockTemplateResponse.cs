@@ -16,6 +16,12 @@ public class GetBlockTemplateResponse
     [JsonProperty("seed_hash")]
     public string SeedHash { get; set; }
 
+    /// <summary>
+    /// Seed hash taking over at the next seed epoch, set by the daemon during the blocks before the switch
+    /// </summary>
+    [JsonProperty("next_seed_hash")]
+    public string NextSeedHash { get; set; }
+
     [JsonProperty("reserved_offset")]
     public int ReservedOffset { get; set; }
 
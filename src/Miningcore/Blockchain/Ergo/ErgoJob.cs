@@ -1,9 +1,10 @@
 using System.Collections.Concurrent;
 using System.Text;
+using Miningcore.Blockchain.Bitcoin;
 using Miningcore.Contracts;
 using Miningcore.Crypto;
-using Miningcore.Crypto.Hashing.Algorithms;
 using Miningcore.Extensions;
+using Miningcore.Native;
 using Miningcore.Stratum;
 using System.Numerics;
 using NBitcoin;
@@ -18,11 +19,14 @@ public class ErgoJob
     public string JobId { get; protected set; }
 
     private object[] jobParams;
-    private BigInteger n;
+    private uint n;
+    private byte[] blockTarget;
     private readonly ConcurrentDictionary<string, bool> submissions = new(StringComparer.OrdinalIgnoreCase);
-    private static readonly IHashAlgorithm hasher = new Blake2b();
     private int extraNonceSize;
 
+    // msg || nonce, see autolykos2.h
+    private const int MaxCoinbaseSize = 128;
+
     private static readonly uint nBase = (uint) Math.Pow(2, 26);
     private const uint IncreaseStart = 600 * 1024;
     private const uint IncreasePeriodForN = 50 * 1024;
@@ -70,79 +74,40 @@ public class ErgoJob
         }
     }
 
-    private BigInteger[] GenIndexes(byte[] seed)
-    {
-        // hash seed
-        Span<byte> hash = stackalloc byte[32];
-        hasher.Digest(seed, hash);
-
-        // duplicate
-        Span<byte> extendedHash = stackalloc byte[64];
-        hash.CopyTo(extendedHash);
-        hash.CopyTo(extendedHash.Slice(32, 32));
-
-        // map indexes
-        var result = new BigInteger[32];
-
-        for(var i = 0; i < 32; i++)
-        {
-            var x = BitConverter.ToUInt32(extendedHash.Slice(i, 4)).ToBigEndian();
-            result[i] = x % n;
-        }
-
-        return result;
-    }
-
     protected virtual Share ProcessShareInternal(StratumConnection worker, string nonce)
     {
         var context = worker.ContextAs<ErgoWorkerContext>();
 
-        // hash coinbase
+        // hash coinbase, the element indexes and their sum natively and test the hit against b
         var coinbase = SerializeCoinbase(BlockTemplate.Msg, nonce);
-        Span<byte> hash = stackalloc byte[32];
-        hasher.Digest(coinbase, hash);
-
-        // calculate i
-        var slice = hash.Slice(24, 8);
-        var tmp2 = new BigInteger(slice, true, true) % n;
-        var i = tmp2.ToByteArray(false, true).PadFront(0, 4);
-
-        // calculate e
-        var h = new BigInteger(Height).ToByteArray(true, true).PadFront(0, 4);
-        var ihM = i.Concat(h).Concat(ErgoConstants.M).ToArray();
-        hasher.Digest(ihM, hash);
-        var e = hash[1..].ToArray();
-
-        // calculate j
-        var eCoinbase = e.Concat(coinbase).ToArray();
-        var jTmp = GenIndexes(eCoinbase);
-        var j = jTmp.Select(x => x.ToByteArray(true, true).PadFront(0, 4)).ToArray();
-
-        // calculate f
-        var f = j.Select(x =>
-        {
-            var buf2 = x.Concat(h).Concat(ErgoConstants.M).ToArray();
 
-            // hash it
-            Span<byte> tmp = stackalloc byte[32];
-            hasher.Digest(buf2, tmp);
+        if(coinbase.Length > MaxCoinbaseSize)
+            throw new StratumException(StratumError.Other, "oversized coinbase");
 
-            // extract 31 bytes at end
-            return new BigInteger(tmp[1..], true, true);
-        }).Aggregate((x, y) => x + y);
+        Span<byte> hit = stackalloc byte[32];
+        bool isBlockCandidate;
 
-        // calculate fH
-        var fBytes = f.ToByteArray(true, true).PadFront(0, 32);
-        hasher.Digest(fBytes, hash);
-        var fh = new BigInteger(hash, true, true);
-        var fhTarget = new Target(fh);
+        unsafe
+        {
+            fixed (byte* coinbasePtr = coinbase)
+            {
+                fixed (byte* targetPtr = blockTarget)
+                {
+                    fixed (byte* hitPtr = hit)
+                    {
+                        isBlockCandidate = Multihash.autolykos2_verify(coinbasePtr, (uint) coinbase.Length, Height, n, targetPtr, hitPtr);
+                    }
+                }
+            }
+        }
+
+        // the hit is big-endian, share difficulty takes the little-endian order used for other hashes
+        hit.Reverse();
+        var shareDiff = ShareDifficulty.Compute(hit, BitcoinConstants.Diff1Bytes);
 
         // diff check
         var stratumDifficulty = context.Difficulty;
-        var ratio = fhTarget.Difficulty / stratumDifficulty;
-
-        // check if the share meets the much harder block difficulty (block candidate)
-        var isBlockCandidate = fh < BlockTemplate.B;
+        var ratio = shareDiff / stratumDifficulty;
 
         // test if share meets at least workers current difficulty
         if(!isBlockCandidate && ratio < 0.99)
@@ -150,17 +115,17 @@ public class ErgoJob
             // check if share matched the previous difficulty from before a vardiff retarget
             if(context.VarDiff?.LastUpdate != null && context.PreviousDifficulty.HasValue)
             {
-                ratio = fhTarget.Difficulty / context.PreviousDifficulty.Value;
+                ratio = shareDiff / context.PreviousDifficulty.Value;
 
                 if(ratio < 0.99)
-                    throw new StratumException(StratumError.LowDifficultyShare, $"low difficulty share ({fhTarget.Difficulty})");
+                    throw new StratumException(StratumError.LowDifficultyShare, $"low difficulty share ({shareDiff})");
 
                 // use previous difficulty
                 stratumDifficulty = context.PreviousDifficulty.Value;
             }
 
             else
-                throw new StratumException(StratumError.LowDifficultyShare, $"low difficulty share ({fhTarget.Difficulty})");
+                throw new StratumException(StratumError.LowDifficultyShare, $"low difficulty share ({shareDiff})");
         }
 
         var result = new Share
@@ -219,6 +184,7 @@ public class ErgoJob
         JobId = jobId;
         Difficulty = new Target(BlockTemplate.B).Difficulty;
         n = CalcN(Height);
+        blockTarget = BlockTemplate.B.ToByteArray(true, true).PadFront(0, 32);
 
         jobParams = new object[]
         {
@@ -1051,6 +1051,17 @@ public partial class ClusterConfig
     /// </summary>
     public int? CryptonightMaxThreads { get; set; }
 
+    /// <summary>
+    /// Back Cryptonight scratchpads with a pre-reserved pool of 2 MB huge pages (default: true)
+    /// Requires reserved huge pages (vm.nr_hugepages), falls back to regular pages otherwise
+    /// </summary>
+    public bool? CryptonightHugePages { get; set; }
+
+    /// <summary>
+    /// NUMA node to allocate Cryptonight scratchpads on (default: no preference)
+    /// </summary>
+    public int? CryptonightNumaNode { get; set; }
+
     public string ShareRecoveryFile { get; set; }
 
     [Required]
@@ -0,0 +1,61 @@
+using System.Numerics;
+using Miningcore.Native;
+using Contract = Miningcore.Contracts.Contract;
+
+namespace Miningcore.Crypto;
+
+/// <summary>
+/// Share difficulty and target checks on 32 byte little-endian hashes, computed natively with
+/// fixed-width 256-bit arithmetic instead of BigInteger/BigRational.
+/// </summary>
+public static unsafe class ShareDifficulty
+{
+    /// <summary>
+    /// Encodes a non-negative value below 2^256 as the 32 byte little-endian form expected by
+    /// <see cref="Compute"/> and <see cref="MeetsTarget"/>.
+    /// </summary>
+    public static byte[] ToUInt256Bytes(BigInteger value)
+    {
+        var bytes = value.ToByteArray(true, false);
+        Contract.Requires<ArgumentException>(bytes.Length <= 32);
+
+        var result = new byte[32];
+        bytes.CopyTo(result, 0);
+
+        return result;
+    }
+
+    /// <summary>
+    /// diff1 / hash rounded to the nearest double; +Infinity for a zero hash.
+    /// </summary>
+    public static double Compute(ReadOnlySpan<byte> hash, ReadOnlySpan<byte> diff1)
+    {
+        Contract.Requires<ArgumentException>(hash.Length == 32);
+        Contract.Requires<ArgumentException>(diff1.Length == 32);
+
+        fixed (byte* hashPtr = hash)
+        {
+            fixed (byte* diff1Ptr = diff1)
+            {
+                return Multihash.share_difficulty(hashPtr, diff1Ptr);
+            }
+        }
+    }
+
+    /// <summary>
+    /// True if hash &lt;= target.
+    /// </summary>
+    public static bool MeetsTarget(ReadOnlySpan<byte> hash, ReadOnlySpan<byte> target)
+    {
+        Contract.Requires<ArgumentException>(hash.Length == 32);
+        Contract.Requires<ArgumentException>(target.Length == 32);
+
+        fixed (byte* hashPtr = hash)
+        {
+            fixed (byte* targetPtr = target)
+            {
+                return Multihash.hash_meets_target(hashPtr, targetPtr);
+            }
+        }
+    }
+}
@@ -16,6 +16,15 @@ public static unsafe class Blake3
     [DllImport("libblake3", EntryPoint = "blake3_hash_keyed", CallingConvention = CallingConvention.Cdecl)]
     public static extern void HashKeyed(byte* key, byte* input, uint inputLength, byte* output);
 
+    [DllImport("libblake3", EntryPoint = "blake3_backend", CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr GetBackend();
+
+    [DllImport("libblake3", EntryPoint = "blake3_simd_lanes", CallingConvention = CallingConvention.Cdecl)]
+    public static extern int GetSimdLanes();
+
+    // SIMD backend selected at runtime by the native library (avx512, avx2, sse41, sse2, neon or portable)
+    public static string Backend => Marshal.PtrToStringAnsi(GetBackend());
+
     [DllImport("libblake3", EntryPoint = "blake3_get_output_length", CallingConvention = CallingConvention.Cdecl)]
     public static extern int GetOutputLength();
 
@@ -18,6 +18,15 @@ public static unsafe class Cryptonight
     [DllImport("libcryptonight", EntryPoint = "free_context_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern void free_context(IntPtr ctx);
 
+    [DllImport("libcryptonight", EntryPoint = "cryptonight_init_memory_pool_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool init_memory_pool(uint contexts, uint batchContexts, uint batchWays, [MarshalAs(UnmanagedType.U1)] bool hugePages, int numaNode);
+
+    [DllImport("libcryptonight", EntryPoint = "cryptonight_memory_stats_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void memory_stats(out ulong hugePagesAllocated, out ulong hugePagesTotal);
+
+    [DllImport("libcryptonight", EntryPoint = "cryptonight_memory_pool_stats_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void memory_pool_stats(out ulong pooled, out ulong fallback, out ulong free);
+
     [DllImport("libcryptonight", EntryPoint = "cryptonight_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern bool cryptonight(byte* input, int inputLength, void* output, Algorithm algo, ulong height, IntPtr ctx);
 
@@ -33,6 +42,15 @@ public static unsafe class Cryptonight
     [DllImport("libcryptonight", EntryPoint = "argon_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern bool argon(byte* input, int inputLength, void* output, Algorithm algo, ulong height, IntPtr ctx);
 
+    [DllImport("libcryptonight", EntryPoint = "astrobwt_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool astrobwt(byte* input, int inputLength, void* output, uint sortThreads, IntPtr ctx);
+
+    [DllImport("libcryptonight", EntryPoint = "argon2_get_impl_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr argon2_get_impl();
+
+    [DllImport("libcryptonight", EntryPoint = "argon2_set_impl_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool argon2_set_impl([MarshalAs(UnmanagedType.LPStr)] string name);
+
     public enum Algorithm
     {
         INVALID         = 0,
@@ -72,7 +90,7 @@ public static unsafe class Cryptonight
         AR2_CHUKWA      = 0x61130000,   // "argon2/chukwa"    Argon2id (Chukwa).
         AR2_CHUKWA_V2   = 0x61140000,   // "argon2/chukwav2"  Argon2id (Chukwa v2).
         AR2_WRKZ        = 0x61120000,   // "argon2/wrkz"      Argon2id (WRKZ)
-        // ASTROBWT_DERO   = 0x41000000,   // "astrobwt"         AstroBWT (Dero)
+        ASTROBWT_DERO   = 0x41000000,   // "astrobwt"         AstroBWT (Dero)
         // KAWPOW_RVN      = 0x6b0f0000,   // "kawpow/rvn"       KawPow (RVN)
 
         CN_GPU          = 0x631500ff,   // "cn/gpu"           CryptoNight-GPU (Ryo).
@@ -129,11 +147,19 @@ public static unsafe class Cryptonight
 
     internal static BlockingCollection<Context> contexts = null;
 
+    // reserved by the first context allocated, so a pool without CryptoNight-family coins never maps it
+    private static Lazy<bool> memoryPool;
+
     public class Context : IDisposable
     {
         public Context()
         {
-            handle = new Lazy<IntPtr>(alloc_context);
+            handle = new Lazy<IntPtr>(() =>
+            {
+                _ = memoryPool?.Value;
+
+                return alloc_context();
+            });
         }
 
         private Lazy<IntPtr> handle;
@@ -166,14 +192,38 @@ public static unsafe class Cryptonight
         }
     }
 
-    public static void InitContexts(int maxParallelism)
+    public static void InitContexts(int maxParallelism, bool hugePages = true, int? numaNode = null)
     {
+        // scratchpad memory for all contexts, reserved in one go on first use
+        memoryPool = new Lazy<bool>(() => init_memory_pool((uint) maxParallelism, 0, 0, hugePages, numaNode ?? -1));
+
         contexts = new BlockingCollection<Context>();
 
         for(var i=0;i<maxParallelism;i++)
             contexts.Add(new Context());
     }
 
+    /// <summary>
+    /// Huge pages backing allocated contexts vs. pages requested for them
+    /// </summary>
+    public static (ulong Allocated, ulong Total) GetHugePagesInfo()
+    {
+        memory_stats(out var allocated, out var total);
+
+        return (allocated, total);
+    }
+
+    /// <summary>
+    /// Live contexts backed by the memory pool and by their own pages because the pool was too small,
+    /// and freed pool scratchpads kept for the next context
+    /// </summary>
+    public static (ulong Pooled, ulong Fallback, ulong Free) GetMemoryPoolInfo()
+    {
+        memory_pool_stats(out var pooled, out var fallback, out var free);
+
+        return (pooled, fallback, free);
+    }
+
     #endregion // Context managment
 
     public static void CryptonightHash(ReadOnlySpan<byte> data, Span<byte> result, Algorithm algo, ulong height)
@@ -264,6 +314,25 @@ public static unsafe class Cryptonight
         }
     }
 
+    /// <summary>
+    /// Argon2 fill_segment implementation picked for this CPU (e.g. AVX2). Selected once per
+    /// process by benchmark unless overridden through the ARGON2_IMPL environment variable.
+    /// </summary>
+    public static string GetArgon2Implementation()
+    {
+        return Marshal.PtrToStringAnsi(argon2_get_impl());
+    }
+
+    /// <summary>
+    /// Forces an Argon2 implementation by name. Returns false if the CPU doesn't support it.
+    /// </summary>
+    public static bool SetArgon2Implementation(string name)
+    {
+        Contract.RequiresNonNull(name);
+
+        return argon2_set_impl(name);
+    }
+
     public static void ArgonHash(ReadOnlySpan<byte> data, Span<byte> result, Algorithm algo, ulong height)
     {
         Contract.Requires<ArgumentException>(result.Length >= 32);
@@ -285,4 +354,30 @@ public static unsafe class Cryptonight
             }
         }
     }
+
+    /// <summary>
+    /// AstroBWT (Dero). The context scratchpad holds the suffix array, <paramref name="sortThreads"/>
+    /// above 1 splits its sorts across that many native threads without changing the result.
+    /// </summary>
+    public static void AstroBWTHash(ReadOnlySpan<byte> data, Span<byte> result, int sortThreads = 1)
+    {
+        Contract.Requires<ArgumentException>(result.Length >= 32);
+        Contract.Requires<ArgumentException>(sortThreads > 0);
+
+        var sw = Stopwatch.StartNew();
+
+        fixed (byte* input = data)
+        {
+            fixed (byte* output = result)
+            {
+                using(var lease = new ContextLease())
+                {
+                    var success = astrobwt(input, data.Length, output, (uint) sortThreads, lease.Context.Handle);
+                    Debug.Assert(success);
+
+                    messageBus?.SendTelemetry(Algorithm.ASTROBWT_DERO.ToString(), TelemetryCategory.Hash, sw.Elapsed, true);
+                }
+            }
+        }
+    }
 }
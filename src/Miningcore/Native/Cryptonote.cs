@@ -10,12 +10,27 @@ public static unsafe class CryptonoteBindings
     [DllImport("libcryptonote", EntryPoint = "convert_blob_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern bool convert_blob(byte* input, int inputSize, byte* output, ref int outputSize);
 
+    [DllImport("libcryptonote", EntryPoint = "convert_blob_template_create_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern TemplateHandle convert_blob_template_create(byte* input, int inputSize, int reservedOffset, int reservedSize);
+
+    [DllImport("libcryptonote", EntryPoint = "convert_blob_template_free_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void convert_blob_template_free(IntPtr tmpl);
+
+    [DllImport("libcryptonote", EntryPoint = "convert_blob_template_size_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int convert_blob_template_size(TemplateHandle tmpl);
+
+    [DllImport("libcryptonote", EntryPoint = "convert_blob_template_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool convert_blob_template(TemplateHandle tmpl, byte* extraNonce, int extraNonceSize, byte* nonce, byte* output, ref int outputSize);
+
     [DllImport("libcryptonote", EntryPoint = "decode_address_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern ulong decode_address(byte* input, int inputSize);
 
     [DllImport("libcryptonote", EntryPoint = "decode_integrated_address_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern ulong decode_integrated_address(byte* input, int inputSize);
 
+    [DllImport("libcryptonote", EntryPoint = "validate_addresses_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void validate_addresses_batch(byte** inputs, uint* inputSizes, uint count, ulong* prefixes, ulong* integratedPrefixes);
+
     [DllImport("libcryptonote", EntryPoint = "cn_fast_hash_export", CallingConvention = CallingConvention.Cdecl)]
     private static extern int cn_fast_hash(byte* input, byte* output, uint inputLength);
 
@@ -71,6 +86,91 @@ public static unsafe class CryptonoteBindings
         }
     }
 
+    /// <summary>
+    /// Block template parsed once, producing the hashing blob of each share (what ConvertBlob returns for
+    /// the template with the share's extra nonce and nonce patched in) without parsing it again
+    /// </summary>
+    /// <summary>
+    /// Native template of a HashingBlobTemplate. A share still converting when the template is
+    /// disposed keeps it alive until the call returns
+    /// </summary>
+    private sealed class TemplateHandle : SafeHandle
+    {
+        public TemplateHandle() : base(IntPtr.Zero, true)
+        {
+        }
+
+        public override bool IsInvalid => handle == IntPtr.Zero;
+
+        protected override bool ReleaseHandle()
+        {
+            convert_blob_template_free(handle);
+            return true;
+        }
+    }
+
+    public sealed class HashingBlobTemplate : IDisposable
+    {
+        private readonly TemplateHandle handle;
+
+        private HashingBlobTemplate(TemplateHandle handle)
+        {
+            this.handle = handle;
+            Size = convert_blob_template_size(handle);
+        }
+
+        /// <summary>
+        /// Size of the hashing blobs
+        /// </summary>
+        public int Size { get; }
+
+        /// <summary>
+        /// Returns null if the template doesn't parse or reserved area isn't part of the miner transaction's hashed bytes
+        /// </summary>
+        public static HashingBlobTemplate Create(ReadOnlySpan<byte> blob, int reservedOffset, int reservedSize)
+        {
+            Contract.Requires<ArgumentException>(blob.Length > 0);
+
+            fixed (byte* input = blob)
+            {
+                var handle = convert_blob_template_create(input, blob.Length, reservedOffset, reservedSize);
+
+                if(handle.IsInvalid)
+                {
+                    handle.Dispose();
+                    return null;
+                }
+
+                return new HashingBlobTemplate(handle);
+            }
+        }
+
+        /// <summary>
+        /// Writes the hashing blob with extraNonce at the reserved offset and, if not empty, the 4-byte nonce to result.
+        /// Throws ObjectDisposedException once the template is disposed
+        /// </summary>
+        public void GetHashingBlob(ReadOnlySpan<byte> extraNonce, ReadOnlySpan<byte> nonce, Span<byte> result)
+        {
+            Contract.Requires<ArgumentException>(result.Length >= Size);
+            Contract.Requires<ArgumentException>(nonce.IsEmpty || nonce.Length == 4);
+
+            var outputSize = result.Length;
+
+            fixed (byte* extraNoncePtr = extraNonce)
+            fixed (byte* noncePtr = nonce)
+            fixed (byte* output = result)
+            {
+                if(!convert_blob_template(handle, extraNoncePtr, extraNonce.Length, nonce.IsEmpty ? null : noncePtr, output, ref outputSize))
+                    throw new ArgumentException("extra nonce exceeds the reserved area");
+            }
+        }
+
+        public void Dispose()
+        {
+            handle.Dispose();
+        }
+    }
+
     public static ulong DecodeAddress(string address)
     {
         Contract.Requires<ArgumentException>(!string.IsNullOrEmpty(address));
@@ -99,6 +199,58 @@ public static unsafe class CryptonoteBindings
         }
     }
 
+    /// <summary>
+    /// DecodeAddress and DecodeIntegratedAddress for many addresses in one call, spread over all cores
+    /// </summary>
+    public static (ulong AddressPrefix, ulong IntegratedAddressPrefix)[] DecodeAddresses(IReadOnlyList<string> addresses)
+    {
+        Contract.RequiresNonNull(addresses);
+
+        var count = addresses.Count;
+        var result = new (ulong, ulong)[count];
+
+        if(count == 0)
+            return result;
+
+        // all addresses back to back in one buffer
+        var sizes = new uint[count];
+        var offsets = new int[count];
+        var totalSize = 0;
+
+        for(var i = 0; i < count; i++)
+        {
+            offsets[i] = totalSize;
+            sizes[i] = (uint) Encoding.UTF8.GetByteCount(addresses[i] ?? string.Empty);
+            totalSize += (int) sizes[i];
+        }
+
+        var data = new byte[Math.Max(totalSize, 1)];
+
+        for(var i = 0; i < count; i++)
+            Encoding.UTF8.GetBytes(addresses[i] ?? string.Empty, data.AsSpan(offsets[i]));
+
+        var inputs = new IntPtr[count];
+        var prefixes = new ulong[count];
+        var integratedPrefixes = new ulong[count];
+
+        fixed (byte* dataPtr = data)
+        fixed (IntPtr* inputsPtr = inputs)
+        fixed (uint* sizesPtr = sizes)
+        fixed (ulong* prefixesPtr = prefixes)
+        fixed (ulong* integratedPrefixesPtr = integratedPrefixes)
+        {
+            for(var i = 0; i < count; i++)
+                inputs[i] = (IntPtr) (dataPtr + offsets[i]);
+
+            validate_addresses_batch((byte**) inputsPtr, sizesPtr, (uint) count, prefixesPtr, integratedPrefixesPtr);
+        }
+
+        for(var i = 0; i < count; i++)
+            result[i] = (prefixes[i], integratedPrefixes[i]);
+
+        return result;
+    }
+
     public static void CryptonightHashFast(ReadOnlySpan<byte> data, Span<byte> result)
     {
         Contract.Requires<ArgumentException>(result.Length >= 32);
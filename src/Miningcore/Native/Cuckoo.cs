@@ -0,0 +1,95 @@
+using System.Runtime.InteropServices;
+using Miningcore.Contracts;
+
+// ReSharper disable InconsistentNaming
+
+namespace Miningcore.Native;
+
+public static unsafe class Cuckoo
+{
+    [DllImport("libcryptonight", EntryPoint = "c29s_verify_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool c29s_verify_batch(uint* edges, SipHashKeys* keys, uint count, VerifyCode* results);
+
+    [DllImport("libcryptonight", EntryPoint = "c29b_verify_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool c29b_verify_batch(uint* edges, SipHashKeys* keys, uint count, VerifyCode* results);
+
+    [DllImport("libcryptonight", EntryPoint = "c29i_verify_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool c29i_verify_batch(uint* edges, SipHashKeys* keys, uint count, VerifyCode* results);
+
+    [DllImport("libcryptonight", EntryPoint = "c29v_verify_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern bool c29v_verify_batch(uint* edges, SipHashKeys* keys, uint count, VerifyCode* results);
+
+    public enum Variant
+    {
+        C29s,   // Cuckaroo29s (Swap)
+        C29b,   // Cuckaroo29b (BitTube)
+        C29i,   // Cuckaroo29i (Italo)
+        C29v,   // Cuckarood29v (MoneroV)
+    }
+
+    public enum VerifyCode
+    {
+        Ok,
+        HeaderLength,
+        TooBig,
+        TooSmall,
+        NonMatching,
+        Branch,
+        DeadEnd,
+        ShortCycle,
+        Unbalanced,
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SipHashKeys
+    {
+        public ulong K0;
+        public ulong K1;
+        public ulong K2;
+        public ulong K3;
+    }
+
+    public static int GetProofSize(Variant variant)
+    {
+        return variant switch
+        {
+            Variant.C29b => 40,
+            Variant.C29i => 48,
+            _ => 32,
+        };
+    }
+
+    /// <summary>
+    /// Verifies a batch of proofs. <paramref name="edges"/> holds one proof per entry of
+    /// <paramref name="keys"/>, each <see cref="GetProofSize"/> edges long.
+    /// </summary>
+    public static void VerifyBatch(Variant variant, ReadOnlySpan<uint> edges, ReadOnlySpan<SipHashKeys> keys, Span<VerifyCode> results)
+    {
+        Contract.Requires<ArgumentException>(edges.Length == keys.Length * GetProofSize(variant));
+        Contract.Requires<ArgumentException>(results.Length >= keys.Length);
+
+        if(keys.IsEmpty)
+            return;
+
+        fixed (uint* edgesPtr = edges)
+        {
+            fixed (SipHashKeys* keysPtr = keys)
+            {
+                fixed (VerifyCode* resultsPtr = results)
+                {
+                    var success = variant switch
+                    {
+                        Variant.C29s => c29s_verify_batch(edgesPtr, keysPtr, (uint) keys.Length, resultsPtr),
+                        Variant.C29b => c29b_verify_batch(edgesPtr, keysPtr, (uint) keys.Length, resultsPtr),
+                        Variant.C29i => c29i_verify_batch(edgesPtr, keysPtr, (uint) keys.Length, resultsPtr),
+                        Variant.C29v => c29v_verify_batch(edgesPtr, keysPtr, (uint) keys.Length, resultsPtr),
+                        _ => throw new ArgumentOutOfRangeException(nameof(variant)),
+                    };
+
+                    if(!success)
+                        throw new InvalidOperationException("c29 batch verification failed");
+                }
+            }
+        }
+    }
+}
@@ -1,34 +1,53 @@
 using System.Runtime.InteropServices;
+using Miningcore.Contracts;
 
-// ReSharper disable FieldCanBeMadeReadOnly.Local
-// ReSharper disable MemberCanBePrivate.Local
 // ReSharper disable InconsistentNaming
 
 namespace Miningcore.Native;
 
 public static unsafe class KawPow
 {
-    [DllImport("libethash", EntryPoint = "ethash_create_epoch_context", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr CreateContext(int epoch_number);
+    [DllImport("libcryptonight", EntryPoint = "kawpow_verify_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern int kawpow_verify(int block_number, byte* header_hash, ulong nonce, byte* mix_hash, byte* boundary, byte* final_hash);
 
-    [DllImport("libethash", EntryPoint = "ethash_destroy_epoch_context", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void DestroyContext(IntPtr context);
-
-    [DllImport("libethash", EntryPoint = "hashext", CallingConvention = CallingConvention.Cdecl)]
-    private static extern Ethash_result hashext(IntPtr context, int block_number, ref Ethash_hash256 header_hash, ulong nonce, ref Ethash_hash256 mix_hash, ref Ethash_hash256 boundary1, ref Ethash_hash256 boundary2, out int retcode);
-
-    [StructLayout(LayoutKind.Explicit)]
-    private struct Ethash_hash256
+    public enum VerifyCode
     {
-        [FieldOffset(0)]
-        [MarshalAs(UnmanagedType.ByValArray, SizeConst = 32)]
-        public byte[] bytes;//x32
+        Ok,
+        AboveBoundary,
+        MixMismatch,
     }
 
-    [StructLayout(LayoutKind.Sequential)]
-    private struct Ethash_result
+    /// <summary>
+    /// Verifies a KawPow share. <paramref name="boundary"/> and the returned <paramref name="finalHash"/>
+    /// are big-endian. Shares above the boundary are rejected before the mix is recomputed from the
+    /// epoch's light cache.
+    /// </summary>
+    public static VerifyCode Verify(int blockNumber, ReadOnlySpan<byte> headerHash, ulong nonce, ReadOnlySpan<byte> mixHash,
+        ReadOnlySpan<byte> boundary, Span<byte> finalHash)
     {
-        public Ethash_hash256 final_hash;//32
-        public Ethash_hash256 mix_hash;//32
+        Contract.Requires<ArgumentException>(blockNumber >= 0);
+        Contract.Requires<ArgumentException>(headerHash.Length == 32);
+        Contract.Requires<ArgumentException>(mixHash.Length == 32);
+        Contract.Requires<ArgumentException>(boundary.Length == 32);
+        Contract.Requires<ArgumentException>(finalHash.Length >= 32);
+
+        fixed (byte* headerPtr = headerHash)
+        {
+            fixed (byte* mixPtr = mixHash)
+            {
+                fixed (byte* boundaryPtr = boundary)
+                {
+                    fixed (byte* finalPtr = finalHash)
+                    {
+                        var result = kawpow_verify(blockNumber, headerPtr, nonce, mixPtr, boundaryPtr, finalPtr);
+
+                        if(result < 0)
+                            throw new InvalidOperationException("kawpow verification failed");
+
+                        return (VerifyCode) result;
+                    }
+                }
+            }
+        }
     }
 }
@@ -19,6 +19,12 @@ public static unsafe class Multihash
     [DllImport("libmultihash", EntryPoint = "sha3_512_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void sha3_512(byte* input, void* output, uint inputLength);
 
+    /// <summary>
+    /// SHA3-256 of count consecutive inputs of inputLength bytes each into consecutive 32 byte digests
+    /// </summary>
+    [DllImport("libmultihash", EntryPoint = "sha3_256_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void sha3_256_batch(byte* inputs, void* outputs, uint inputLength, uint count);
+
     [DllImport("libmultihash", EntryPoint = "hmq17_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void hmq17(byte* input, void* output, uint inputLength);
 
@@ -61,6 +67,9 @@ public static unsafe class Multihash
     [DllImport("libmultihash", EntryPoint = "kezzak_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void kezzak(byte* input, void* output, uint inputLength);
 
+    [DllImport("libmultihash", EntryPoint = "kezzak_batch_export", CallingConvention = CallingConvention.Cdecl)]
+    public static extern void kezzak_batch(byte* inputs, void* outputs, uint inputLength, uint count);
+
     [DllImport("libmultihash", EntryPoint = "bcrypt_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void bcrypt(byte* input, void* output, uint inputLength);
 
@@ -82,6 +91,33 @@ public static unsafe class Multihash
     [DllImport("libmultihash", EntryPoint = "blake2b_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void blake2b(byte* input, void* output, uint inputLength, int outputLength);
 
+    [DllImport("libmultihash", EntryPoint = "autolykos2_verify_export", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool autolykos2_verify(byte* coinbase, uint coinbaseLength, uint height, uint n, byte* target, byte* hit);
+
+    [DllImport("libmultihash", EntryPoint = "cpu_dispatch_report_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr cpu_dispatch_report();
+
+    [DllImport("libmultihash", EntryPoint = "cpu_kernel_isa_export", CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr cpu_kernel_isa(string kernel);
+
+    /// <summary>
+    /// Instruction set level each SIMD kernel was dispatched to when the library loaded
+    /// </summary>
+    public static string DispatchReport => Marshal.PtrToStringAnsi(cpu_dispatch_report());
+
+    /// <summary>
+    /// Instruction set level of a single kernel (blake2b, autolykos2, ...), null if unknown
+    /// </summary>
+    public static string GetKernelIsa(string kernel) => Marshal.PtrToStringAnsi(cpu_kernel_isa(kernel));
+
+    [DllImport("libmultihash", EntryPoint = "share_difficulty_export", CallingConvention = CallingConvention.Cdecl)]
+    public static extern double share_difficulty(byte* hash, byte* diff1);
+
+    [DllImport("libmultihash", EntryPoint = "hash_meets_target_export", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    public static extern bool hash_meets_target(byte* hash, byte* target);
+
     [DllImport("libmultihash", EntryPoint = "dcrypt_export", CallingConvention = CallingConvention.Cdecl)]
     public static extern void dcrypt(byte* input, void* output, uint inputLength);
 
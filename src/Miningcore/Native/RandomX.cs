@@ -1,4 +1,3 @@
-using System.Collections.Concurrent;
 using System.Diagnostics;
 using System.Runtime.InteropServices;
 using Miningcore.Contracts;
@@ -19,7 +18,11 @@ public static unsafe class RandomX
 
     #region VM managment
 
-    internal static readonly Dictionary<string, Dictionary<string, Tuple<GenContext, BlockingCollection<RxVm>>>> realms = new();
+    // seeds prepared in librandomx's realm layer, which owns their caches, datasets and VMs
+    internal static readonly Dictionary<string, Dictionary<string, GenContext>> realms = new();
+
+    // per realm: the seeds being prepared ahead of their activation
+    private static readonly HashSet<(string Realm, string SeedHex)> preparing = new();
     private static readonly byte[] empty = new byte[32];
 
     #endregion // VM managment
@@ -41,204 +44,228 @@ public static unsafe class RandomX
     [DllImport("librandomx", EntryPoint = "randomx_get_flags", CallingConvention = CallingConvention.Cdecl)]
     private static extern randomx_flags randomx_get_flags();
 
-    [DllImport("librandomx", EntryPoint = "randomx_alloc_cache", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr alloc_cache(randomx_flags flags);
-
-    [DllImport("librandomx", EntryPoint = "randomx_init_cache", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr init_cache(IntPtr cache, IntPtr key, int keysize);
+    [DllImport("librandomx", EntryPoint = "rx_realm_set_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_set_seed(string realm, byte* seed, uint seedLength, randomx_flags flags, int vmCount, int initThreads);
 
-    [DllImport("librandomx", EntryPoint = "randomx_release_cache", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr release_cache(IntPtr cache);
+    [DllImport("librandomx", EntryPoint = "rx_realm_prepare_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_prepare_seed(string realm, byte* seed, uint seedLength, randomx_flags flags, int vmCount, int initThreads);
 
-    [DllImport("librandomx", EntryPoint = "randomx_alloc_dataset", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr alloc_dataset(randomx_flags flags);
+    [DllImport("librandomx", EntryPoint = "rx_realm_activate_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_activate_seed(string realm, byte* seed, uint seedLength);
 
-    [DllImport("librandomx", EntryPoint = "randomx_dataset_item_count", CallingConvention = CallingConvention.Cdecl)]
-    private static extern ulong dataset_item_count();
+    [DllImport("librandomx", EntryPoint = "rx_realm_release_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_release_seed(string realm, byte* seed, uint seedLength);
 
-    [DllImport("librandomx", EntryPoint = "randomx_init_dataset", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void init_dataset(IntPtr dataset, IntPtr cache, ulong startItem, ulong itemCount);
+    [DllImport("librandomx", EntryPoint = "rx_realm_has_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_has_seed(string realm, byte* seed, uint seedLength);
 
-    [DllImport("librandomx", EntryPoint = "randomx_get_dataset_memory", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr get_dataset_memory(IntPtr dataset);
+    [DllImport("librandomx", EntryPoint = "rx_realm_is_preparing_seed", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool realm_is_preparing_seed(string realm, byte* seed, uint seedLength);
 
-    [DllImport("librandomx", EntryPoint = "randomx_release_dataset", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void release_dataset(IntPtr dataset);
+    [DllImport("librandomx", EntryPoint = "rx_seed_open", CallingConvention = CallingConvention.Cdecl)]
+    private static extern SeedHandle seed_open(string realm, byte* seed, uint seedLength);
 
-    [DllImport("librandomx", EntryPoint = "randomx_create_vm", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr create_vm(randomx_flags flags, IntPtr cache, IntPtr dataset);
+    [DllImport("librandomx", EntryPoint = "rx_seed_close", CallingConvention = CallingConvention.Cdecl)]
+    private static extern void seed_close(IntPtr handle);
 
-    [DllImport("librandomx", EntryPoint = "randomx_vm_set_cache", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void vm_set_cache(IntPtr machine, IntPtr cache);
+    [DllImport("librandomx", EntryPoint = "rx_seed_hash", CallingConvention = CallingConvention.Cdecl)]
+    [return: MarshalAs(UnmanagedType.U1)]
+    private static extern bool seed_hash(SeedHandle handle, byte* input, uint inputLength, byte* output);
 
-    [DllImport("librandomx", EntryPoint = "randomx_vm_set_dataset", CallingConvention = CallingConvention.Cdecl)]
-    private static extern IntPtr vm_set_dataset(IntPtr machine, IntPtr dataset);
+    /// <summary>
+    /// A seed resolved once in the realm layer. Hashes on it skip the native realm lookup, and a
+    /// hash still running when the seed is disposed keeps its VMs until it returns
+    /// </summary>
+    public sealed class SeedHandle : SafeHandle
+    {
+        public SeedHandle() : base(IntPtr.Zero, true)
+        {
+        }
 
-    [DllImport("librandomx", EntryPoint = "randomx_destroy_vm", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void destroy_vm(IntPtr machine);
+        public override bool IsInvalid => handle == IntPtr.Zero;
 
-    [DllImport("librandomx", EntryPoint = "randomx_calculate_hash", CallingConvention = CallingConvention.Cdecl)]
-    private static extern void calculate_hash(IntPtr machine, byte* input, int inputSize, byte* output);
+        protected override bool ReleaseHandle()
+        {
+            seed_close(handle);
+            return true;
+        }
+    }
 
     public class GenContext
     {
         public DateTime LastAccess { get; set; } = DateTime.Now;
         public int VmCount { get; init; }
+        public byte[] Seed { get; init; }
+        public SeedHandle Handle { get; init; }
     }
 
-    public class RxDataSet : IDisposable
+    public static void WithLock(Action action)
     {
-        private IntPtr dataset = IntPtr.Zero;
-
-        public void Dispose()
-        {
-            if(dataset != IntPtr.Zero)
-            {
-                release_dataset(dataset);
-                dataset = IntPtr.Zero;
-            }
-        }
-
-        public IntPtr Init(randomx_flags flags, IntPtr cache)
+        lock(realms)
         {
-            dataset = alloc_dataset(flags);
-
-            var itemCount = dataset_item_count();
-            init_dataset(dataset, cache, 0, itemCount);
-
-            return dataset;
+            action();
         }
     }
 
-    public class RxVm : IDisposable
+    public static void CreateSeed(string realm, string seedHex,
+        randomx_flags? flagsOverride = null, randomx_flags? flagsAdd = null, int vmCount = 1)
     {
-        private IntPtr cache = IntPtr.Zero;
-        private IntPtr vm = IntPtr.Zero;
-        private RxDataSet ds;
-
-        public void Dispose()
+        lock(realms)
         {
-            if(vm != IntPtr.Zero)
+            if(!realms.TryGetValue(realm, out var seeds))
             {
-                destroy_vm(vm);
-                vm = IntPtr.Zero;
-            }
+                seeds = new Dictionary<string, GenContext>();
 
-            ds?.Dispose();
+                realms[realm] = seeds;
+            }
 
-            if(cache != IntPtr.Zero)
+            if(!seeds.ContainsKey(seedHex))
             {
-                release_cache(cache);
-                cache = IntPtr.Zero;
+                var flags = MakeFlags(flagsOverride, flagsAdd);
+
+                if (vmCount == -1)
+                    vmCount = Environment.ProcessorCount;
+
+                // picks up the seed if PrepareSeed already built it, or waits for it to finish
+                var seed = CreateSeed(realm, seedHex, flags, vmCount);
+
+                if(seed != null)
+                    seeds[seedHex] = seed;
+
+                preparing.Remove((realm, seedHex));
             }
         }
+    }
 
-        public void Init(ReadOnlySpan<byte> key, randomx_flags flags)
+    /// <summary>
+    /// Starts building the seed that activates next on low-priority background threads,
+    /// so that ActivateSeed finds it ready at the activation height
+    /// </summary>
+    public static void PrepareSeed(string realm, string seedHex,
+        randomx_flags? flagsOverride = null, randomx_flags? flagsAdd = null, int vmCount = 1)
+    {
+        lock(realms)
         {
-            var ds_ptr = IntPtr.Zero;
+            if(realms.TryGetValue(realm, out var seeds) && seeds.ContainsKey(seedHex))
+                return;
 
-            // alloc cache
-            cache = alloc_cache(flags);
+            var seed = seedHex.HexToByteArray();
 
-            // init cache
-            fixed(byte* key_ptr = key)
+            if(preparing.Contains((realm, seedHex)))
             {
-                init_cache(cache, (IntPtr) key_ptr, key.Length);
-            }
+                fixed(byte* seedPtr = seed)
+                {
+                    // still building, or built and waiting for CreateSeed to pick it up
+                    if(realm_is_preparing_seed(realm, seedPtr, (uint) seed.Length) ||
+                       realm_has_seed(realm, seedPtr, (uint) seed.Length))
+                        return;
+                }
 
-            // Enable fast-mode? (requires 2GB+ memory per VM)
-            if((flags & randomx_flags.RANDOMX_FLAG_FULL_MEM) != 0)
-            {
-                ds = new RxDataSet();
-                ds_ptr = ds.Init(flags, cache);
+                logger.Warn(() => $"Preparation for {realm}, upcoming hash {seedHex} failed or was dropped, restarting it");
 
-                // cache is no longer needed in fast-mode
-                release_cache(cache);
-                cache = IntPtr.Zero;
+                preparing.Remove((realm, seedHex));
             }
 
-            vm = create_vm(flags, cache, ds_ptr);
-        }
+            preparing.Add((realm, seedHex));
 
-        public void CalculateHash(ReadOnlySpan<byte> data, Span<byte> result)
-        {
-            fixed (byte* input = data)
+            var flags = MakeFlags(flagsOverride, flagsAdd);
+
+            if (vmCount == -1)
+                vmCount = Environment.ProcessorCount;
+
+            logger.Info(() => $"Preparing {vmCount} VMs for {realm} [{flags}], upcoming hash {seedHex} ...");
+
+            fixed(byte* seedPtr = seed)
             {
-                fixed (byte* output = result)
-                {
-                    calculate_hash(vm, input, data.Length, output);
-                }
+                realm_prepare_seed(realm, seedPtr, (uint) seed.Length, flags, vmCount, Environment.ProcessorCount);
             }
         }
     }
 
-    public static void WithLock(Action action)
-    {
-        lock(realms)
-        {
-            action();
-        }
-    }
-
-    public static void CreateSeed(string realm, string seedHex,
+    /// <summary>
+    /// Switches the realm to the seed, creating it unless it was prepared, and releases every
+    /// other seed of the realm once hashes still running on it return
+    /// </summary>
+    public static void ActivateSeed(string realm, string seedHex,
         randomx_flags? flagsOverride = null, randomx_flags? flagsAdd = null, int vmCount = 1)
     {
         lock(realms)
         {
-            if(!realms.TryGetValue(realm, out var seeds))
-            {
-                seeds = new Dictionary<string, Tuple<GenContext, BlockingCollection<RxVm>>>();
+            CreateSeed(realm, seedHex, flagsOverride, flagsAdd, vmCount);
 
-                realms[realm] = seeds;
+            if(!realms[realm].TryGetValue(seedHex, out var seed))
+                return;
+
+            fixed(byte* seedPtr = seed.Seed)
+            {
+                if(!realm_activate_seed(realm, seedPtr, (uint) seed.Seed.Length))
+                    return;
             }
 
-            if(!seeds.TryGetValue(seedHex, out var seed))
+            // the realm layer dropped every other seed: the previous one, and any prepared for a
+            // switch that never came, along with preparations still running for them
+            foreach(var (key, retired) in realms[realm].Where(x => x.Key != seedHex).ToArray())
             {
-                var flags = flagsOverride ?? randomx_get_flags();
+                logger.Info($"Disposing {retired.VmCount} VMs for realm {realm} and key {key}");
 
-                if(flagsAdd.HasValue)
-                    flags |= flagsAdd.Value;
+                realms[realm].Remove(key);
+                retired.Handle.Dispose();
+            }
 
-                if (vmCount == -1)
-                    vmCount = Environment.ProcessorCount;
+            preparing.RemoveWhere(x => x.Realm == realm);
+        }
+    }
 
-                seed = CreateSeed(realm, seedHex, flags, vmCount);
+    private static randomx_flags MakeFlags(randomx_flags? flagsOverride, randomx_flags? flagsAdd)
+    {
+        var flags = flagsOverride ?? randomx_get_flags();
 
-                seeds[seedHex] = seed;
-            }
-        }
+        if(flagsAdd.HasValue)
+            flags |= flagsAdd.Value;
+
+        return flags;
     }
 
-    private static Tuple<GenContext, BlockingCollection<RxVm>> CreateSeed(string realm, string seedHex, randomx_flags flags, int vmCount)
+    private static GenContext CreateSeed(string realm, string seedHex, randomx_flags flags, int vmCount)
     {
-        var vms = new BlockingCollection<RxVm>();
+        var seed = seedHex.HexToByteArray();
+        var start = DateTime.Now;
 
-        var seed = new Tuple<GenContext, BlockingCollection<RxVm>>(new GenContext
-        {
-            VmCount = vmCount
-        }, vms);
+        logger.Info(() => $"Creating {vmCount} VMs for {realm} [{flags}], hash {seedHex} ...");
 
-        void createVm(int index)
+        SeedHandle handle;
+
+        // one cache (and dataset in full-memory mode) shared by all VMs, initialized on every core
+        fixed(byte* seedPtr = seed)
         {
-            var start = DateTime.Now;
-            logger.Info(() => $"Creating VM {realm}@{index + 1} [{flags}], hash {seedHex} ...");
+            if(!realm_set_seed(realm, seedPtr, (uint) seed.Length, flags, vmCount, Environment.ProcessorCount))
+            {
+                logger.Error(() => $"Failed to create VMs for {realm} [{flags}], hash {seedHex}");
+                return null;
+            }
 
-            var vm = new RxVm();
-            vm.Init(seedHex.HexToByteArray(), flags);
+            handle = seed_open(realm, seedPtr, (uint) seed.Length);
+        }
 
-            vms.Add(vm);
+        logger.Info(() => $"Created {vmCount} VMs for {realm} in {DateTime.Now - start}");
 
-            logger.Info(() => $"Created VM {realm}@{index + 1} in {DateTime.Now - start}");
+        return new GenContext
+        {
+            VmCount = vmCount,
+            Seed = seed,
+            Handle = handle
         };
-
-        Parallel.For(0, vmCount, createVm);
-
-        return seed;
     }
 
     public static void DeleteSeed(string realm, string seedHex)
     {
-        Tuple<GenContext, BlockingCollection<RxVm>> seed;
+        GenContext seed;
 
         lock(realms)
         {
@@ -249,22 +276,18 @@ public static unsafe class RandomX
                 return;
         }
 
-        // dispose all VMs
-        var (ctx, col) = seed;
-        var remaining = ctx.VmCount;
+        // the native side frees the VMs once hashes still running on them return
+        logger.Info($"Disposing {seed.VmCount} VMs for realm {realm} and key {seedHex}");
 
-        while (remaining > 0)
+        fixed(byte* seedPtr = seed.Seed)
         {
-            var vm = col.Take();
-
-            logger.Info($"Disposing VM {ctx.VmCount - remaining} for realm {realm} and key {seedHex}");
-            vm.Dispose();
-
-            remaining--;
+            realm_release_seed(realm, seedPtr, (uint) seed.Seed.Length);
         }
+
+        seed.Handle.Dispose();
     }
 
-    public static Tuple<GenContext, BlockingCollection<RxVm>> GetSeed(string realm, string seedHex)
+    public static GenContext GetSeed(string realm, string seedHex)
     {
         lock(realms)
         {
@@ -279,41 +302,43 @@ public static unsafe class RandomX
     }
 
     public static void CalculateHash(string realm, string seedHex, ReadOnlySpan<byte> data, Span<byte> result)
+    {
+        CalculateHash(GetSeed(realm, seedHex), data, result);
+    }
+
+    /// <summary>
+    /// Hashes on a seed returned by GetSeed, for callers validating many shares on one seed
+    /// </summary>
+    public static void CalculateHash(GenContext ctx, ReadOnlySpan<byte> data, Span<byte> result)
     {
         Contract.Requires<ArgumentException>(result.Length >= 32);
 
         var sw = Stopwatch.StartNew();
         var success = false;
 
-        var (ctx, seedVms) = GetSeed(realm, seedHex);
-
         if(ctx != null)
         {
-            RxVm vm = null;
-
-            try
+            fixed (byte* input = data)
             {
-                // lease a VM
-                vm = seedVms.Take();
-
-                vm.CalculateHash(data, result);
-
-                ctx.LastAccess = DateTime.Now;
-                success = true;
-
-                messageBus?.SendTelemetry("RandomX", TelemetryCategory.Hash, sw.Elapsed, true);
+                fixed (byte* output = result)
+                {
+                    try
+                    {
+                        success = seed_hash(ctx.Handle, input, (uint) data.Length, output);
+                    }
+
+                    catch(ObjectDisposedException)
+                    {
+                        // the seed was retired or deleted meanwhile
+                    }
+                }
             }
 
-            catch(Exception ex)
+            if(success)
             {
-                logger.Error(() => ex.Message);
-            }
+                ctx.LastAccess = DateTime.Now;
 
-            finally
-            {
-                // return it
-                if(vm != null)
-                    seedVms.Add(vm);
+                messageBus?.SendTelemetry("RandomX", TelemetryCategory.Hash, sw.Elapsed, true);
             }
         }
 
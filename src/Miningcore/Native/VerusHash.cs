@@ -20,6 +20,13 @@ public static unsafe class VerusHash
     [DllImport("libverushash", EntryPoint = "verushash_get_version", CallingConvention = CallingConvention.Cdecl)]
     public static extern IntPtr GetVersion();
 
+    /// <summary>
+    /// Haraka/CLHash implementation selected for this CPU: "vaes", "aes-ni" or "portable"
+    /// </summary>
+    /// <returns>Implementation name</returns>
+    [DllImport("libverushash", EntryPoint = "verushash_get_isa", CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr GetIsa();
+
     /// <summary>
     /// Initialize VerusHash context for streaming operations
     /// </summary>
@@ -72,13 +79,6 @@ public static unsafe class VerusHash
     /// <returns>True if AVX2 is supported</returns>
     [DllImport("libverushash", EntryPoint = "verushash_has_avx2", CallingConvention = CallingConvention.Cdecl)]
     public static extern bool HasAvx2();
-
-    /// <summary>
-    /// Get optimal thread count for VerusHash mining on current system
-    /// </summary>
-    /// <returns>Recommended thread count</returns>
-    [DllImport("libverushash", EntryPoint = "verushash_optimal_threads", CallingConvention = CallingConvention.Cdecl)]
-    public static extern int GetOptimalThreads();
 }
 
 /// <summary>
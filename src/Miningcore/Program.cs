@@ -440,6 +440,17 @@ public class Program : BackgroundService
         logger.Info(() => $"Version {GetVersion()}");
 
         logger.Info(() => $"Runtime {RuntimeInformation.FrameworkDescription.Trim()} on {RuntimeInformation.OSDescription.Trim()} [{RuntimeInformation.ProcessArchitecture}]");
+
+        try
+        {
+            logger.Info(() => $"Native kernels {Multihash.DispatchReport}");
+            logger.Info(() => $"Blake3 backend {Native.Blake3.Backend} ({Native.Blake3.GetSimdLanes()} lanes)");
+        }
+
+        catch(DllNotFoundException)
+        {
+            // native libraries are optional on platforms without a native build
+        }
     }
 
     private static string GetVersion()
@@ -807,7 +818,8 @@ public class Program : BackgroundService
 
         // Configure Cryptonight
         Cryptonight.messageBus = messageBus;
-        Cryptonight.InitContexts(GetDefaultConcurrency(clusterConfig.CryptonightMaxThreads));
+        Cryptonight.InitContexts(GetDefaultConcurrency(clusterConfig.CryptonightMaxThreads),
+            clusterConfig.CryptonightHugePages ?? true, clusterConfig.CryptonightNumaNode);
 
         // Configure RandomX
         RandomX.messageBus = messageBus;
@@ -0,0 +1,1531 @@
+/*
+ * Native hashing micro-benchmark.
+ *
+ * Loads the pool's native libraries with dlopen and times every hashing and verification
+ * export the pool calls per share, on 1..N threads. Each thread gets its own contexts and
+ * buffers, the way pool worker threads do, and shared state (epoch caches, light caches) is
+ * built once before timing starts. A library that is missing or fails to load is reported
+ * and skipped, so the suite also runs on a partial build.
+ *
+ * Exports that only set up or describe state (context and epoch allocation, sizes, seed
+ * hashes, dispatch reports, versions) are not timed; the dispatch reports are recorded with
+ * the host information so results from different builds can be told apart.
+ *
+ *   ./native_bench                     every case, 1..hardware threads
+ *   ./native_bench --list              print the case names
+ *   ./native_bench --filter x11        only cases whose "library/export variant" contains x11
+ *   ./native_bench --threads 8         scale up to 8 threads (1, 2, 4, 8)
+ *   ./native_bench --duration 1000     milliseconds per measurement (default 300)
+ *   ./native_bench --json out.json     also write the results as JSON
+ *   ./native_bench --lib-dir DIR       load every library from DIR instead of ../lib<name>/
+ *   ./native_bench --verthash-file F   include verthash_export, using the data file F
+ *   ./native_bench --ethash-dag-dir D  include ethash_full_compute_export, building the epoch 0 DAG in D
+ */
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../native_test.h"
+
+typedef std::function<void(uint64_t iteration)> worker_fn;
+
+struct bench_case
+{
+    std::string library;
+    std::string name;       // export
+    std::string variant;    // algorithm, input size, batch width ...
+    uint32_t hashes_per_call;
+    std::function<worker_fn()> make_worker;    // called once per thread, before timing starts
+};
+
+struct thread_result
+{
+    uint32_t threads;
+    uint64_t hashes;
+    double seconds;
+};
+
+struct library
+{
+    std::string name;
+    std::string path;
+    void* handle;
+    std::string error;
+};
+
+static std::vector<library> libraries;
+static std::vector<bench_case> cases;
+static std::vector<std::pair<std::string, std::string>> dispatch_info;
+
+static std::string lib_dir;
+static std::string verthash_file;
+static std::string ethash_dag_dir;
+
+static std::vector<uint8_t> hex_bytes(const char* hex)
+{
+    std::vector<uint8_t> bytes(strlen(hex) / 2);
+    test_from_hex(hex, bytes.data(), bytes.size());
+    return bytes;
+}
+
+/* the deterministic filler of the native tests, so every build hashes the same inputs */
+static std::vector<uint8_t> make_input(size_t len)
+{
+    std::vector<uint8_t> input(len);
+    test_fill(input.data(), len);
+    return input;
+}
+
+/* writes the iteration into the nonce position, so consecutive calls hash different inputs */
+static void set_nonce(uint8_t* input, size_t len, uint64_t iteration)
+{
+    const size_t offset = len >= 80 ? 76 : (len >= 4 ? len - 4 : 0);
+    const uint32_t nonce = static_cast<uint32_t>(iteration);
+
+    memcpy(input + offset, &nonce, std::min<size_t>(4, len - offset));
+}
+
+static library* load_library(const std::string& name)
+{
+    for (auto& lib : libraries) {
+        if (lib.name == name)
+            return lib.handle != nullptr ? &lib : nullptr;
+    }
+
+    library lib;
+    lib.name = name;
+    lib.path = (lib_dir.empty() ? "../" + name : lib_dir) + "/" + name + ".so";
+
+    // RTLD_LOCAL: libcryptonight and libkawpow both carry ethash, each must keep its own
+    lib.handle = dlopen(lib.path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+    if (lib.handle == nullptr)
+        lib.error = dlerror();
+
+    libraries.push_back(lib);
+    return lib.handle != nullptr ? &libraries.back() : nullptr;
+}
+
+template<typename T>
+static T resolve(library* lib, const char* symbol)
+{
+    return lib != nullptr ? reinterpret_cast<T>(dlsym(lib->handle, symbol)) : nullptr;
+}
+
+static void add_case(const char* library, const char* name, const std::string& variant, uint32_t hashes_per_call,
+    std::function<worker_fn()> make_worker)
+{
+    cases.push_back(bench_case { library, name, variant, hashes_per_call, make_worker });
+}
+
+/*
+ * libmultihash
+ */
+
+typedef void (*mh_hash_fn)(const char*, char*, uint32_t);
+typedef void (*mh_hash_nolen_fn)(const char*, char*);
+typedef void (*mh_hash_u8_fn)(const unsigned char*, unsigned char*, uint32_t);
+typedef void (*mh_scrypt_fn)(const char*, char*, uint32_t, uint32_t, uint32_t);
+typedef void (*mh_blake2_fn)(const char*, char*, uint32_t, uint32_t);
+typedef void (*mh_hash_batch_fn)(const char*, char*, uint32_t, uint32_t);
+typedef bool (*mh_autolykos2_fn)(const unsigned char*, uint32_t, uint32_t, uint32_t, const unsigned char*, unsigned char*);
+typedef int (*mh_verthash_init_fn)(const char*, int);
+typedef int (*mh_verthash_fn)(const unsigned char*, unsigned char*, uint32_t);
+typedef bool (*mh_equihash_fn)(const char*, int, const char*, int, const char*);
+typedef double (*mh_share_difficulty_fn)(const unsigned char*, const unsigned char*);
+typedef bool (*mh_meets_target_fn)(const unsigned char*, const unsigned char*);
+typedef void (*mh_difficulty_batch_fn)(const unsigned char*, uint32_t, const unsigned char*, const unsigned char*, double*, unsigned char*);
+typedef bool (*mh_share_hash_batch_fn)(const char*, const unsigned char*, uint32_t, uint32_t, const unsigned char*, const unsigned char*,
+    unsigned char*, double*, unsigned char*);
+typedef const char* (*mh_dispatch_report_fn)();
+
+/* Zcash block 0x0008e969... header with nonce and its 200,9 solution, from HashingTests */
+static const char* equihash_200_9_header =
+    "0400000008e9694cc2120ec1b5733cc12687b609058eec4f7046a521ad1d1e3049b400003e7420ed6f40659de0305ef9b7ec037f4380ed9848bc1c015691c90a"
+    "a16ff3930000000000000000000000000000000000000000000000000000000000000000c9310d5874e0001f000000000000000000000000000000010b00000000"
+    "0000000000000000000040";
+static const char* equihash_200_9_solution =
+    "00b43863a213bfe79f00337f5a729f09710abcc07035ef8ac34372abddecf2f82715f7223f075af96f0604fc124d6151fc8fb516d24a137faec123a89aa9a433"
+    "f8a25a6bcfc554c28be556f6c878f96539186fab191505f278df48bf1ad2240e5bb39f372a143de1dd1b672312e00d52a3dd83f471b0239a7e8b30d4b9153027"
+    "df87c8cd0b64de76749539fea376b4f39d08cf3d5e821495e52fdfa6f8085e59fc670656121c9d7c01388c8b4b4585aa7b9ac3f7ae796f9eb1fadba1730a1860"
+    "eed797feabb18832b5e8f003c0adaf0788d1016e7a8969144018ecc86140aa4553962aa739a4850b509b505e158c5f9e2d5376374652e9e6d81b19fa0351be22"
+    "9af136efbce681463cc53d7880c1eeca3411154474ff8a7b2bac034a2026646776a517bf63921c31fbbd6be7c3ff42aab28230bfe81d33800b892b262f3579b7"
+    "a41925a59f5cc1d4f523577c19ff9f92023146fa26486595bd89a1ba459eb0b5cec0578c3a071dbec73eca054c723ab30ce8e69de32e779cd2f1030e39878ac6"
+    "ea3cdca743b43aedefe1a9b4f2da861038e2759defef0b8cad11d4179f2f08881b53ccc203e558c0571e049d998a257b3279016aad0d7999b609f6331a0d0f88"
+    "e286a70432ca7f50a5bb8fafbbe9230b4ccb1fa57361c163d6b9f84579d61f41585a022d07dc8e55a8de4d8f87641dae777819458a2bf1bb02c438480ff11621"
+    "ca8442ec2946875cce247c8877051359e9c822670d37bb00fa806e60e8e890ce62540fda2d5b1c790ca1e005030ac6d8e63db577bb98be111ee146828f9c48ee"
+    "6257d7627b93ea3dd11aac3412e63dfc7ca132a73c4f51e7650f3f8ecf57bfc18716990b492d50e0a3e5fbf6136e771b91f7283ec3326209265b9531d157f8a0"
+    "7a4117fc8fb29ba1363afc6f9f0608251ea595256727a5bbe28f42a42edfbfa9017680e32980d4ad381612612b2bc7ad91e82eca693ea4fc27049a99636b50a5"
+    "76f1e55c72202d582b150ef194c1419f53177ecf315ea6b0e2f1aa8cd8f59b165aa0d89561c537fb6141f5813b7a4968fe16afc703326113f68508d88ff8d0ae"
+    "e1e88a84c0ae56c72f27511290ced48e93e8c95419d14aed1a5b2e9b2c9c1070c593e5eb50bb9a80e14e9f9fe501f56b1b3140159e8213b75d48d14af472a604"
+    "484cd8e7e7abb6820245ed3ab29f9947463a033c586194be45eadec8392c8614d83a1e9ca0fe5655fa14f7a9c1d1f8f2185a06193ff4a3c3e9a96b02310033ce"
+    "aa25894e7c56a6147e691597098054e285d39656d3d459ec5d13243c062b6eb44e19a13bdfc0b3c96bd3d1aeb75bb6b080322aea23555993cb529243958bb1a0"
+    "e5d5027e6c78155437242d1d13c1d6e442a0e3783147a08bbfc0c2529fb705ad27713df40486fd58f001977f25dfd3c202451c07010a3880bca63959ca61f10e"
+    "d3871f1152166fce2b52135718a8ceb239a0664a31c62defaad70be4b920dce70549c10d9138fbbad7f291c5b73fa21c3889929b143bc1576b72f70667ac1105"
+    "2b686891085290d871db528b5cfdc10a6d563925227609f10d1768a0e02dc7471ad424f94f737d4e7eb0fb167f1434fc4ae2d49e152f06f0845b6db0a44f0d6f"
+    "5e7410420e6bd1f430b1af956005bf72b51405a04d9a5d9906ceca52c22c855785c3c3ac4c3e9bf532d31bab321e1db66f6a9f7dc9c017f2b7d8dfeb933cf5bb"
+    "ae71311ae318f6d187ebc5c843be342b08a9a0ff7c4b9c4b0f4fa74b13296afe84b6481440d58332e07b3d051ed55219d28e77af6612134da4431b797c63ef55"
+    "bc53831e2f421db620fee51ba0967e4ed7009ef90af2204259bbfbb54537fd35c2132fa8e7f9c84bf9938d248862c6ca1cca9f48b0b33aa1589185c4eabc1c32";
+
+static void add_multihash_hash(library* lib, const char* name, size_t input_len)
+{
+    const mh_hash_fn fn = resolve<mh_hash_fn>(lib, name);
+    if (fn == nullptr)
+        return;
+
+    add_case("libmultihash", name, std::to_string(input_len) + "B", 1, [=]() -> worker_fn {
+        auto input = std::make_shared<std::vector<uint8_t>>(make_input(input_len));
+        auto output = std::make_shared<std::vector<uint8_t>>(64);
+
+        return [=](uint64_t i) {
+            set_nonce(input->data(), input_len, i);
+            fn(reinterpret_cast<const char*>(input->data()), reinterpret_cast<char*>(output->data()), input_len);
+        };
+    });
+}
+
+/* exports with a fixed 80 byte input */
+static void add_multihash_hash_nolen(library* lib, const char* name)
+{
+    const mh_hash_nolen_fn fn = resolve<mh_hash_nolen_fn>(lib, name);
+    if (fn == nullptr)
+        return;
+
+    add_case("libmultihash", name, "80B", 1, [=]() -> worker_fn {
+        auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+        auto output = std::make_shared<std::vector<uint8_t>>(64);
+
+        return [=](uint64_t i) {
+            set_nonce(input->data(), 80, i);
+            fn(reinterpret_cast<const char*>(input->data()), reinterpret_cast<char*>(output->data()));
+        };
+    });
+}
+
+static void add_multihash_equihash(library* lib, const char* name, const char* variant, const char* personalization,
+    const std::vector<uint8_t>& header, const std::vector<uint8_t>& solution)
+{
+    const mh_equihash_fn fn = resolve<mh_equihash_fn>(lib, name);
+    if (fn == nullptr)
+        return;
+
+    add_case("libmultihash", name, variant, 1, [=]() -> worker_fn {
+        return [=](uint64_t) {
+            fn(reinterpret_cast<const char*>(header.data()), static_cast<int>(header.size()),
+                reinterpret_cast<const char*>(solution.data()), static_cast<int>(solution.size()), personalization);
+        };
+    });
+}
+
+static void add_multihash_cases()
+{
+    library* lib = load_library("libmultihash");
+    if (lib == nullptr)
+        return;
+
+    static const char* hashes_80[] = {
+        "quark_export", "sha256csm_export", "sha3_256_export", "sha3_512_export", "hmq17_export", "phi_export",
+        "x11_export", "x13_export", "x15_export", "x17_export", "kezzak_export", "bcrypt_export", "skein_export",
+        "groestl_export", "groestl_myriad_export", "blake_export", "dcrypt_export", "fugue_export", "geek_export",
+        "qubit_export", "s3_export", "hefty1_export", "shavite3_export", "nist5_export", "fresh_export", "jh_export",
+        "x16r_export", "x16rv2_export", "x16s_export", "x21s_export", "x22i_export", "heavyhash_export",
+    };
+
+    for (const char* name : hashes_80)
+        add_multihash_hash(lib, name, 80);
+
+    static const char* hashes_nolen[] = {
+        "x13_bcd_export", "c11_export", "lyra2re_export", "lyra2rev2_export", "lyra2rev3_export", "sha256dt_export",
+    };
+
+    for (const char* name : hashes_nolen)
+        add_multihash_hash_nolen(lib, name);
+
+    // multi-buffer Keccak: 8 lanes per pass on AVX-512, 4 on AVX2
+    for (const char* name : { "sha3_256_batch_export", "kezzak_batch_export" }) {
+        if (auto fn = resolve<mh_hash_batch_fn>(lib, name)) {
+            const uint32_t count = 64;
+
+            add_case("libmultihash", name, "80B, batch 64", count, [=]() -> worker_fn {
+                auto inputs = std::make_shared<std::vector<uint8_t>>(make_input(80 * count));
+                auto outputs = std::make_shared<std::vector<uint8_t>>(32 * count);
+
+                return [=](uint64_t i) {
+                    set_nonce(inputs->data(), 80, i);
+                    fn(reinterpret_cast<const char*>(inputs->data()), reinterpret_cast<char*>(outputs->data()), 80, count);
+                };
+            });
+        }
+    }
+
+    if (auto fn = resolve<mh_hash_u8_fn>(lib, "sha512_256_export")) {
+        add_case("libmultihash", "sha512_256_export", "80B", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 80, i);
+                fn(input->data(), output->data(), 80);
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_scrypt_fn>(lib, "scrypt_export")) {
+        add_case("libmultihash", "scrypt_export", "N=1024 R=1", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 80, i);
+                fn(reinterpret_cast<const char*>(input->data()), reinterpret_cast<char*>(output->data()), 1024, 1, 80);
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_scrypt_fn>(lib, "scryptn_export")) {
+        // argument order differs from scrypt_export: (input, output, nFactor, input_len)
+        auto scryptn = reinterpret_cast<void (*)(const char*, char*, uint32_t, uint32_t)>(fn);
+
+        add_case("libmultihash", "scryptn_export", "nFactor=10", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 80, i);
+                scryptn(reinterpret_cast<const char*>(input->data()), reinterpret_cast<char*>(output->data()), 10, 80);
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_hash_u8_fn>(lib, "neoscrypt_export")) {
+        add_case("libmultihash", "neoscrypt_export", "profile 0", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 80, i);
+                fn(input->data(), output->data(), 0);
+            };
+        });
+    }
+
+    for (const char* name : { "blake2s_export", "blake2b_export" }) {
+        if (auto fn = resolve<mh_blake2_fn>(lib, name)) {
+            add_case("libmultihash", name, "80B", 1, [=]() -> worker_fn {
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), 80, i);
+                    fn(reinterpret_cast<const char*>(input->data()), reinterpret_cast<char*>(output->data()), 80, 32);
+                };
+            });
+        }
+    }
+
+    if (auto fn = resolve<mh_autolykos2_fn>(lib, "autolykos2_verify_export")) {
+        add_case("libmultihash", "autolykos2_verify_export", "height 500000", 1, [=]() -> worker_fn {
+            auto coinbase = std::make_shared<std::vector<uint8_t>>(make_input(40));
+            auto target = std::make_shared<std::vector<uint8_t>>(32, 0xff);
+            auto hit = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(coinbase->data(), 40, i);
+                fn(coinbase->data(), 40, 500000, 67108864, target->data(), hit->data());
+            };
+        });
+    }
+
+    if (!verthash_file.empty()) {
+        auto init = resolve<mh_verthash_init_fn>(lib, "verthash_init_export");
+        auto fn = resolve<mh_verthash_fn>(lib, "verthash_export");
+
+        if (init != nullptr && fn != nullptr && init(verthash_file.c_str(), 0) == 0) {
+            add_case("libmultihash", "verthash_export", "80B", 1, [=]() -> worker_fn {
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), 80, i);
+                    fn(input->data(), output->data(), 80);
+                };
+            });
+        } else {
+            fprintf(stderr, "verthash: could not load %s, skipped\n", verthash_file.c_str());
+        }
+    }
+
+    // only 200,9 has a known-good solution; the others time the rejection of an all-zero solution
+    add_multihash_equihash(lib, "equihash_verify_200_9_export", "valid solution", "ZcashPoW",
+        hex_bytes(equihash_200_9_header), hex_bytes(equihash_200_9_solution));
+    add_multihash_equihash(lib, "equihash_verify_144_5_export", "zero solution", "BgoldPoW",
+        hex_bytes(equihash_200_9_header), std::vector<uint8_t>(100));
+    add_multihash_equihash(lib, "equihash_verify_96_5_export", "zero solution", "ZcashPoW",
+        hex_bytes(equihash_200_9_header), std::vector<uint8_t>(68));
+
+    // a 2^224 difficulty-1 target, roughly what Bitcoin-family pools use
+    auto diff1 = std::make_shared<std::vector<uint8_t>>(32, 0);
+    (*diff1)[28] = 0xff;
+    (*diff1)[29] = 0xff;
+
+    if (auto fn = resolve<mh_share_difficulty_fn>(lib, "share_difficulty_export")) {
+        add_case("libmultihash", "share_difficulty_export", "", 1, [=]() -> worker_fn {
+            auto hash = std::make_shared<std::vector<uint8_t>>(make_input(32));
+            auto sink = std::make_shared<double>();
+
+            return [=](uint64_t i) {
+                set_nonce(hash->data(), 32, i);
+                *sink += fn(hash->data(), diff1->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_meets_target_fn>(lib, "hash_meets_target_export")) {
+        add_case("libmultihash", "hash_meets_target_export", "", 1, [=]() -> worker_fn {
+            auto hash = std::make_shared<std::vector<uint8_t>>(make_input(32));
+            auto sink = std::make_shared<uint64_t>();
+
+            return [=](uint64_t i) {
+                set_nonce(hash->data(), 32, i);
+                *sink += fn(hash->data(), diff1->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_difficulty_batch_fn>(lib, "share_difficulty_batch_export")) {
+        const uint32_t count = 64;
+
+        add_case("libmultihash", "share_difficulty_batch_export", "batch 64", count, [=]() -> worker_fn {
+            auto hashes = std::make_shared<std::vector<uint8_t>>(make_input(32 * count));
+            auto difficulties = std::make_shared<std::vector<double>>(count);
+            auto meets = std::make_shared<std::vector<uint8_t>>(count);
+
+            return [=](uint64_t i) {
+                set_nonce(hashes->data(), 32, i);
+                fn(hashes->data(), count, diff1->data(), diff1->data(), difficulties->data(), meets->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<mh_share_hash_batch_fn>(lib, "share_hash_batch_export")) {
+        const uint32_t count = 16;
+
+        add_case("libmultihash", "share_hash_batch_export", "x11, batch 16", count, [=]() -> worker_fn {
+            auto inputs = std::make_shared<std::vector<uint8_t>>(make_input(80 * count));
+            auto hashes = std::make_shared<std::vector<uint8_t>>(32 * count);
+            auto difficulties = std::make_shared<std::vector<double>>(count);
+            auto meets = std::make_shared<std::vector<uint8_t>>(count);
+
+            return [=](uint64_t i) {
+                set_nonce(inputs->data(), 80, i);
+                fn("x11", inputs->data(), 80, count, diff1->data(), diff1->data(), hashes->data(), difficulties->data(), meets->data());
+            };
+        });
+    }
+
+    if (auto report = resolve<mh_dispatch_report_fn>(lib, "cpu_dispatch_report_export"))
+        dispatch_info.emplace_back("libmultihash", report());
+}
+
+/*
+ * libcryptonight
+ */
+
+struct siphash_keys
+{
+    uint64_t k0, k1, k2, k3;
+};
+
+typedef bool (*cn_init_pool_fn)(uint32_t, uint32_t, uint32_t, bool, int32_t);
+typedef void* (*cn_alloc_fn)();
+typedef void (*cn_free_fn)(void*);
+typedef void* (*cn_alloc_batch_fn)(uint32_t);
+typedef bool (*cn_hash_fn)(const uint8_t*, size_t, char*, int, uint64_t, void*);
+typedef bool (*cn_astrobwt_fn)(const uint8_t*, size_t, char*, uint32_t, void*);
+typedef bool (*cn_batch_fn)(int, const uint8_t* const*, const uint32_t*, uint32_t, uint8_t*, uint64_t, void*);
+typedef bool (*cn_ghostrider_fn)(const uint8_t* const*, const uint32_t*, uint32_t, uint8_t*, void*);
+typedef int32_t (*cn_kawpow_fn)(int32_t, const uint8_t*, uint64_t, const uint8_t*, const uint8_t*, uint8_t*);
+typedef bool (*cn_c29_fn)(const uint32_t*, const siphash_keys*, uint32_t, int32_t*);
+typedef const char* (*cn_argon2_impl_fn)();
+
+/* the share test_kawpow verifies: block 100, header[i] = i * 7 + 1 */
+static const char* kawpow_mix = "782647e3b4fa936f3de952763e99fcdc9ad0cd8df4c9c15a6991560f39f829af";
+static const uint64_t kawpow_nonce = 0x1122334455667788ull;
+
+/* owns a context for the lifetime of one worker */
+static std::shared_ptr<void> cn_context(cn_alloc_fn alloc, cn_free_fn release)
+{
+    return std::shared_ptr<void>(alloc(), release);
+}
+
+static void add_cryptonight_single(library* lib, const char* name, const char* variant, int algo, uint64_t height)
+{
+    auto fn = resolve<cn_hash_fn>(lib, name);
+    auto alloc = resolve<cn_alloc_fn>(lib, "alloc_context_export");
+    auto release = resolve<cn_free_fn>(lib, "free_context_export");
+
+    if (fn == nullptr || alloc == nullptr || release == nullptr)
+        return;
+
+    add_case("libcryptonight", name, variant, 1, [=]() -> worker_fn {
+        auto ctx = cn_context(alloc, release);
+        auto input = std::make_shared<std::vector<uint8_t>>(make_input(76));
+        auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+        return [=](uint64_t i) {
+            set_nonce(input->data(), 43, i);    // CryptoNote blobs keep the nonce at offset 39
+            fn(input->data(), 76, reinterpret_cast<char*>(output->data()), algo, height, ctx.get());
+        };
+    });
+}
+
+static void add_cryptonight_batch(library* lib, const char* variant, int algo, uint32_t ways)
+{
+    auto fn = resolve<cn_batch_fn>(lib, "cryptonight_batch_export");
+    auto alloc = resolve<cn_alloc_batch_fn>(lib, "alloc_batch_context_export");
+    auto release = resolve<cn_free_fn>(lib, "free_batch_context_export");
+
+    if (fn == nullptr || alloc == nullptr || release == nullptr)
+        return;
+
+    add_case("libcryptonight", "cryptonight_batch_export", std::string(variant) + ", " + std::to_string(ways) + "-way", ways, [=]() -> worker_fn {
+        auto batch = std::shared_ptr<void>(alloc(ways), release);
+        auto inputs = std::make_shared<std::vector<uint8_t>>(make_input(76 * ways));
+        auto pointers = std::make_shared<std::vector<const uint8_t*>>(ways);
+        auto lengths = std::make_shared<std::vector<uint32_t>>(ways, 76);
+        auto outputs = std::make_shared<std::vector<uint8_t>>(32 * ways);
+
+        for (uint32_t k = 0; k < ways; k++)
+            (*pointers)[k] = inputs->data() + 76 * k;
+
+        return [=](uint64_t i) {
+            for (uint32_t k = 0; k < ways; k++)
+                set_nonce(inputs->data() + 76 * k, 43, i * ways + k);
+
+            fn(algo, pointers->data(), lengths->data(), ways, outputs->data(), 0, batch.get());
+        };
+    });
+}
+
+static void add_ghostrider_batch(library* lib, uint32_t ways)
+{
+    auto fn = resolve<cn_ghostrider_fn>(lib, "ghostrider_batch_export");
+    auto alloc = resolve<cn_alloc_batch_fn>(lib, "alloc_batch_context_export");
+    auto release = resolve<cn_free_fn>(lib, "free_batch_context_export");
+
+    if (fn == nullptr || alloc == nullptr || release == nullptr)
+        return;
+
+    // all inputs share PrevBlockHash, i.e. the same job and plan
+    add_case("libcryptonight", "ghostrider_batch_export", std::to_string(ways) + "-way", ways, [=]() -> worker_fn {
+        auto batch = std::shared_ptr<void>(alloc(ways), release);
+        auto inputs = std::make_shared<std::vector<uint8_t>>(80 * ways);
+        auto pointers = std::make_shared<std::vector<const uint8_t*>>(ways);
+        auto lengths = std::make_shared<std::vector<uint32_t>>(ways, 80);
+        auto outputs = std::make_shared<std::vector<uint8_t>>(32 * ways);
+        const std::vector<uint8_t> header = make_input(80);
+
+        for (uint32_t k = 0; k < ways; k++) {
+            memcpy(inputs->data() + 80 * k, header.data(), 80);
+            (*pointers)[k] = inputs->data() + 80 * k;
+        }
+
+        return [=](uint64_t i) {
+            for (uint32_t k = 0; k < ways; k++)
+                set_nonce(inputs->data() + 80 * k, 80, i * ways + k);
+
+            fn(pointers->data(), lengths->data(), ways, outputs->data(), batch.get());
+        };
+    });
+}
+
+/* non-matching proofs with distinct ascending edges: every edge is hashed before the cycle check fails */
+static void add_c29(library* lib, const char* name, size_t proof_size)
+{
+    auto fn = resolve<cn_c29_fn>(lib, name);
+    if (fn == nullptr)
+        return;
+
+    const uint32_t count = 16;
+
+    add_case("libcryptonight", name, "batch 16", count, [=]() -> worker_fn {
+        auto edges = std::make_shared<std::vector<uint32_t>>(proof_size * count);
+        auto keys = std::make_shared<std::vector<siphash_keys>>(count);
+        auto results = std::make_shared<std::vector<int32_t>>(count);
+
+        for (uint32_t p = 0; p < count; p++) {
+            for (size_t e = 0; e < proof_size; e++)
+                (*edges)[p * proof_size + e] = static_cast<uint32_t>(e * (1000 + p) + 7);
+
+            (*keys)[p] = siphash_keys { 0x0706050403020100ull + p, 0x0f0e0d0c0b0a0908ull, 0x1716151413121110ull, 0x1f1e1d1c1b1a1918ull };
+        }
+
+        return [=](uint64_t i) {
+            (*keys)[0].k0 = i;
+            fn(edges->data(), keys->data(), count, results->data());
+        };
+    });
+}
+
+static void add_cryptonight_cases(uint32_t max_threads)
+{
+    library* lib = load_library("libcryptonight");
+    if (lib == nullptr)
+        return;
+
+    // a huge-page pool for the contexts of one run: a case frees its contexts before the next one starts
+    if (auto init = resolve<cn_init_pool_fn>(lib, "cryptonight_init_memory_pool_export"))
+        init(max_threads, max_threads, 5, true, -1);
+
+    add_cryptonight_single(lib, "cryptonight_export", "cn/0", 0x63150000, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/1", 0x63150100, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/2", 0x63150200, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/r", 0x63150272, 1806260);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/half", 0x63150268, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/rwz", 0x63150277, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/zls", 0x6315027a, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/double", 0x63150264, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/ccx", 0x63150063, 0);
+    add_cryptonight_single(lib, "cryptonight_export", "cn/gpu", 0x631500ff, 0);
+    add_cryptonight_single(lib, "cryptonight_lite_export", "cn-lite/1", 0x63140100, 0);
+    add_cryptonight_single(lib, "cryptonight_heavy_export", "cn-heavy/0", 0x63160000, 0);
+    add_cryptonight_single(lib, "cryptonight_heavy_export", "cn-heavy/xhv", 0x63160068, 0);
+    add_cryptonight_single(lib, "cryptonight_pico_export", "cn-pico", 0x63120200, 0);
+    add_cryptonight_single(lib, "argon_export", "argon2/chukwa", 0x61130000, 0);
+    add_cryptonight_single(lib, "argon_export", "argon2/chukwav2", 0x61140000, 0);
+    add_cryptonight_single(lib, "argon_export", "argon2/wrkz", 0x61120000, 0);
+
+    for (uint32_t ways = 1; ways <= 5; ways++)
+        add_cryptonight_batch(lib, "cn/2", 0x63150200, ways);
+
+    add_cryptonight_batch(lib, "cn/half", 0x63150268, 5);
+    add_cryptonight_batch(lib, "cn-lite/1", 0x63140100, 5);
+
+    add_ghostrider_batch(lib, 1);
+    add_ghostrider_batch(lib, 4);
+
+    auto astrobwt = resolve<cn_astrobwt_fn>(lib, "astrobwt_export");
+    auto alloc = resolve<cn_alloc_fn>(lib, "alloc_context_export");
+    auto release = resolve<cn_free_fn>(lib, "free_context_export");
+
+    if (astrobwt != nullptr && alloc != nullptr && release != nullptr) {
+        for (uint32_t sort_threads : { 1u, 4u }) {
+            add_case("libcryptonight", "astrobwt_export", std::to_string(sort_threads) + " sort thread(s)", 1, [=]() -> worker_fn {
+                auto ctx = cn_context(alloc, release);
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(48));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), 43, i);
+                    astrobwt(input->data(), 48, reinterpret_cast<char*>(output->data()), sort_threads, ctx.get());
+                };
+            });
+        }
+    }
+
+    if (auto fn = resolve<cn_kawpow_fn>(lib, "kawpow_verify_export")) {
+        add_case("libcryptonight", "kawpow_verify_export", "", 1, [=]() -> worker_fn {
+            auto header = std::make_shared<std::vector<uint8_t>>(make_input(32));
+            auto mix = std::make_shared<std::vector<uint8_t>>(hex_bytes(kawpow_mix));
+            auto boundary = std::make_shared<std::vector<uint8_t>>(32, 0xff);
+            auto final_hash = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t) {
+                fn(100, header->data(), kawpow_nonce, mix->data(), boundary->data(), final_hash->data());
+            };
+        });
+    }
+
+    add_c29(lib, "c29s_verify_batch_export", 32);
+    add_c29(lib, "c29b_verify_batch_export", 40);
+    add_c29(lib, "c29i_verify_batch_export", 48);
+    add_c29(lib, "c29v_verify_batch_export", 32);
+
+    if (auto impl = resolve<cn_argon2_impl_fn>(lib, "argon2_get_impl_export"))
+        dispatch_info.emplace_back("argon2", impl());
+}
+
+/*
+ * libcryptonote
+ */
+
+typedef bool (*cnote_convert_blob_fn)(const char*, unsigned int, unsigned char*, unsigned int*);
+typedef void* (*cnote_template_create_fn)(const char*, unsigned int, unsigned int, unsigned int);
+typedef void (*cnote_template_free_fn)(void*);
+typedef bool (*cnote_convert_template_fn)(const void*, const unsigned char*, unsigned int, const unsigned char*, unsigned char*, unsigned int*);
+typedef uint64_t (*cnote_decode_fn)(const char*, unsigned int);
+typedef void (*cnote_validate_batch_fn)(const char* const*, const uint32_t*, uint32_t, uint64_t*, uint64_t*);
+typedef void (*cnote_fast_hash_fn)(const char*, unsigned char*, uint32_t);
+
+/* Monero block template and addresses from CrytonoteTests */
+static const char* cryptonote_blob =
+    "0106e5b3afd505583cf50bcc743d04d831d2b119dc94ad88679e359076ee3f18d258ee138b3b421c0300a401d90101ff9d0106d6d6a88702023c62e43372a58c"
+    "b588147e20be53a27083f5c522f33c722b082ab7518c48cda280b4c4c32102609ec96e2499ee267d70efefc49f26e330526d3ef455314b7b5ba268a6045f8c80"
+    "c0fc82aa0202fe5cc0fa56c4277d1a47827edce4725571529d57f33c73ada481ef84c323f30a8090cad2c60e02d88bf5e72a611c8b8464ce29e3b1adbfe1ae16"
+    "3886d9150fe511171cada98fcb80e08d84ddcb0102441915aaf9fbaf70ff454c701a6ae2bd59bb94dc0b888bf7e5d06274ee9238ca80c0caf384a30202407852"
+    "6e2132def44bde2806242652f5944e632f7d94290dd6ee5dda1929f5ee2b016e29f25f07ec2a8df59f0e118a6c9a4b769b745dc0c729071f6e0399d258574502"
+    "0800000000012e7f7600000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000";
+/* header and miner transaction of that template; its 8 reserved extra nonce bytes are at 321 */
+static const size_t cryptonote_template_size = 329;
+static const uint32_t cryptonote_reserved_offset = 321;
+
+/* the Monero template with tx_count transaction hashes appended, as the daemon hands out with a full mempool */
+static std::vector<uint8_t> cryptonote_template(uint32_t tx_count)
+{
+    std::vector<uint8_t> blob = hex_bytes(cryptonote_blob);
+    blob.resize(cryptonote_template_size);
+
+    for (uint32_t v = tx_count; ; v >>= 7) {
+        blob.push_back(static_cast<uint8_t>(v >= 0x80 ? (v & 0x7f) | 0x80 : v));
+
+        if (v < 0x80)
+            break;
+    }
+
+    const std::vector<uint8_t> hashes = make_input(32 * tx_count);
+    blob.insert(blob.end(), hashes.begin(), hashes.end());
+
+    return blob;
+}
+
+static const char* cryptonote_address =
+    "48nhyWcSey31ngSEhV8j8NPm6B8PistCQJBjjDjmTvRSTWYg6iocAw131vE2JPh3ps33vgQDKLrUx3fcErusYWcMJBxpm1d";
+static const char* cryptonote_integrated_address =
+    "4BrL51JCc9NGQ71kWhnYoDRffsDZy7m1HUU7MRU4nUMXAHNFBEJhkTZV9HdaL4gfuNBxLPc3BeMkLGaPbF5vWtANQsGwTGg55Kq4p3ENE7";
+
+static void add_cryptonote_cases()
+{
+    library* lib = load_library("libcryptonote");
+    if (lib == nullptr)
+        return;
+
+    if (auto fn = resolve<cnote_convert_blob_fn>(lib, "convert_blob_export")) {
+        add_case("libcryptonote", "convert_blob_export", "Monero template", 1, [=]() -> worker_fn {
+            auto blob = std::make_shared<std::vector<uint8_t>>(hex_bytes(cryptonote_blob));
+            auto output = std::make_shared<std::vector<uint8_t>>(blob->size() + 64);
+
+            return [=](uint64_t) {
+                unsigned int size = static_cast<unsigned int>(output->size());
+                fn(reinterpret_cast<const char*>(blob->data()), static_cast<unsigned int>(blob->size()), output->data(), &size);
+            };
+        });
+    }
+
+    // per share, the template path only hashes the miner transaction and walks its merkle branch
+    auto template_create = resolve<cnote_template_create_fn>(lib, "convert_blob_template_create_export");
+    auto template_free = resolve<cnote_template_free_fn>(lib, "convert_blob_template_free_export");
+    auto convert_template = resolve<cnote_convert_template_fn>(lib, "convert_blob_template_export");
+    auto convert_blob = resolve<cnote_convert_blob_fn>(lib, "convert_blob_export");
+
+    for (uint32_t tx_count : { 0u, 100u }) {
+        const std::string variant = std::to_string(tx_count) + " transactions";
+
+        if (convert_blob != nullptr && tx_count > 0) {
+            add_case("libcryptonote", "convert_blob_export", variant, 1, [=]() -> worker_fn {
+                auto blob = std::make_shared<std::vector<uint8_t>>(cryptonote_template(tx_count));
+                auto output = std::make_shared<std::vector<uint8_t>>(blob->size() + 64);
+
+                return [=](uint64_t i) {
+                    unsigned int size = static_cast<unsigned int>(output->size());
+                    set_nonce(blob->data(), 43, i);
+                    convert_blob(reinterpret_cast<const char*>(blob->data()), static_cast<unsigned int>(blob->size()), output->data(), &size);
+                };
+            });
+        }
+
+        if (template_create == nullptr || template_free == nullptr || convert_template == nullptr)
+            continue;
+
+        const std::vector<uint8_t> blob = cryptonote_template(tx_count);
+        void* created = template_create(reinterpret_cast<const char*>(blob.data()), static_cast<unsigned int>(blob.size()),
+            cryptonote_reserved_offset, 8);
+
+        if (created == nullptr) {
+            fprintf(stderr, "cryptonote: the block template did not parse, convert_blob_template_export skipped\n");
+            continue;
+        }
+
+        // one template per job, shared by every thread like the pool's current job
+        auto tmpl = std::shared_ptr<void>(created, template_free);
+
+        add_case("libcryptonote", "convert_blob_template_export", variant, 1, [=]() -> worker_fn {
+            auto extra_nonce = std::make_shared<std::vector<uint8_t>>(make_input(4));
+            auto output = std::make_shared<std::vector<uint8_t>>(blob.size() + 64);
+
+            return [=](uint64_t i) {
+                unsigned int size = static_cast<unsigned int>(output->size());
+                const uint32_t nonce = static_cast<uint32_t>(i);
+
+                convert_template(tmpl.get(), extra_nonce->data(), 4, reinterpret_cast<const unsigned char*>(&nonce), output->data(), &size);
+            };
+        });
+    }
+
+    for (auto address : { std::make_pair("decode_address_export", cryptonote_address),
+                          std::make_pair("decode_integrated_address_export", cryptonote_integrated_address) }) {
+        if (auto fn = resolve<cnote_decode_fn>(lib, address.first)) {
+            const char* text = address.second;
+
+            add_case("libcryptonote", address.first, "", 1, [=]() -> worker_fn {
+                auto sink = std::make_shared<uint64_t>();
+
+                return [=](uint64_t) {
+                    *sink += fn(text, static_cast<unsigned int>(strlen(text)));
+                };
+            });
+        }
+    }
+
+    // miner logins of a busy port: the same few addresses over and over, answered from the cache
+    if (auto fn = resolve<cnote_validate_batch_fn>(lib, "validate_addresses_batch_export")) {
+        const uint32_t count = 64;
+
+        add_case("libcryptonote", "validate_addresses_batch_export", "batch 64", count, [=]() -> worker_fn {
+            auto inputs = std::make_shared<std::vector<const char*>>(count);
+            auto lengths = std::make_shared<std::vector<uint32_t>>(count);
+            auto prefixes = std::make_shared<std::vector<uint64_t>>(count);
+            auto integrated_prefixes = std::make_shared<std::vector<uint64_t>>(count);
+
+            for (uint32_t k = 0; k < count; k++) {
+                (*inputs)[k] = k % 2 == 0 ? cryptonote_address : cryptonote_integrated_address;
+                (*lengths)[k] = static_cast<uint32_t>(strlen((*inputs)[k]));
+            }
+
+            return [=](uint64_t) {
+                fn(inputs->data(), lengths->data(), count, prefixes->data(), integrated_prefixes->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<cnote_fast_hash_fn>(lib, "cn_fast_hash_export")) {
+        for (uint32_t len : { 64u, 76u }) {
+            add_case("libcryptonote", "cn_fast_hash_export", std::to_string(len) + "B", 1, [=]() -> worker_fn {
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(len));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), len, i);
+                    fn(reinterpret_cast<const char*>(input->data()), output->data(), len);
+                };
+            });
+        }
+    }
+}
+
+/*
+ * librandomx
+ */
+
+typedef int32_t (*rx_get_flags_fn)();
+typedef bool (*rx_set_seed_fn)(const char*, const uint8_t*, uint32_t, int32_t, int32_t, int32_t);
+typedef bool (*rx_hash_fn)(const char*, const uint8_t*, uint32_t, const uint8_t*, uint32_t, uint8_t*);
+typedef bool (*rx_hash_batch_fn)(const char*, const uint8_t*, uint32_t, const uint8_t* const*, const uint32_t*, uint32_t, uint8_t*);
+typedef void* (*rx_seed_open_fn)(const char*, const uint8_t*, uint32_t);
+typedef bool (*rx_seed_hash_fn)(const void*, const uint8_t*, uint32_t, uint8_t*);
+typedef bool (*rx_seed_hash_batch_fn)(const void*, const uint8_t* const*, const uint32_t*, uint32_t, uint8_t*);
+
+static const char* rx_realm = "bench";
+static const char* rx_seed = "test key 000";
+
+static void add_randomx_batch(const char* name, uint32_t count, std::function<void(const uint8_t* const*, const uint32_t*, uint8_t*)> hash)
+{
+    add_case("librandomx", name, "light, batch " + std::to_string(count), count, [=]() -> worker_fn {
+        auto inputs = std::make_shared<std::vector<uint8_t>>(make_input(76 * count));
+        auto pointers = std::make_shared<std::vector<const uint8_t*>>(count);
+        auto lengths = std::make_shared<std::vector<uint32_t>>(count, 76);
+        auto outputs = std::make_shared<std::vector<uint8_t>>(32 * count);
+
+        for (uint32_t k = 0; k < count; k++)
+            (*pointers)[k] = inputs->data() + 76 * k;
+
+        return [=](uint64_t i) {
+            set_nonce(inputs->data(), 43, i);
+            hash(pointers->data(), lengths->data(), outputs->data());
+        };
+    });
+}
+
+/*
+ * Light mode only: a full-memory dataset takes 2 GB and most of a minute to build before the first
+ * case could run. Every thread gets a VM of its own, so the cases time hashing, not waiting for one.
+ */
+static void add_randomx_cases(uint32_t max_threads)
+{
+    library* lib = load_library("librandomx");
+    if (lib == nullptr)
+        return;
+
+    auto get_flags = resolve<rx_get_flags_fn>(lib, "randomx_get_flags");
+    auto set_seed = resolve<rx_set_seed_fn>(lib, "rx_realm_set_seed");
+
+    const uint8_t* seed = reinterpret_cast<const uint8_t*>(rx_seed);
+    const uint32_t seed_len = static_cast<uint32_t>(strlen(rx_seed));
+
+    if (get_flags == nullptr || set_seed == nullptr || !set_seed(rx_realm, seed, seed_len, get_flags(), max_threads, 0))
+        return;
+
+    if (auto fn = resolve<rx_hash_fn>(lib, "rx_hash")) {
+        add_case("librandomx", "rx_hash", "light", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(76));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 43, i);
+                fn(rx_realm, seed, seed_len, input->data(), 76, output->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<rx_hash_batch_fn>(lib, "rx_hash_batch")) {
+        add_randomx_batch("rx_hash_batch", 16, [=](const uint8_t* const* inputs, const uint32_t* lengths, uint8_t* outputs) {
+            fn(rx_realm, seed, seed_len, inputs, lengths, 16, outputs);
+        });
+    }
+
+    // the handle is opened once, as a job does for its seed, and kept until exit
+    auto open = resolve<rx_seed_open_fn>(lib, "rx_seed_open");
+    void* handle = open != nullptr ? open(rx_realm, seed, seed_len) : nullptr;
+
+    if (handle == nullptr)
+        return;
+
+    if (auto fn = resolve<rx_seed_hash_fn>(lib, "rx_seed_hash")) {
+        add_case("librandomx", "rx_seed_hash", "light", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(76));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 43, i);
+                fn(handle, input->data(), 76, output->data());
+            };
+        });
+    }
+
+    if (auto fn = resolve<rx_seed_hash_batch_fn>(lib, "rx_seed_hash_batch")) {
+        add_randomx_batch("rx_seed_hash_batch", 16, [=](const uint8_t* const* inputs, const uint32_t* lengths, uint8_t* outputs) {
+            fn(handle, inputs, lengths, 16, outputs);
+        });
+    }
+}
+
+/*
+ * libethhash
+ */
+
+struct ethash_return_value
+{
+    uint8_t result[32];
+    uint8_t mix_hash[32];
+    bool success;
+} __attribute__((packed));
+
+typedef void* (*eth_light_new_fn)(uint64_t);
+typedef void (*eth_compute_fn)(void*, const uint8_t*, uint64_t, ethash_return_value*);
+typedef void* (*eth_full_new_fn)(const char*, void*, int (*)(unsigned));
+
+static void add_ethhash_cases()
+{
+    library* lib = load_library("libethhash");
+    if (lib == nullptr)
+        return;
+
+    auto light_new = resolve<eth_light_new_fn>(lib, "ethash_light_new_export");
+    auto light_compute = resolve<eth_compute_fn>(lib, "ethash_light_compute_export");
+
+    if (light_new == nullptr || light_compute == nullptr)
+        return;
+
+    // the light cache is read-only while hashing and shared by all threads, as in the pool; never freed
+    void* light = light_new(0);
+
+    add_case("libethhash", "ethash_light_compute_export", "epoch 0", 1, [=]() -> worker_fn {
+        auto header = std::make_shared<std::vector<uint8_t>>(make_input(32));
+
+        return [=](uint64_t i) {
+            ethash_return_value result;
+            light_compute(light, header->data(), i, &result);
+        };
+    });
+
+    if (ethash_dag_dir.empty())
+        return;
+
+    auto full_new = resolve<eth_full_new_fn>(lib, "ethash_full_new_export");
+    auto full_compute = resolve<eth_compute_fn>(lib, "ethash_full_compute_export");
+
+    void* full = full_new != nullptr ? full_new(ethash_dag_dir.c_str(), light, nullptr) : nullptr;
+    if (full == nullptr || full_compute == nullptr) {
+        fprintf(stderr, "ethash: could not build the DAG in %s, skipped\n", ethash_dag_dir.c_str());
+        return;
+    }
+
+    add_case("libethhash", "ethash_full_compute_export", "epoch 0", 1, [=]() -> worker_fn {
+        auto header = std::make_shared<std::vector<uint8_t>>(make_input(32));
+
+        return [=](uint64_t i) {
+            ethash_return_value result;
+            full_compute(full, header->data(), i, &result);
+        };
+    });
+}
+
+/*
+ * libkawpow, libfiropow
+ */
+
+struct hash256
+{
+    uint8_t bytes[32];
+};
+
+struct progpow_result
+{
+    hash256 final_hash;
+    hash256 mix_hash;
+};
+
+typedef void* (*pp_create_context_fn)(int);
+typedef progpow_result (*kp_hashext_fn)(const void*, int, const hash256*, uint64_t, const hash256*, const hash256*, const hash256*, int*);
+typedef bool (*kp_verify_fn)(const void*, int, const hash256*, const hash256*, uint64_t, const hash256*);
+typedef void (*fp_destroy_context_fn)(void*);
+typedef const char* (*fp_version_fn)();
+
+static void add_progpow_cases()
+{
+    if (library* lib = load_library("libkawpow")) {
+        auto create = resolve<pp_create_context_fn>(lib, "ethash_create_epoch_context");
+        auto hashext = resolve<kp_hashext_fn>(lib, "hashext");
+        auto verify = resolve<kp_verify_fn>(lib, "verify");
+
+        // epoch 0 light cache, shared by all threads and kept until exit
+        void* context = create != nullptr ? create(0) : nullptr;
+
+        hash256 header, mix, boundary;
+        memcpy(header.bytes, make_input(32).data(), 32);
+        test_from_hex(kawpow_mix, mix.bytes, 32);
+        memset(boundary.bytes, 0xff, 32);
+
+        if (context != nullptr && hashext != nullptr) {
+            add_case("libkawpow", "hashext", "block 100", 1, [=]() -> worker_fn {
+                return [=](uint64_t) {
+                    int retcode;
+                    hashext(context, 100, &header, kawpow_nonce, &mix, &boundary, &boundary, &retcode);
+                };
+            });
+        }
+
+        if (context != nullptr && verify != nullptr) {
+            add_case("libkawpow", "verify", "block 100", 1, [=]() -> worker_fn {
+                return [=](uint64_t) {
+                    verify(context, 100, &header, &mix, kawpow_nonce, &boundary);
+                };
+            });
+        }
+    }
+
+    if (library* lib = load_library("libfiropow")) {
+        auto create = resolve<pp_create_context_fn>(lib, "firopow_create_epoch_context");
+        void* context = create != nullptr ? create(0) : nullptr;
+
+        // firopow_hash and the verify exports stay out of the library until it has a FiroPow kernel,
+        // so only the cached epoch context is timed here
+        if (context != nullptr) {
+            auto destroy = resolve<fp_destroy_context_fn>(lib, "firopow_destroy_epoch_context");
+
+            if (destroy != nullptr) {
+                add_case("libfiropow", "firopow_create_epoch_context", "cached epoch 0", 1, [=]() -> worker_fn {
+                    return [=](uint64_t) {
+                        destroy(create(0));
+                    };
+                });
+            }
+        }
+
+        if (auto version = resolve<fp_version_fn>(lib, "firopow_get_version"))
+            dispatch_info.emplace_back("firopow", version());
+    }
+}
+
+/*
+ * libverushash
+ */
+
+typedef void (*vh_hash_fn)(const uint8_t*, uint8_t*, uint32_t);
+typedef void* (*vh_create_fn)();
+typedef void (*vh_destroy_fn)(void*);
+typedef void (*vh_update_fn)(void*, const uint8_t*, uint32_t);
+typedef void (*vh_finalize_fn)(void*, uint8_t*);
+typedef void (*vh_haraka_fn)(const uint8_t*, uint8_t*);
+typedef void* (*vh_job_create_fn)(const uint8_t*, uint32_t, uint32_t, uint32_t);
+typedef void (*vh_job_destroy_fn)(void*);
+typedef void (*vh_hash_batch_fn)(const void*, const uint8_t*, uint32_t, uint8_t*);
+typedef const char* (*vh_version_fn)();
+
+static void add_verushash_cases()
+{
+    library* lib = load_library("libverushash");
+    if (lib == nullptr)
+        return;
+
+    if (auto fn = resolve<vh_hash_fn>(lib, "verushash_hash")) {
+        // 80 byte legacy header and the full 1487 byte header with solution
+        for (uint32_t len : { 80u, 1487u }) {
+            add_case("libverushash", "verushash_hash", std::to_string(len) + "B", 1, [=]() -> worker_fn {
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(len));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), len, i);
+                    fn(input->data(), output->data(), len);
+                };
+            });
+        }
+    }
+
+    auto create = resolve<vh_create_fn>(lib, "verushash_create_context");
+    auto destroy = resolve<vh_destroy_fn>(lib, "verushash_destroy_context");
+    auto update = resolve<vh_update_fn>(lib, "verushash_update");
+    auto finalize = resolve<vh_finalize_fn>(lib, "verushash_finalize");
+
+    if (create != nullptr && destroy != nullptr && update != nullptr && finalize != nullptr) {
+        add_case("libverushash", "verushash_update+finalize", "80B", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(80));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 80, i);
+
+                void* ctx = create();
+                update(ctx, input->data(), 80);
+                finalize(ctx, output->data());
+                destroy(ctx);
+            };
+        });
+    }
+
+    auto job_create = resolve<vh_job_create_fn>(lib, "verushash_job_create");
+    auto job_destroy = resolve<vh_job_destroy_fn>(lib, "verushash_job_destroy");
+    auto hash_batch = resolve<vh_hash_batch_fn>(lib, "verushash_hash_batch");
+
+    // 1487 byte header with its 32 byte nonce at 108; batches of 64 and up are spread over the library's own pool
+    if (job_create != nullptr && job_destroy != nullptr && hash_batch != nullptr) {
+        for (uint32_t count : { 16u, 64u }) {
+            add_case("libverushash", "verushash_hash_batch", "1487B, batch " + std::to_string(count), count, [=]() -> worker_fn {
+                const std::vector<uint8_t> header = make_input(1487);
+                auto job = std::shared_ptr<void>(job_create(header.data(), 1487, 108, 32), job_destroy);
+                auto nonces = std::make_shared<std::vector<uint8_t>>(make_input(32 * count));
+                auto outputs = std::make_shared<std::vector<uint8_t>>(32 * count);
+
+                return [=](uint64_t i) {
+                    set_nonce(nonces->data(), 32, i);
+                    hash_batch(job.get(), nonces->data(), count, outputs->data());
+                };
+            });
+        }
+    }
+
+    if (auto fn = resolve<vh_haraka_fn>(lib, "haraka512")) {
+        add_case("libverushash", "haraka512", "64B", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(64));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 64, i);
+                fn(input->data(), output->data());
+            };
+        });
+    }
+
+    if (auto version = resolve<vh_version_fn>(lib, "verushash_get_version"))
+        dispatch_info.emplace_back("verushash", version());
+}
+
+/*
+ * libblake3
+ */
+
+typedef void (*b3_hash_fn)(const uint8_t*, size_t, uint8_t*);
+typedef void* (*b3_create_fn)();
+typedef void (*b3_update_fn)(void*, const uint8_t*, size_t);
+typedef void (*b3_finalize_fn)(void*, uint8_t*, size_t);
+typedef void (*b3_destroy_fn)(void*);
+typedef void (*b3_custom_length_fn)(const uint8_t*, size_t, uint8_t*, size_t);
+typedef void (*b3_keyed_fn)(const uint8_t*, const uint8_t*, size_t, uint8_t*);
+typedef void (*b3_batch_fn)(const uint8_t* const*, const size_t*, size_t, uint8_t*);
+typedef const char* (*b3_backend_fn)();
+
+static void add_blake3_batch(library* lib, const char* name, uint32_t count)
+{
+    auto fn = resolve<b3_batch_fn>(lib, name);
+    if (fn == nullptr)
+        return;
+
+    // 326 bytes, the size of an Alephium/IronFish style mining header
+    const size_t len = 326;
+
+    add_case("libblake3", name, "326B, batch " + std::to_string(count), count, [=]() -> worker_fn {
+        auto inputs = std::make_shared<std::vector<uint8_t>>(make_input(len * count));
+        auto pointers = std::make_shared<std::vector<const uint8_t*>>(count);
+        auto lengths = std::make_shared<std::vector<size_t>>(count, len);
+        auto outputs = std::make_shared<std::vector<uint8_t>>(32 * count);
+
+        for (uint32_t k = 0; k < count; k++)
+            (*pointers)[k] = inputs->data() + len * k;
+
+        return [=](uint64_t i) {
+            set_nonce(inputs->data(), len, i);
+            fn(pointers->data(), lengths->data(), count, outputs->data());
+        };
+    });
+}
+
+static void add_blake3_cases()
+{
+    library* lib = load_library("libblake3");
+    if (lib == nullptr)
+        return;
+
+    if (auto fn = resolve<b3_hash_fn>(lib, "blake3_hash_simple")) {
+        for (size_t len : { 80, 326, 4096 }) {
+            add_case("libblake3", "blake3_hash_simple", std::to_string(len) + "B", 1, [=]() -> worker_fn {
+                auto input = std::make_shared<std::vector<uint8_t>>(make_input(len));
+                auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+                return [=](uint64_t i) {
+                    set_nonce(input->data(), len, i);
+                    fn(input->data(), len, output->data());
+                };
+            });
+        }
+    }
+
+    auto create = resolve<b3_create_fn>(lib, "blake3_create_hasher");
+    auto update = resolve<b3_update_fn>(lib, "blake3_update_hasher");
+    auto finalize = resolve<b3_finalize_fn>(lib, "blake3_finalize_hasher");
+    auto destroy = resolve<b3_destroy_fn>(lib, "blake3_destroy_hasher");
+
+    if (create != nullptr && update != nullptr && finalize != nullptr && destroy != nullptr) {
+        add_case("libblake3", "blake3_update_hasher+finalize", "326B", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(326));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 326, i);
+
+                void* hasher = create();
+                update(hasher, input->data(), 326);
+                finalize(hasher, output->data(), 32);
+                destroy(hasher);
+            };
+        });
+    }
+
+    if (auto fn = resolve<b3_custom_length_fn>(lib, "blake3_hash_custom_length")) {
+        add_case("libblake3", "blake3_hash_custom_length", "326B -> 64B", 1, [=]() -> worker_fn {
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(326));
+            auto output = std::make_shared<std::vector<uint8_t>>(64);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 326, i);
+                fn(input->data(), 326, output->data(), 64);
+            };
+        });
+    }
+
+    if (auto fn = resolve<b3_keyed_fn>(lib, "blake3_hash_keyed")) {
+        add_case("libblake3", "blake3_hash_keyed", "326B", 1, [=]() -> worker_fn {
+            auto key = std::make_shared<std::vector<uint8_t>>(make_input(32));
+            auto input = std::make_shared<std::vector<uint8_t>>(make_input(326));
+            auto output = std::make_shared<std::vector<uint8_t>>(32);
+
+            return [=](uint64_t i) {
+                set_nonce(input->data(), 326, i);
+                fn(key->data(), input->data(), 326, output->data());
+            };
+        });
+    }
+
+    for (uint32_t count : { 1u, 16u }) {
+        add_blake3_batch(lib, "blake3_hash_batch", count);
+        add_blake3_batch(lib, "blake3_double_hash_batch", count);
+    }
+
+    if (auto backend = resolve<b3_backend_fn>(lib, "blake3_backend"))
+        dispatch_info.emplace_back("blake3", backend());
+}
+
+/*
+ * Runner
+ */
+
+static std::string case_label(const bench_case& c)
+{
+    return c.library + "/" + c.name + (c.variant.empty() ? "" : " " + c.variant);
+}
+
+static thread_result run_threads(const bench_case& c, uint32_t threads, double duration)
+{
+    std::vector<worker_fn> workers;
+    for (uint32_t t = 0; t < threads; t++)
+        workers.push_back(c.make_worker());
+
+    std::atomic<uint32_t> ready(0);
+    std::atomic<bool> go(false), stop(false);
+    std::vector<uint64_t> calls(threads, 0);
+    std::vector<std::thread> pool;
+
+    for (uint32_t t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            const worker_fn& work = workers[t];
+            uint64_t n = 0;
+
+            work(0);    // warm caches and lazily built state outside the timed window
+
+            ready++;
+            while (!go.load(std::memory_order_acquire))
+                std::this_thread::yield();
+
+            while (!stop.load(std::memory_order_relaxed))
+                work(++n);
+
+            calls[t] = n;
+        });
+    }
+
+    while (ready.load() < threads)
+        std::this_thread::yield();
+
+    const auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration));
+    stop.store(true);
+
+    for (auto& thread : pool)
+        thread.join();
+
+    // the last call of every thread may finish after the stop flag, so time up to the joins
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t total = 0;
+    for (uint64_t n : calls)
+        total += n;
+
+    return thread_result { threads, total * c.hashes_per_call, seconds };
+}
+
+static std::vector<uint32_t> thread_counts(uint32_t max_threads)
+{
+    std::vector<uint32_t> counts;
+
+    for (uint32_t t = 1; t < max_threads; t *= 2)
+        counts.push_back(t);
+
+    counts.push_back(max_threads);
+    return counts;
+}
+
+static std::string json_escape(const std::string& s)
+{
+    std::string out;
+
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+
+        if (static_cast<unsigned char>(c) >= 0x20)
+            out += c;
+    }
+
+    return out;
+}
+
+static std::string cpu_model()
+{
+    FILE* f = fopen("/proc/cpuinfo", "r");
+    if (f == nullptr)
+        return "unknown";
+
+    char line[512];
+    std::string model = "unknown";
+
+    while (fgets(line, sizeof(line), f) != nullptr) {
+        if (strncmp(line, "model name", 10) == 0) {
+            const char* value = strchr(line, ':');
+            if (value != nullptr) {
+                model = value + 2;
+                model.erase(model.find_last_not_of("\r\n") + 1);
+            }
+            break;
+        }
+    }
+
+    fclose(f);
+    return model;
+}
+
+static bool write_json(const char* path, uint32_t max_threads, double duration,
+    const std::vector<std::pair<const bench_case*, std::vector<thread_result>>>& results)
+{
+    FILE* f = fopen(path, "w");
+    if (f == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path);
+        return false;
+    }
+
+    fprintf(f, "{\n  \"schema\": 1,\n  \"timestamp\": %lld,\n", static_cast<long long>(time(nullptr)));
+    fprintf(f, "  \"host\": { \"cpu\": \"%s\", \"hardware_threads\": %u, \"compiler\": \"%s\" },\n",
+        json_escape(cpu_model()).c_str(), std::thread::hardware_concurrency(), json_escape(__VERSION__).c_str());
+    fprintf(f, "  \"config\": { \"max_threads\": %u, \"duration_ms\": %.0f },\n", max_threads, duration * 1000.0);
+
+    fprintf(f, "  \"dispatch\": {");
+    for (size_t i = 0; i < dispatch_info.size(); i++)
+        fprintf(f, "%s \"%s\": \"%s\"", i ? "," : "", json_escape(dispatch_info[i].first).c_str(), json_escape(dispatch_info[i].second).c_str());
+    fprintf(f, " },\n");
+
+    fprintf(f, "  \"libraries\": [\n");
+    for (size_t i = 0; i < libraries.size(); i++) {
+        const library& lib = libraries[i];
+        fprintf(f, "    { \"name\": \"%s\", \"path\": \"%s\", \"loaded\": %s, \"error\": \"%s\" }%s\n", lib.name.c_str(),
+            json_escape(lib.path).c_str(), lib.handle ? "true" : "false", json_escape(lib.error).c_str(), i + 1 < libraries.size() ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_case& c = *results[i].first;
+        const std::vector<thread_result>& runs = results[i].second;
+        const double single = runs[0].hashes / runs[0].seconds;
+
+        fprintf(f, "    { \"library\": \"%s\", \"export\": \"%s\", \"variant\": \"%s\", \"hashes_per_call\": %u, \"ns_per_hash\": %.1f,\n",
+            c.library.c_str(), c.name.c_str(), json_escape(c.variant).c_str(), c.hashes_per_call, single > 0 ? 1e9 / single : 0.0);
+        fprintf(f, "      \"scaling\": [\n");
+
+        for (size_t k = 0; k < runs.size(); k++) {
+            const double rate = runs[k].hashes / runs[k].seconds;
+            fprintf(f, "        { \"threads\": %u, \"hashes\": %llu, \"seconds\": %.4f, \"hashes_per_sec\": %.1f, \"hashes_per_sec_per_core\": %.1f, \"efficiency\": %.3f }%s\n",
+                runs[k].threads, static_cast<unsigned long long>(runs[k].hashes), runs[k].seconds, rate, rate / runs[k].threads,
+                single > 0 ? rate / (single * runs[k].threads) : 0.0, k + 1 < runs.size() ? "," : "");
+        }
+
+        fprintf(f, "      ] }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+
+    fclose(f);
+    return true;
+}
+
+static void usage()
+{
+    printf("usage: native_bench [--list] [--filter TEXT] [--threads N] [--duration MS] [--json FILE]\n"
+           "                    [--lib-dir DIR] [--verthash-file FILE] [--ethash-dag-dir DIR]\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    double duration = 0.3;
+    const char* json_path = nullptr;
+    std::string filter;
+    bool list = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--list")
+            list = true;
+        else if (arg == "--filter" && has_value)
+            filter = argv[++i];
+        else if (arg == "--threads" && has_value)
+            max_threads = std::max(1, atoi(argv[++i]));
+        else if (arg == "--duration" && has_value)
+            duration = std::max(1, atoi(argv[++i])) / 1000.0;
+        else if (arg == "--json" && has_value)
+            json_path = argv[++i];
+        else if (arg == "--lib-dir" && has_value)
+            lib_dir = argv[++i];
+        else if (arg == "--verthash-file" && has_value)
+            verthash_file = argv[++i];
+        else if (arg == "--ethash-dag-dir" && has_value)
+            ethash_dag_dir = argv[++i];
+        else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    add_multihash_cases();
+    add_cryptonight_cases(max_threads);
+    add_cryptonote_cases();
+    add_randomx_cases(max_threads);
+    add_ethhash_cases();
+    add_progpow_cases();
+    add_verushash_cases();
+    add_blake3_cases();
+
+    for (const auto& lib : libraries) {
+        if (lib.handle == nullptr)
+            fprintf(stderr, "%s: not loaded, skipped (%s)\n", lib.name.c_str(), lib.error.c_str());
+    }
+
+    if (list) {
+        for (const auto& c : cases)
+            printf("%s\n", case_label(c).c_str());
+
+        return 0;
+    }
+
+    for (const auto& info : dispatch_info)
+        printf("%s: %s\n", info.first.c_str(), info.second.c_str());
+
+    const std::vector<uint32_t> counts = thread_counts(max_threads);
+    std::vector<std::pair<const bench_case*, std::vector<thread_result>>> results;
+
+    printf("\n%-64s %12s %14s", "case", "ns/hash", "H/s/core @1");
+    for (size_t k = 1; k < counts.size(); k++)
+        printf("  %9s", ("x" + std::to_string(counts[k])).c_str());
+    printf("\n");
+
+    for (const auto& c : cases) {
+        if (!filter.empty() && case_label(c).find(filter) == std::string::npos)
+            continue;
+
+        std::vector<thread_result> runs;
+        for (uint32_t threads : counts)
+            runs.push_back(run_threads(c, threads, duration));
+
+        // ns/hash on one thread, then per-core throughput at each thread count relative to one thread
+        const double single = runs[0].hashes / runs[0].seconds;
+        printf("%-64s %12.1f %14.1f", case_label(c).c_str(), single > 0 ? 1e9 / single : 0.0, single);
+
+        for (size_t k = 1; k < runs.size(); k++) {
+            const double per_core = runs[k].hashes / runs[k].seconds / runs[k].threads;
+            printf("  %8.0f%%", single > 0 ? 100.0 * per_core / single : 0.0);
+        }
+
+        printf("\n");
+        fflush(stdout);
+
+        results.emplace_back(&c, runs);
+    }
+
+    if (json_path != nullptr && !write_json(json_path, max_threads, duration, results))
+        return 1;
+
+    return 0;
+}
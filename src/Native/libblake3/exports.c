@@ -1,5 +1,6 @@
 // Blake3 C wrapper for Miningcore .NET interop
 #include "c/blake3.h"
+#include "c/blake3_impl.h"
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -72,3 +73,120 @@ EXPORT void blake3_hash_keyed(const uint8_t* key, const uint8_t* input,
     blake3_hasher_update(&hasher, input, input_len);
     blake3_hasher_finalize(&hasher, output, BLAKE3_OUT_LEN);
 }
+
+// Name of the SIMD backend blake3_dispatch.c selects on this CPU: "avx512", "avx2",
+// "sse41", "sse2", "neon" or "portable"
+EXPORT const char* blake3_backend(void) {
+    switch (blake3_simd_degree()) {
+    case 16:
+        return "avx512";
+    case 8:
+        return "avx2";
+    case 4:
+#if defined(IS_X86)
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("sse4.1") ? "sse41" : "sse2";
+#else
+        {
+            int regs[4];
+            __cpuid(regs, 1);
+            return regs[2] & (1 << 19) ? "sse41" : "sse2";
+        }
+#endif
+#else
+        return "neon";
+#endif
+    default:
+        return "portable";
+    }
+}
+
+// Number of inputs blake3_hash_many processes in parallel with the selected backend
+EXPORT int blake3_simd_lanes(void) {
+    return (int) blake3_simd_degree();
+}
+
+// Inputs hashed per blake3_hash_many call in the batch exports
+#define BLAKE3_BATCH_GROUP 64
+
+// Hashes count inputs of the same length len (1..BLAKE3_CHUNK_LEN) that fit in a
+// single chunk. All 64 byte blocks but a partial last one go through blake3_hash_many,
+// which runs one input per SIMD lane; a partial last block has its own block length
+// and is finished with a single compression per input.
+static void hash_single_chunk_group(const uint8_t* const* inputs, size_t len, size_t count,
+                                    uint8_t* outputs) {
+    const size_t blocks = (len + BLAKE3_BLOCK_LEN - 1) / BLAKE3_BLOCK_LEN;
+    const size_t last_len = len - (blocks - 1) * BLAKE3_BLOCK_LEN;
+    uint32_t cv[8];
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    size_t i;
+
+    if (last_len == BLAKE3_BLOCK_LEN) {
+        blake3_hash_many(inputs, count, blocks, IV, 0, false, 0,
+                         CHUNK_START, CHUNK_END | ROOT, outputs);
+        return;
+    }
+
+    if (blocks > 1)
+        blake3_hash_many(inputs, count, blocks - 1, IV, 0, false, 0, CHUNK_START, 0, outputs);
+
+    for (i = 0; i < count; i++) {
+        uint8_t* output = outputs + i * BLAKE3_OUT_LEN;
+
+        if (blocks > 1)
+            load_key_words(output, cv);
+        else
+            memcpy(cv, IV, sizeof(cv));
+
+        memset(block, 0, sizeof(block));
+        memcpy(block, inputs[i] + (blocks - 1) * BLAKE3_BLOCK_LEN, last_len);
+
+        blake3_compress_in_place(cv, block, (uint8_t) last_len, 0,
+                                 CHUNK_END | ROOT | (blocks == 1 ? CHUNK_START : 0));
+        store_cv_words(output, cv);
+    }
+}
+
+// Hashes count inputs into consecutive 32 byte outputs. Runs of equal length inputs
+// that fit in one chunk (up to 1024 bytes, which covers mining headers) are hashed
+// several at a time; anything else falls back to the streaming hasher.
+EXPORT void blake3_hash_batch(const uint8_t* const* inputs, const size_t* lengths, size_t count,
+                              uint8_t* outputs) {
+    size_t i = 0;
+
+    while (i < count) {
+        const size_t len = lengths[i];
+        size_t n = 1;
+
+        if (len == 0 || len > BLAKE3_CHUNK_LEN) {
+            blake3_hash_simple(inputs[i], len, outputs + i * BLAKE3_OUT_LEN);
+            i++;
+            continue;
+        }
+
+        while (i + n < count && n < BLAKE3_BATCH_GROUP && lengths[i + n] == len)
+            n++;
+
+        hash_single_chunk_group(inputs + i, len, n, outputs + i * BLAKE3_OUT_LEN);
+        i += n;
+    }
+}
+
+// blake3(blake3(input)) for each input, as used for Alephium share hashes
+EXPORT void blake3_double_hash_batch(const uint8_t* const* inputs, const size_t* lengths, size_t count,
+                                     uint8_t* outputs) {
+    const uint8_t* first[BLAKE3_BATCH_GROUP];
+    size_t i, k;
+
+    blake3_hash_batch(inputs, lengths, count, outputs);
+
+    for (i = 0; i < count; i += BLAKE3_BATCH_GROUP) {
+        const size_t n = count - i < BLAKE3_BATCH_GROUP ? count - i : BLAKE3_BATCH_GROUP;
+
+        for (k = 0; k < n; k++)
+            first[k] = outputs + (i + k) * BLAKE3_OUT_LEN;
+
+        // each output is only read by its own lane before being overwritten
+        hash_single_chunk_group(first, BLAKE3_OUT_LEN, n, outputs + i * BLAKE3_OUT_LEN);
+    }
+}
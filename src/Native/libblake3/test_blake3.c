@@ -0,0 +1,209 @@
+/*
+ * Blake3 batch export test and benchmark.
+ *
+ * blake3_hash_batch is checked against "abc" and the official BLAKE3 test vectors
+ * (input[i] = i % 251) around the chunk boundary, then both batch exports against the
+ * streaming hasher for every input length around the block and chunk boundaries and
+ * for mixed-length batches.
+ *
+ *   ./test_blake3              run the checks
+ *   ./test_blake3 --benchmark  report ns per share at batch sizes 1 to 64
+ *   ./test_blake3 --backend    print the SIMD backend selected at runtime
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+
+#include "../native_test.h"
+#include "c/blake3.h"
+
+void blake3_hash_simple(const uint8_t* input, size_t input_len, uint8_t* output);
+void blake3_hash_batch(const uint8_t* const* inputs, const size_t* lengths, size_t count, uint8_t* outputs);
+void blake3_double_hash_batch(const uint8_t* const* inputs, const size_t* lengths, size_t count, uint8_t* outputs);
+const char* blake3_backend(void);
+int blake3_simd_lanes(void);
+
+#define MAX_BATCH   70
+#define MAX_LEN     1100
+#define HEADER_LEN  326     /* Alephium mining header */
+
+static uint8_t data[MAX_BATCH][MAX_LEN];
+
+/* test_vectors.json of the BLAKE3 reference implementation */
+static const struct
+{
+    size_t len;
+    const char* expected;
+} official[] = {
+    { 0,    "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262" },
+    { 1,    "2d3adedff11b61f14c886e35afa036736dcd87a74d27b5c1510225d0f592e213" },
+    { 1023, "10108970eeda3eb932baac1428c7a2163b0e924c9a9e25b35bba72b28f70bd11" },
+    { 1024, "42214739f095a406f3fc83deb889744ac00df831c10daa55189b5d121c855af7" },
+    { 1025, "d00278ae47eb27b34faecf67b4fe263f82d5412916c1ffd97c8cb7fb814b8444" },
+};
+
+#define OFFICIAL_COUNT (sizeof(official) / sizeof(official[0]))
+
+static void fill(void)
+{
+    int i, k;
+
+    for (i = 0; i < MAX_BATCH; i++) {
+        for (k = 0; k < MAX_LEN; k++)
+            data[i][k] = (uint8_t) (i * 31 + k * 7 + 1);
+    }
+}
+
+static void double_hash(const uint8_t* input, size_t len, uint8_t out[32])
+{
+    uint8_t first[32];
+
+    blake3_hash_simple(input, len, first);
+    blake3_hash_simple(first, 32, out);
+}
+
+static bool check(const char* name, size_t count, const size_t* lengths)
+{
+    const uint8_t* inputs[MAX_BATCH];
+    uint8_t batch[MAX_BATCH][32], expected[32];
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        inputs[i] = data[i];
+
+    blake3_hash_batch(inputs, lengths, count, batch[0]);
+
+    for (i = 0; i < count; i++) {
+        blake3_hash_simple(inputs[i], lengths[i], expected);
+
+        if (memcmp(batch[i], expected, 32) != 0)
+            return test_fail(name, "blake3_hash_batch input %zu (length %zu)", i, lengths[i]);
+    }
+
+    blake3_double_hash_batch(inputs, lengths, count, batch[0]);
+
+    for (i = 0; i < count; i++) {
+        double_hash(inputs[i], lengths[i], expected);
+
+        if (memcmp(batch[i], expected, 32) != 0)
+            return test_fail(name, "blake3_double_hash_batch input %zu (length %zu)", i, lengths[i]);
+    }
+
+    return true;
+}
+
+static bool run_checks(void)
+{
+    static uint8_t pattern[1025];
+    const uint8_t* abc = (const uint8_t*) "abc";
+    const uint8_t* inputs[OFFICIAL_COUNT];
+    size_t lengths[MAX_BATCH];
+    uint8_t out[OFFICIAL_COUNT][32];
+    char name[32];
+    size_t len, i;
+    bool ok = true;
+
+    len = 3;
+    blake3_hash_batch(&abc, &len, 1, out[0]);
+    ok &= test_check_hex("abc", out[0], 32, "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85");
+
+    /* the official vectors, hashed as one mixed-length batch */
+    for (i = 0; i < sizeof(pattern); i++)
+        pattern[i] = (uint8_t) (i % 251);
+
+    for (i = 0; i < OFFICIAL_COUNT; i++) {
+        inputs[i] = pattern;
+        lengths[i] = official[i].len;
+    }
+
+    blake3_hash_batch(inputs, lengths, OFFICIAL_COUNT, out[0]);
+
+    for (i = 0; i < OFFICIAL_COUNT; i++) {
+        snprintf(name, sizeof(name), "official length %zu", official[i].len);
+        ok &= test_check_hex(name, out[i], 32, official[i].expected);
+    }
+
+    /* every length up past one chunk, in batches wider than any SIMD degree */
+    for (len = 0; len <= MAX_LEN; len++) {
+        for (i = 0; i < MAX_BATCH; i++)
+            lengths[i] = len;
+
+        if (!check("uniform", MAX_BATCH, lengths))
+            break;
+    }
+
+    ok &= len > MAX_LEN && test_pass("uniform");
+
+    /* runs of different lengths in one call */
+    for (i = 0; i < MAX_BATCH; i++)
+        lengths[i] = (i / 5) % 3 == 0 ? HEADER_LEN : (i * 97) % MAX_LEN;
+
+    ok &= check("mixed", MAX_BATCH, lengths) && test_pass("mixed");
+
+    return test_summary("Blake3 batch", ok);
+}
+
+static void run_benchmark(void)
+{
+    static const size_t sizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+    const uint8_t* inputs[MAX_BATCH];
+    size_t lengths[MAX_BATCH];
+    uint8_t out[MAX_BATCH][32];
+    size_t s, i;
+
+    for (i = 0; i < MAX_BATCH; i++) {
+        inputs[i] = data[i];
+        lengths[i] = HEADER_LEN;
+    }
+
+    printf("%d byte headers, ns per share (double Blake3)\n", HEADER_LEN);
+    printf("batch   single     batch\n");
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        const size_t count = sizes[s];
+        const int iterations = (int) (200000 / count);
+        double start, single_ns, batch_ns;
+        int it;
+
+        start = test_now_ns();
+
+        for (it = 0; it < iterations; it++) {
+            data[0][0] = (uint8_t) it;
+
+            for (i = 0; i < count; i++)
+                double_hash(inputs[i], lengths[i], out[i]);
+        }
+
+        single_ns = (test_now_ns() - start) / ((double) iterations * count);
+
+        start = test_now_ns();
+
+        for (it = 0; it < iterations; it++) {
+            data[0][0] = (uint8_t) it;
+            blake3_double_hash_batch(inputs, lengths, count, out[0]);
+        }
+
+        batch_ns = (test_now_ns() - start) / ((double) iterations * count);
+
+        printf("%5zu  %7.1f   %7.1f\n", count, single_ns, batch_ns);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    printf("  Runtime backend: %s (%d lanes)\n", blake3_backend(), blake3_simd_lanes());
+
+    if (argc > 1 && strcmp(argv[1], "--backend") == 0)
+        return 0;
+
+    fill();
+
+    if (!run_checks())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
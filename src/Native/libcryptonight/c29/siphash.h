@@ -0,0 +1,146 @@
+#pragma once
+
+// SipHash-2-4 edge blocks for the Cuck(at)oo Cycle verifiers
+// Copyright (c) 2013-2019 John Tromp
+
+#include <stdint.h>
+
+#include "c29.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define EDGE_BLOCK_BITS 6
+#define EDGE_BLOCK_SIZE (1 << EDGE_BLOCK_BITS)
+#define EDGE_BLOCK_MASK (EDGE_BLOCK_SIZE - 1)
+
+// SipHash state lives on the caller's stack so verifiers can run on any number of threads.
+// ROT_E is the final v3 rotation: 21 for standard SipHash, 25 for the Cuckarood variant.
+template<int ROT_E>
+struct siphash_state
+{
+	uint64_t v0, v1, v2, v3;
+
+	explicit siphash_state(const siphash_keys *keys) : v0(keys->k0), v1(keys->k1), v2(keys->k2), v3(keys->k3) {}
+
+	static uint64_t rotl(uint64_t x, uint64_t b) {
+		return (x << b) | (x >> (64 - b));
+	}
+	void sip_round() {
+		v0 += v1; v2 += v3; v1 = rotl(v1,13);
+		v3 = rotl(v3,16); v1 ^= v0; v3 ^= v2;
+		v0 = rotl(v0,32); v2 += v1; v0 += v3;
+		v1 = rotl(v1,17);   v3 = rotl(v3,ROT_E);
+		v1 ^= v2; v3 ^= v0; v2 = rotl(v2,32);
+	}
+	void hash24(const uint64_t nonce) {
+		v3 ^= nonce;
+		sip_round(); sip_round();
+		v0 ^= nonce;
+		v2 ^= 0xff;
+		sip_round(); sip_round(); sip_round(); sip_round();
+	}
+	uint64_t xor_lanes() const {
+		return (v0 ^ v1) ^ (v2  ^ v3);
+	}
+};
+
+// The state is chained through all 64 nonces of a block, so an edge's value
+// depends on the whole block and the nonces can't be hashed independently
+template<int ROT_E>
+static uint64_t sipblock(const siphash_keys *keys, const uint32_t edge) {
+	siphash_state<ROT_E> shs(keys);
+	const uint32_t edge0 = edge & ~EDGE_BLOCK_MASK;
+	const uint32_t index = edge & EDGE_BLOCK_MASK;
+	uint64_t value = 0;
+
+	for (uint32_t i=0; i < EDGE_BLOCK_SIZE; i++) {
+		shs.hash24(edge0 + i);
+		if (i == index)
+			value = shs.xor_lanes();
+	}
+	const uint64_t last = shs.xor_lanes();
+	return index == EDGE_BLOCK_MASK ? last : value ^ last;
+}
+
+#if defined(__AVX2__)
+// Four independent blocks (one per edge) hashed side by side, one edge per 64-bit lane
+template<int ROT_E>
+struct siphash_state4
+{
+	__m256i v0, v1, v2, v3;
+
+	explicit siphash_state4(const siphash_keys *keys) :
+		v0(_mm256_set1_epi64x(keys->k0)), v1(_mm256_set1_epi64x(keys->k1)),
+		v2(_mm256_set1_epi64x(keys->k2)), v3(_mm256_set1_epi64x(keys->k3)) {}
+
+	template<int B>
+	static __m256i rotl(__m256i x) {
+#if defined(__AVX512VL__)
+		return _mm256_rol_epi64(x, B);
+#else
+		return _mm256_or_si256(_mm256_slli_epi64(x, B), _mm256_srli_epi64(x, 64 - B));
+#endif
+	}
+	static __m256i rotl16(__m256i x) {
+		return _mm256_shuffle_epi8(x, _mm256_set_epi64x(0x0d0c0b0a09080f0eULL, 0x0504030201000706ULL, 0x0d0c0b0a09080f0eULL, 0x0504030201000706ULL));
+	}
+	static __m256i rotl32(__m256i x) {
+		return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+	}
+	void sip_round() {
+		v0 = _mm256_add_epi64(v0, v1); v2 = _mm256_add_epi64(v2, v3); v1 = rotl<13>(v1);
+		v3 = rotl16(v3); v1 = _mm256_xor_si256(v1, v0); v3 = _mm256_xor_si256(v3, v2);
+		v0 = rotl32(v0); v2 = _mm256_add_epi64(v2, v1); v0 = _mm256_add_epi64(v0, v3);
+		v1 = rotl<17>(v1); v3 = rotl<ROT_E>(v3);
+		v1 = _mm256_xor_si256(v1, v2); v3 = _mm256_xor_si256(v3, v0); v2 = rotl32(v2);
+	}
+	void hash24(const __m256i nonce) {
+		v3 = _mm256_xor_si256(v3, nonce);
+		sip_round(); sip_round();
+		v0 = _mm256_xor_si256(v0, nonce);
+		v2 = _mm256_xor_si256(v2, _mm256_set1_epi64x(0xff));
+		sip_round(); sip_round(); sip_round(); sip_round();
+	}
+	__m256i xor_lanes() const {
+		return _mm256_xor_si256(_mm256_xor_si256(v0, v1), _mm256_xor_si256(v2, v3));
+	}
+};
+
+template<int ROT_E>
+static void sipblock4(const siphash_keys *keys, const uint32_t *edges, uint64_t *out) {
+	siphash_state4<ROT_E> shs(keys);
+	const __m256i edge = _mm256_set_epi64x(edges[3], edges[2], edges[1], edges[0]);
+	const __m256i index = _mm256_and_si256(edge, _mm256_set1_epi64x(EDGE_BLOCK_MASK));
+	const __m256i one = _mm256_set1_epi64x(1);
+	__m256i nonce = _mm256_andnot_si256(_mm256_set1_epi64x(EDGE_BLOCK_MASK), edge);
+	__m256i i = _mm256_setzero_si256();
+	__m256i value = _mm256_setzero_si256();
+
+	for (uint32_t n=0; n < EDGE_BLOCK_SIZE; n++) {
+		shs.hash24(nonce);
+		value = _mm256_blendv_epi8(value, shs.xor_lanes(), _mm256_cmpeq_epi64(i, index));
+		nonce = _mm256_add_epi64(nonce, one);
+		i = _mm256_add_epi64(i, one);
+	}
+	// the last value of each block is xored into all the others
+	const __m256i last = shs.xor_lanes();
+	const __m256i is_last = _mm256_cmpeq_epi64(index, _mm256_set1_epi64x(EDGE_BLOCK_MASK));
+	value = _mm256_blendv_epi8(_mm256_xor_si256(value, last), last, is_last);
+
+	_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), value);
+}
+#endif
+
+// sipblock() of `count` edges, four at a time where AVX2 is available
+template<int ROT_E>
+static void sipblocks(const siphash_keys *keys, const uint32_t *edges, uint32_t count, uint64_t *out) {
+	uint32_t n = 0;
+#if defined(__AVX2__)
+	for (; n + 4 <= count; n += 4)
+		sipblock4<ROT_E>(keys, edges + n, out + n);
+#endif
+	for (; n < count; n++)
+		out[n] = sipblock<ROT_E>(keys, edges[n]);
+}
@@ -24,19 +24,38 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "crypto/common/VirtualMemory.h"
 #include "crypto/cn/CnCtx.h"
+#include "crypto/cn/CryptoNight.h"
 #include "crypto/cn/CnHash.h"
+#include "crypto/cn/CryptoNight_monero.h"
 #include "crypto/astrobwt/AstroBWT.h"
 #include "crypto/kawpow/KPHash.h"
 #include "3rdparty/libethash/ethash.h"
+#include "3rdparty/argon2.h"
 #include "crypto/ghostrider/ghostrider.h"
 #include "crypto/common/portable/mm_malloc.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 extern "C" {
     #include "c29/portable_endian.h" // for htole32/64
     #include "c29/int-util.h"
 }
 
 #include "c29.h"
+#include "kawpow.h"
 
 
 #if (defined(__AES__) && (__AES__ == 1)) || (defined(__ARM_FEATURE_CRYPTO) && (__ARM_FEATURE_CRYPTO == 1))
@@ -65,7 +84,254 @@ extern "C" {
 #define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
 #endif
 
+#if defined(ASM_TYPE)
+#define BATCH_ASM_TYPE ASM_TYPE
+#else
+#define BATCH_ASM_TYPE xmrig::Assembly::NONE
+#endif
+
 constexpr size_t max_mem_size = 20 * 1024 * 1024;
+constexpr size_t huge_page_size = xmrig::VirtualMemory::kDefaultHugePageSize;
+
+// Multi-way contexts: AV_PENTA at most, each lane sized for the largest multi-way scratchpad (cn-heavy)
+constexpr size_t max_batch_ways = 5;
+constexpr size_t batch_lane_mem_size = 4 * 1024 * 1024;
+constexpr size_t max_batch_input_size = 256;
+
+struct cryptonight_batch_ctx {
+    cryptonight_ctx* lanes[max_batch_ways];
+    size_t ways;
+    xmrig::ghostrider::Plan ghostrider_plan;  // plan of the last GhostRider job hashed with this context
+};
+
+// Scratchpad memory backing each context handed out by alloc_context_export/alloc_batch_context_export
+static std::mutex context_mutex;
+static std::unordered_map<void*, xmrig::VirtualMemory*> context_memory;
+// Pool scratchpads of freed contexts by size. xmrig's MemoryPool only hands out memory and takes
+// it back once every scratchpad is released, so they are kept here for the next context instead.
+static std::unordered_map<size_t, std::vector<xmrig::VirtualMemory*>> free_pool_memory;
+static bool context_pool_ready = false;
+static bool context_huge_pages = true;
+static int32_t context_numa_node = -1;
+
+#if defined(__linux__) && defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy)
+// Makes page faults taken by the calling thread prefer a NUMA node while in scope.
+// Used around scratchpad allocation since MAP_POPULATE faults everything in up front.
+class NumaNodeScope
+{
+public:
+    explicit NumaNodeScope(int32_t node)
+    {
+        constexpr int MPOL_PREFERRED_ = 1;
+
+        if (node < 0 || node >= 63)
+            return;
+
+        if (syscall(SYS_get_mempolicy, &m_mode, &m_mask, sizeof(m_mask) * 8, nullptr, 0) != 0)
+            return;
+
+        unsigned long mask = 1UL << node;
+        m_active = syscall(SYS_set_mempolicy, MPOL_PREFERRED_, &mask, sizeof(mask) * 8) == 0;
+    }
+
+    ~NumaNodeScope()
+    {
+        if (m_active)
+            syscall(SYS_set_mempolicy, m_mode, &m_mask, sizeof(m_mask) * 8);
+    }
+
+private:
+    int m_mode = 0;
+    unsigned long m_mask = 0;
+    bool m_active = false;
+};
+#else
+class NumaNodeScope
+{
+public:
+    explicit NumaNodeScope(int32_t) {}
+};
+#endif
+
+// Multi-way hashing pays off while the interleaved scratchpads of all threads still fit L3
+static size_t auto_batch_ways()
+{
+#if defined(_SC_LEVEL3_CACHE_SIZE) && defined(_SC_NPROCESSORS_ONLN)
+    const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    const long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (l3 > 0 && threads > 0)
+        return std::min(max_batch_ways, std::max<size_t>(1, static_cast<size_t>(l3 / threads) / (2 * 1024 * 1024)));
+#endif
+
+    return 2;
+}
+
+// Lanes of a batch context asked for with `ways` (1-5, 0 picks from the L3 size)
+static size_t batch_lanes(uint32_t ways)
+{
+    return ways == 0 ? auto_batch_ways() : std::min<size_t>(ways, max_batch_ways);
+}
+
+// Must be called with context_mutex held
+static void init_context_pool(size_t bytes)
+{
+    NumaNodeScope numa(context_numa_node);
+
+    xmrig::VirtualMemory::init(bytes / huge_page_size, context_huge_pages ? huge_page_size : 0);
+    context_pool_ready = true;
+}
+
+// Must be called with context_mutex held
+static xmrig::VirtualMemory* alloc_scratchpad(size_t size = max_mem_size)
+{
+    if (!context_pool_ready)
+        init_context_pool(0);
+
+    auto free_memory = free_pool_memory.find(xmrig::VirtualMemory::alignToHugePageSize(size));
+    if (free_memory != free_pool_memory.end() && !free_memory->second.empty()) {
+        xmrig::VirtualMemory* memory = free_memory->second.back();
+        free_memory->second.pop_back();
+        return memory;
+    }
+
+    xmrig::VirtualMemory* memory;
+
+    {
+        NumaNodeScope numa(context_numa_node);
+        memory = new xmrig::VirtualMemory(size, context_huge_pages, false, true, context_numa_node < 0 ? 0 : context_numa_node, 4096);
+    }
+
+    if (memory->scratchpad() == nullptr) {
+        delete memory;
+        return nullptr;
+    }
+
+    return memory;
+}
+
+// Must be called with context_mutex held
+static void release_contexts(void* handle, cryptonight_ctx** ctx, size_t count)
+{
+    auto it = context_memory.find(handle);
+    if (it != context_memory.end()) {
+        if (it->second->isPooled())
+            free_pool_memory[it->second->size()].push_back(it->second);
+        else
+            delete it->second;
+
+        context_memory.erase(it);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (ctx[i]->generated_code != nullptr)
+            xmrig::VirtualMemory::freeLargePagesMemory(reinterpret_cast<void*>(ctx[i]->generated_code), 0x4000);
+    }
+
+    xmrig::CnCtx::release(ctx, count);
+}
+
+void v4_compile_code(const V4_Instruction* code, int code_size, void* machine_code, xmrig::Assembly ASM);
+void v4_compile_code_double(const V4_Instruction* code, int code_size, void* machine_code, xmrig::Assembly ASM);
+void v4_soft_aes_compile_code(const V4_Instruction* code, int code_size, void* machine_code, xmrig::Assembly ASM);
+
+// Main loop flavours xmrig JIT-compiles the CN-R random math program into
+enum cn_r_flavour {
+    CN_R_SINGLE,
+    CN_R_DOUBLE,
+    CN_R_SOFT_AES,
+};
+
+constexpr size_t cn_r_code_size = 0x4000;
+constexpr size_t cn_r_cache_slots = 8;
+
+struct cn_r_program {
+    uint64_t height;
+    int flavour;
+    int code_size;
+    V4_Instruction code[NUM_INSTRUCTIONS_MAX + 1];
+    void* machine_code;
+};
+
+/*
+ * CN-R programs only depend on the block height, yet every context used to generate and compile
+ * its own copy whenever the height it last saw changed - once per worker thread and batch lane on
+ * each new block, and on every hash while late shares for the previous block alternate with
+ * current ones. Programs are built once per height and flavour here and copied into the context.
+ * The slot holding the lowest height is recycled first, so old heights drop out as the chain moves on.
+ */
+static std::mutex cn_r_mutex;
+static cn_r_program cn_r_cache[cn_r_cache_slots];
+static size_t cn_r_cache_used = 0;
+
+// Must be called with cn_r_mutex held
+static const cn_r_program* cn_r_get_program(uint64_t height, cn_r_flavour flavour)
+{
+    cn_r_program* slot = nullptr;
+
+    for (size_t i = 0; i < cn_r_cache_used; ++i) {
+        cn_r_program& program = cn_r_cache[i];
+
+        if (program.height == height && program.flavour == flavour)
+            return &program;
+
+        if (slot == nullptr || program.height < slot->height)
+            slot = &program;
+    }
+
+    if (cn_r_cache_used < cn_r_cache_slots) {
+        void* machine_code = xmrig::VirtualMemory::allocateExecutableMemory(cn_r_code_size, false);
+        if (machine_code == nullptr)
+            return nullptr;
+
+        slot = &cn_r_cache[cn_r_cache_used++];
+        slot->machine_code = machine_code;
+    }
+
+    slot->height = height;
+    slot->flavour = flavour;
+    slot->code_size = v4_random_math_init<xmrig::Algorithm::CN_R>(slot->code, height);
+
+    switch (flavour) {
+    case CN_R_SINGLE:
+        v4_compile_code(slot->code, slot->code_size, slot->machine_code, BATCH_ASM_TYPE);
+        break;
+
+    case CN_R_DOUBLE:
+        v4_compile_code_double(slot->code, slot->code_size, slot->machine_code, BATCH_ASM_TYPE);
+        break;
+
+    case CN_R_SOFT_AES:
+        v4_soft_aes_compile_code(slot->code, slot->code_size, slot->machine_code, xmrig::Assembly::NONE);
+        break;
+    }
+
+    return slot;
+}
+
+// Installs the CN-R program for `height` in a context so the hash function skips code generation
+static void cn_r_load_program(cryptonight_ctx* ctx, uint64_t height, cn_r_flavour flavour)
+{
+#if defined(XMRIG_FEATURE_ASM)
+    if (ctx->generated_code == nullptr || ctx->generated_code_data.match(xmrig::Algorithm::CN_R, height))
+        return;
+
+    // only the asm and soft AES main loops run generated code, the rest interpret the program
+    if (SOFT_AES ? flavour != CN_R_SOFT_AES : BATCH_ASM_TYPE == xmrig::Assembly::NONE)
+        return;
+
+    std::lock_guard<std::mutex> lock(cn_r_mutex);
+
+    const cn_r_program* program = cn_r_get_program(height, flavour);
+    if (program == nullptr)
+        return;
+
+    memcpy(reinterpret_cast<void*>(ctx->generated_code), program->machine_code, cn_r_code_size);
+    xmrig::VirtualMemory::flushInstructionCache(reinterpret_cast<void*>(ctx->generated_code), cn_r_code_size);
+
+    ctx->generated_code_data = { xmrig::Algorithm::CN_R, height };
+#endif
+}
 
 void ghostrider(const uint8_t* data, size_t size, uint8_t * output, cryptonight_ctx** ctx, uint64_t) {
     xmrig::ghostrider::hash(data, size, output, ctx, nullptr);
@@ -123,17 +389,134 @@ static xmrig::cn_hash_fun get_argon2_fn(const int algo) {
     }
 }
 
+/*
+ * Reserves a huge-page MemoryPool large enough for `contexts` alloc_context_export scratchpads
+ * and `batch_contexts` alloc_batch_context_export(batch_ways) ones, preferring `numa_node`
+ * (-1 for no preference). Must be called before the first context is allocated; without it the
+ * pool is created empty and every context allocates its own huge pages, falling back to regular
+ * pages if none are available.
+ */
+extern "C" MODULE_API bool cryptonight_init_memory_pool_export(uint32_t contexts, uint32_t batch_contexts, uint32_t batch_ways,
+    bool huge_pages, int32_t numa_node)
+{
+    std::lock_guard<std::mutex> lock(context_mutex);
+
+    if (context_pool_ready)
+        return false;
+
+    context_huge_pages = huge_pages;
+    context_numa_node = numa_node;
+    init_context_pool(contexts * max_mem_size + batch_contexts * batch_lanes(batch_ways) * batch_lane_mem_size);
+
+    return true;
+}
+
 extern "C" MODULE_API void *alloc_context_export()
 {
+    std::lock_guard<std::mutex> lock(context_mutex);
+
+    xmrig::VirtualMemory* memory = alloc_scratchpad();
+    if (memory == nullptr)
+        return nullptr;
+
     cryptonight_ctx* ctx = nullptr;
-    xmrig::CnCtx::create(&ctx, static_cast<uint8_t*>(_mm_malloc(max_mem_size, 4096)), max_mem_size, 1);
+    xmrig::CnCtx::create(&ctx, memory->scratchpad(), max_mem_size, 1);
+    context_memory[ctx] = memory;
+
     return ctx;
 }
 
 extern "C" MODULE_API void free_context_export(cryptonight_ctx* ctx)
 {
-    if(ctx != nullptr)
-        xmrig::CnCtx::release(&ctx, 1);
+    if(ctx == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(context_mutex);
+    release_contexts(ctx, &ctx, 1);
+}
+
+// Context for cryptonight_batch_export with `ways` interleaved lanes (1-5, 0 picks from the L3 size)
+extern "C" MODULE_API void *alloc_batch_context_export(uint32_t ways)
+{
+    const size_t lanes = batch_lanes(ways);
+
+    std::lock_guard<std::mutex> lock(context_mutex);
+
+    xmrig::VirtualMemory* memory = alloc_scratchpad(lanes * batch_lane_mem_size);
+    if (memory == nullptr)
+        return nullptr;
+
+    auto* batch = new cryptonight_batch_ctx();
+    batch->ways = lanes;
+    xmrig::CnCtx::create(batch->lanes, memory->scratchpad(), batch_lane_mem_size, lanes);
+    context_memory[batch] = memory;
+
+    return batch;
+}
+
+extern "C" MODULE_API void free_batch_context_export(cryptonight_batch_ctx* batch)
+{
+    if(batch == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(context_mutex);
+    release_contexts(batch, batch->lanes, batch->ways);
+
+    delete batch;
+}
+
+// Huge pages backing live contexts vs. pages requested for them
+extern "C" MODULE_API void cryptonight_memory_stats_export(uint64_t* huge_pages_allocated, uint64_t* huge_pages_total)
+{
+    std::lock_guard<std::mutex> lock(context_mutex);
+
+    uint64_t allocated = 0;
+    uint64_t total = 0;
+
+    for (const auto& entry : context_memory) {
+        const uint64_t pages = entry.second->size() / huge_page_size;
+
+        total += pages;
+
+        if (entry.second->isHugePages())
+            allocated += pages;
+    }
+
+    if (huge_pages_allocated != nullptr)
+        *huge_pages_allocated = allocated;
+
+    if (huge_pages_total != nullptr)
+        *huge_pages_total = total;
+}
+
+// Live contexts backed by the pool and by their own pages (the pool was too small), and freed
+// pool scratchpads waiting for the next context
+extern "C" MODULE_API void cryptonight_memory_pool_stats_export(uint64_t* pooled, uint64_t* fallback, uint64_t* free)
+{
+    std::lock_guard<std::mutex> lock(context_mutex);
+
+    uint64_t in_pool = 0;
+    uint64_t outside = 0;
+    uint64_t waiting = 0;
+
+    for (const auto& entry : context_memory) {
+        if (entry.second->isPooled())
+            in_pool++;
+        else
+            outside++;
+    }
+
+    for (const auto& entry : free_pool_memory)
+        waiting += entry.second.size();
+
+    if (pooled != nullptr)
+        *pooled = in_pool;
+
+    if (fallback != nullptr)
+        *fallback = outside;
+
+    if (free != nullptr)
+        *free = waiting;
 }
 
 extern "C" MODULE_API bool cryptonight_export(const uint8_t * input, size_t input_length,
@@ -147,6 +530,9 @@ extern "C" MODULE_API bool cryptonight_export(const uint8_t * input, size_t inpu
 
     const xmrig::cn_hash_fun fn = get_cn_fn(algo);
 
+    if (algo == xmrig::Algorithm::CN_R)
+        cn_r_load_program(ctx, height, SOFT_AES ? CN_R_SOFT_AES : CN_R_SINGLE);
+
     fn(input, input_length, reinterpret_cast<uint8_t*>(output), &ctx, height);
 
     return true;
@@ -215,3 +601,254 @@ extern "C" MODULE_API bool argon_export(const uint8_t * input, size_t input_leng
 
     return true;
 }
+
+static_assert(xmrig::astrobwt::SCRATCHPAD_SIZE <= max_mem_size, "AstroBWT scratchpad doesn't fit a context");
+
+// AstroBWT (Dero) using the context's scratchpad. sort_threads > 1 spreads the two suffix sorts over that many threads
+extern "C" MODULE_API bool astrobwt_export(const uint8_t * input, size_t input_length,
+    char* output, uint32_t sort_threads, cryptonight_ctx* ctx)
+{
+    if (ctx == nullptr || input == nullptr)
+        return false;
+
+    return xmrig::astrobwt::astrobwt_dero(input, static_cast<uint32_t>(input_length), ctx->memory,
+        reinterpret_cast<uint8_t*>(output), std::numeric_limits<int>::max(), true, std::max(sort_threads, 1u));
+}
+
+// Name of the Argon2 fill_segment implementation in use (x86_64, SSE2, SSSE3, XOP, AVX2, AVX-512F)
+extern "C" MODULE_API const char* argon2_get_impl_export()
+{
+    return argon2_get_impl_name();
+}
+
+// Forces an Argon2 implementation by name, returns false if the CPU doesn't support it
+extern "C" MODULE_API bool argon2_set_impl_export(const char* name)
+{
+    if (name == nullptr)
+        return false;
+
+    return argon2_select_impl_by_name(name) != 0;
+}
+
+static xmrig::cn_hash_fun get_cn_batch_fn(const int algo, size_t ways)
+{
+    static const xmrig::CnHash::AlgoVariant variants[max_batch_ways + 1] = {
+        xmrig::CnHash::AV_AUTO,
+        SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE,
+        SOFT_AES ? xmrig::CnHash::AV_DOUBLE_SOFT : xmrig::CnHash::AV_DOUBLE,
+        SOFT_AES ? xmrig::CnHash::AV_TRIPLE_SOFT : xmrig::CnHash::AV_TRIPLE,
+        SOFT_AES ? xmrig::CnHash::AV_QUAD_SOFT   : xmrig::CnHash::AV_QUAD,
+        SOFT_AES ? xmrig::CnHash::AV_PENTA_SOFT  : xmrig::CnHash::AV_PENTA,
+    };
+
+    const xmrig::Algorithm algorithm(static_cast<xmrig::Algorithm::Id>(algo));
+
+    // multi-way variants only exist for the classic CryptoNight families
+    switch (algorithm.family()) {
+    case xmrig::Algorithm::CN:
+    case xmrig::Algorithm::CN_LITE:
+    case xmrig::Algorithm::CN_HEAVY:
+    case xmrig::Algorithm::CN_PICO:
+        break;
+
+    default:
+        return nullptr;
+    }
+
+    if (algorithm.id() == xmrig::Algorithm::CN_GPU || algorithm.l3() > batch_lane_mem_size)
+        return nullptr;
+
+    // beyond two ways CN-R falls back to interpreting the random math program, which is slower than the JIT
+    if (algorithm.id() == xmrig::Algorithm::CN_R && ways > 2)
+        return nullptr;
+
+    return xmrig::CnHash::fn(algorithm, variants[ways], BATCH_ASM_TYPE);
+}
+
+/*
+ * Hashes `count` inputs, writing 32 bytes per input to `outputs`. Inputs of equal length are
+ * grouped and run through the widest multi-way variant the context has lanes for (up to AV_PENTA),
+ * which interleaves the scratchpads of several hashes to hide memory latency.
+ */
+extern "C" MODULE_API bool cryptonight_batch_export(const int algo, const uint8_t* const* inputs, const uint32_t* input_lengths,
+    uint32_t count, uint8_t* outputs, const uint64_t height, cryptonight_batch_ctx* batch)
+{
+    if (batch == nullptr || inputs == nullptr || input_lengths == nullptr || outputs == nullptr)
+        return false;
+
+    if (get_cn_batch_fn(algo, 1) == nullptr)
+        return false;
+
+    alignas(16) uint8_t packed[max_batch_ways * max_batch_input_size];
+    alignas(16) uint8_t hashes[max_batch_ways * 32 + 32];
+    uint32_t group[max_batch_ways];
+    std::vector<bool> done(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (done[i])
+            continue;
+
+        const uint32_t size = input_lengths[i];
+        if (size == 0 || inputs[i] == nullptr)
+            return false;
+
+        // collect up to max_batch_ways pending inputs sharing this length
+        size_t ways = 0;
+
+        if (size <= max_batch_input_size) {
+            for (uint32_t j = i; j < count && ways < batch->ways; ++j) {
+                if (!done[j] && input_lengths[j] == size && inputs[j] != nullptr)
+                    group[ways++] = j;
+            }
+        } else {
+            group[ways++] = i;
+        }
+
+        xmrig::cn_hash_fun fn = get_cn_batch_fn(algo, ways);
+        while (fn == nullptr && ways > 1)
+            fn = get_cn_batch_fn(algo, --ways);
+
+        // CN_1 based variants zero the output for short inputs instead of hashing
+        memset(hashes, 0, sizeof(hashes));
+
+        if (ways == 1) {
+            // the last lane is never lane 0 of a multi-way call, so CN-R code generated
+            // for the single and double-way main loops doesn't get mixed up
+            if (algo == xmrig::Algorithm::CN_R)
+                cn_r_load_program(batch->lanes[batch->ways - 1], height, SOFT_AES ? CN_R_SOFT_AES : CN_R_SINGLE);
+
+            fn(inputs[i], size, hashes, &batch->lanes[batch->ways - 1], height);
+        } else {
+            for (size_t k = 0; k < ways; ++k)
+                memcpy(packed + k * size, inputs[group[k]], size);
+
+            if (algo == xmrig::Algorithm::CN_R)
+                cn_r_load_program(batch->lanes[0], height, CN_R_DOUBLE);
+
+            fn(packed, size, hashes, batch->lanes, height);
+        }
+
+        for (size_t k = 0; k < ways; ++k) {
+            memcpy(outputs + static_cast<size_t>(group[k]) * 32, hashes + k * 32, 32);
+            done[group[k]] = true;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * GhostRider counterpart of cryptonight_batch_export. Inputs sharing a length and seed (PrevBlockHash,
+ * bytes [4; 36)) are hashed as one group of up to four lanes, so the CryptoNight steps can use the
+ * multi-way variants. The plan resolved from the seed is kept in the context and reused as long as
+ * shares of the same job keep coming.
+ */
+extern "C" MODULE_API bool ghostrider_batch_export(const uint8_t* const* inputs, const uint32_t* input_lengths,
+    uint32_t count, uint8_t* outputs, cryptonight_batch_ctx* batch)
+{
+    constexpr size_t seed_end = 36;
+
+    if (batch == nullptr || inputs == nullptr || input_lengths == nullptr || outputs == nullptr)
+        return false;
+
+    const size_t max_ways = std::min(batch->ways, xmrig::ghostrider::MAX_BATCH_WAYS);
+
+    alignas(16) uint8_t packed[xmrig::ghostrider::MAX_BATCH_WAYS * max_batch_input_size];
+    alignas(16) uint8_t hashes[xmrig::ghostrider::MAX_BATCH_WAYS * 32];
+    uint32_t group[xmrig::ghostrider::MAX_BATCH_WAYS];
+    std::vector<bool> done(count);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (done[i])
+            continue;
+
+        const uint32_t size = input_lengths[i];
+        if (size < seed_end || inputs[i] == nullptr)
+            return false;
+
+        // collect pending inputs of the same length and job
+        size_t ways = 0;
+
+        if (size <= max_batch_input_size) {
+            for (uint32_t j = i; j < count && ways < max_ways; ++j) {
+                if (!done[j] && input_lengths[j] == size && inputs[j] != nullptr &&
+                    memcmp(inputs[j] + 4, inputs[i] + 4, seed_end - 4) == 0)
+                    group[ways++] = j;
+            }
+        } else {
+            group[ways++] = i;
+        }
+
+        xmrig::ghostrider::Plan& plan = batch->ghostrider_plan;
+        if (!xmrig::ghostrider::plan_matches(plan, inputs[i]))
+            xmrig::ghostrider::init_plan(plan, inputs[i]);
+
+        if (ways == 1) {
+            xmrig::ghostrider::hash_batch(plan, inputs[i], size, 1, hashes, batch->lanes);
+        } else {
+            for (size_t k = 0; k < ways; ++k)
+                memcpy(packed + k * size, inputs[group[k]], size);
+
+            xmrig::ghostrider::hash_batch(plan, packed, size, ways, hashes, batch->lanes);
+        }
+
+        for (size_t k = 0; k < ways; ++k) {
+            memcpy(outputs + static_cast<size_t>(group[k]) * 32, hashes + k * 32, 32);
+            done[group[k]] = true;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * KawPow (Ravencoin) share verification against the light cache of the block's epoch, shared by all
+ * threads. Returns a kawpow_verify_code and the final hash.
+ */
+extern "C" MODULE_API int32_t kawpow_verify_export(int32_t block_number, const uint8_t* header_hash, uint64_t nonce,
+    const uint8_t* mix_hash, const uint8_t* boundary, uint8_t* final_hash)
+{
+    if (block_number < 0 || header_hash == nullptr || mix_hash == nullptr || boundary == nullptr || final_hash == nullptr)
+        return -1;
+
+    return kawpow_verify(block_number, header_hash, nonce, mix_hash, boundary, final_hash);
+}
+
+/*
+ * Cuck(at)oo Cycle proof verification. `edges` holds `count` proofs back to back, each
+ * proof_size edge indices long, and `keys` the SipHash keys derived from each proof's header.
+ * One verify_code is written per proof; the verifiers keep no global state, so several pool
+ * threads may verify at once.
+ */
+template<size_t PROOF_SIZE>
+static bool c29_verify_batch(int (*verify)(const uint32_t*, const siphash_keys*), const uint32_t* edges,
+    const siphash_keys* keys, uint32_t count, int32_t* results)
+{
+    if (edges == nullptr || keys == nullptr || results == nullptr)
+        return false;
+
+    for (uint32_t i = 0; i < count; ++i)
+        results[i] = verify(edges + static_cast<size_t>(i) * PROOF_SIZE, &keys[i]);
+
+    return true;
+}
+
+extern "C" MODULE_API bool c29s_verify_batch_export(const uint32_t* edges, const siphash_keys* keys, uint32_t count, int32_t* results)
+{
+    return c29_verify_batch<PROOFSIZE>(c29s_verify, edges, keys, count, results);
+}
+
+extern "C" MODULE_API bool c29b_verify_batch_export(const uint32_t* edges, const siphash_keys* keys, uint32_t count, int32_t* results)
+{
+    return c29_verify_batch<PROOFSIZEb>(c29b_verify, edges, keys, count, results);
+}
+
+extern "C" MODULE_API bool c29i_verify_batch_export(const uint32_t* edges, const siphash_keys* keys, uint32_t count, int32_t* results)
+{
+    return c29_verify_batch<PROOFSIZEi>(c29i_verify, edges, keys, count, results);
+}
+
+extern "C" MODULE_API bool c29v_verify_batch_export(const uint32_t* edges, const siphash_keys* keys, uint32_t count, int32_t* results)
+{
+    return c29_verify_batch<PROOFSIZE>(c29v_verify, edges, keys, count, results);
+}
@@ -0,0 +1,28 @@
+// KawPow share verification on top of libkawpow's light (epoch cache) implementation
+
+#include <string.h>
+
+#include "kawpow.h"
+#include "../libkawpow/ethash/progpow.hpp"
+
+// Light caches come from the epoch cache in libethashcore (ethash_get_global_epoch_context): one
+// per epoch and process, built once and shared by every verifying thread.
+static const ethash::epoch_context& epoch_context_for(int block_number)
+{
+	return ethash::get_global_epoch_context(ethash::get_epoch_number(block_number));
+}
+
+int kawpow_verify(int block_number, const uint8_t header_hash[32], uint64_t nonce,
+	const uint8_t mix_hash[32], const uint8_t boundary[32], uint8_t final_hash[32])
+{
+	ethash::hash256 header, mix, target;
+	memcpy(header.bytes, header_hash, 32);
+	memcpy(mix.bytes, mix_hash, 32);
+	memcpy(target.bytes, boundary, 32);
+
+	int retcode = KAWPOW_OK;
+	const progpow::result result = progpow::hashext(epoch_context_for(block_number), block_number, header, nonce, mix, target, target, &retcode);
+
+	memcpy(final_hash, result.final_hash.bytes, 32);
+	return retcode;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+
+enum kawpow_verify_code { KAWPOW_OK, KAWPOW_ABOVE_BOUNDARY, KAWPOW_MIX_MISMATCH };
+
+// Verifies a KawPow share with libkawpow's hashext, writing the final hash to final_hash. The final
+// hash is computed from the claimed mix first, so only shares that meet the boundary pay for
+// recomputing the mix from the light cache.
+extern int kawpow_verify(int block_number, const uint8_t header_hash[32], uint64_t nonce,
+	const uint8_t mix_hash[32], const uint8_t boundary[32], uint8_t final_hash[32]);
@@ -0,0 +1,156 @@
+/*
+ * AstroBWT golden-vector test and sort benchmark.
+ *
+ * XMRig's own AstroBWT test vector and golden vectors produced by the original two-pass
+ * counting sort pin the MSD radix sort to bit-identical output for every thread count. That
+ * sort is built in from test_astrobwt_reference.cpp and must agree with the current one on
+ * further inputs.
+ *
+ *   ./test_astrobwt                  run the golden vectors
+ *   ./test_astrobwt --benchmark [n]  time the original sort, the serial sort and n sort
+ *                                    threads (default: all hardware threads)
+ */
+
+#include <cstdlib>
+#include <limits>
+#include <thread>
+
+#include "../native_test.h"
+#include "crypto/astrobwt/AstroBWT.h"
+#include "crypto/common/VirtualMemory.h"
+
+struct astrobwt_vector
+{
+    uint32_t step;
+    const char* expected;
+};
+
+/* astrobwt_dero_test_out of xmrig/crypto/cn/CryptoNight_test.h, for the first 76 bytes of its test_input */
+static const char* xmrig_input =
+    "0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601";
+static const char* xmrig_expected = "7e8844f2d6b7a43498fe6d226527689023da8a52f9fc4ec69e5aaaa63edce1c1";
+
+/* 76 byte inputs, input[i] = i * step + 1 */
+static const astrobwt_vector vectors[] = {
+    { 0, "01fb8a8e8fec281e5efacd9fe90c9da151d2d548ccf69cd7e3764ebdffb3e22d" },
+    { 1, "eb5573219d0b5c7ae8c5de9330396398aa04f07bdfe6b1ae1249a28634394529" },
+    { 2, "b78b59fa00b2f750beaf4e6e09213d1e907544c64f2688efc9538d995b6adc3c" },
+};
+
+bool astrobwt_dero_reference(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash);
+
+static void fill_input(uint8_t* input, uint32_t len, uint32_t step)
+{
+    for (uint32_t i = 0; i < len; i++)
+        input[i] = static_cast<uint8_t>(i * step + 1);
+}
+
+static bool hash(const uint8_t* input, uint32_t len, void* scratchpad, uint8_t* output, int threads)
+{
+    return xmrig::astrobwt::astrobwt_dero(input, len, scratchpad, output, std::numeric_limits<int>::max(), false, threads);
+}
+
+static bool run_vectors(void* scratchpad)
+{
+    const int thread_counts[] = { 1, 2, 3, 8 };
+    uint8_t input[76];
+    uint8_t output[32];
+    char name[64];
+    bool ok = true;
+
+    test_from_hex(xmrig_input, input, sizeof(input));
+
+    for (int threads : thread_counts) {
+        snprintf(name, sizeof(name), "xmrig vector threads %d", threads);
+
+        hash(input, sizeof(input), scratchpad, output, threads);
+        ok &= test_check_hex(name, output, sizeof(output), xmrig_expected);
+    }
+
+    for (const auto& vector : vectors) {
+        fill_input(input, sizeof(input), vector.step);
+
+        for (int threads : thread_counts) {
+            snprintf(name, sizeof(name), "step %u threads %d", vector.step, threads);
+
+            hash(input, sizeof(input), scratchpad, output, threads);
+            ok &= test_check_hex(name, output, sizeof(output), vector.expected);
+        }
+    }
+
+    // successive hashes reuse the sort threads of the first multi-threaded one
+    for (uint32_t n = 0; n < 4; n++) {
+        uint8_t expected[32];
+
+        test_fill(input, sizeof(input));
+        input[39] = static_cast<uint8_t>(n);
+
+        astrobwt_dero_reference(input, sizeof(input), scratchpad, expected);
+        hash(input, sizeof(input), scratchpad, output, 4);
+
+        snprintf(name, sizeof(name), "input %u matches the original sort", n);
+        ok &= test_check(name, memcmp(output, expected, 32) == 0);
+    }
+
+    return test_summary("AstroBWT", ok);
+}
+
+/* threads 0 times the original sort */
+static double run_benchmark(void* scratchpad, int threads)
+{
+    const int iterations = 50;
+    uint8_t input[76];
+    uint8_t output[32];
+
+    test_fill(input, sizeof(input));
+
+    const double start = test_now_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        input[39] = static_cast<uint8_t>(i);
+
+        if (threads == 0)
+            astrobwt_dero_reference(input, sizeof(input), scratchpad, output);
+        else
+            hash(input, sizeof(input), scratchpad, output, threads);
+    }
+
+    const double elapsed = (test_now_ns() - start) / 1e6;
+
+    if (threads == 0)
+        printf("astrobwt: original sort, %.2f ms/hash, %.1f hashes/sec\n", elapsed / iterations, iterations / (elapsed / 1e3));
+    else
+        printf("astrobwt: %d sort thread(s), %.2f ms/hash, %.1f hashes/sec\n", threads, elapsed / iterations, iterations / (elapsed / 1e3));
+
+    return elapsed;
+}
+
+int main(int argc, char** argv)
+{
+    xmrig::VirtualMemory memory(xmrig::astrobwt::SCRATCHPAD_SIZE, true, false, false);
+
+    if (memory.scratchpad() == nullptr) {
+        printf("failed to allocate the scratchpad\n");
+        return 1;
+    }
+
+    printf("scratchpad: %s pages\n", memory.isHugePages() ? "huge" : "regular");
+
+    if (!run_vectors(memory.scratchpad()))
+        return 1;
+
+    if (test_benchmark_requested(argc, argv)) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        const int threads = argc > 2 ? atoi(argv[2]) : static_cast<int>(hw > 0 ? hw : 1);
+
+        const double original = run_benchmark(memory.scratchpad(), 0);
+        const double serial = run_benchmark(memory.scratchpad(), 1);
+
+        printf("astrobwt: %.2fx speedup of the serial sort over the original one\n", original / serial);
+
+        if (threads > 1)
+            printf("astrobwt: %.2fx speedup with %d sort threads\n", serial / run_benchmark(memory.scratchpad(), threads), threads);
+    }
+
+    return 0;
+}
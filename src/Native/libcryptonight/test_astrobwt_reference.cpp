@@ -20,15 +20,21 @@
  *   along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "AstroBWT.h"
-#include "backend/cpu/Cpu.h"
+/*
+ * XMRig's AstroBWT as it was before the MSD radix sort (serial two-pass counting sorts, no
+ * AVX2), kept for test_astrobwt to check and time the current sort against.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
 #include "base/crypto/sha3.h"
 #include "base/tools/bswap_64.h"
-#include "crypto/cn/CryptoNight.h"
+#include "crypto/astrobwt/Salsa20.hpp"
 
 
-#include <limits>
-
+namespace {
 
 constexpr int STAGE1_SIZE = 147253;
 constexpr int ALLOCATION_SIZE = (STAGE1_SIZE + 1048576) + (128 - (STAGE1_SIZE & 63));
@@ -36,37 +42,7 @@ constexpr int ALLOCATION_SIZE = (STAGE1_SIZE + 1048576) + (128 - (STAGE1_SIZE &
 constexpr int COUNTING_SORT_BITS = 10;
 constexpr int COUNTING_SORT_SIZE = 1 << COUNTING_SORT_BITS;
 
-static bool astrobwtInitialized = false;
-
-#ifdef ASTROBWT_AVX2
-static bool hasAVX2 = false;
-
-extern "C"
-#ifndef _MSC_VER
-__attribute__((ms_abi))
-#endif
-void SHA3_256_AVX2_ASM(const void* in, size_t inBytes, void* out);
-#endif
-
-#ifdef XMRIG_ARM
-extern "C" {
-#include "salsa20_ref/ecrypt-sync.h"
-}
-
-static void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
-{
-	uint8_t iv[8] = {};
-	ECRYPT_ctx ctx;
-	ECRYPT_keysetup(&ctx, static_cast<const uint8_t*>(key), 256, 64);
-	ECRYPT_ivsetup(&ctx, iv);
-	ECRYPT_keystream_bytes(&ctx, static_cast<uint8_t*>(output), size);
-	memset(static_cast<uint8_t*>(output) - 16, 0, 16);
-	memset(static_cast<uint8_t*>(output) + size, 0, 16);
-}
-#else
-#include "Salsa20.hpp"
-
-static void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
+void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
 {
 	const uint64_t iv = 0;
 	ZeroTier::Salsa20 s(key, &iv);
@@ -75,18 +51,7 @@ static void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
 	memset(static_cast<uint8_t*>(output) + size, 0, 16);
 }
 
-extern "C" int salsa20_stream_avx2(void* c, uint64_t clen, const void* iv, const void* key);
-
-static void Salsa20_XORKeyStream_AVX256(const void* key, void* output, size_t size)
-{
-	const uint64_t iv = 0;
-	salsa20_stream_avx2(output, size, &iv, key);
-	memset(static_cast<uint8_t*>(output) - 16, 0, 16);
-	memset(static_cast<uint8_t*>(output) + size, 0, 16);
-}
-#endif
-
-static inline bool smaller(const uint8_t* v, uint64_t a, uint64_t b)
+inline bool smaller(const uint8_t* v, uint64_t a, uint64_t b)
 {
 	const uint64_t value_a = a >> 21;
 	const uint64_t value_b = b >> 21;
@@ -348,7 +313,10 @@ void sort_indices2(uint32_t N, const uint8_t* v, uint64_t* indices, uint64_t* tm
 	}
 }
 
-bool xmrig::astrobwt::astrobwt_dero(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash, int stage2_max_size, bool avx2)
+} // namespace
+
+
+bool astrobwt_dero_reference(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash)
 {
 	alignas(8) uint8_t key[32];
 	uint8_t* scratchpad_ptr = (uint8_t*)(scratchpad) + 64;
@@ -359,17 +327,8 @@ bool xmrig::astrobwt::astrobwt_dero(const void* input_data, uint32_t input_size,
 	uint8_t* stage1_result = (uint8_t*)(tmp_indices);
 	uint8_t* stage2_result = (uint8_t*)(tmp_indices);
 
-#ifdef ASTROBWT_AVX2
-	if (hasAVX2 && avx2) {
-		SHA3_256_AVX2_ASM(input_data, input_size, key);
-		Salsa20_XORKeyStream_AVX256(key, stage1_output, STAGE1_SIZE);
-	}
-	else
-#endif
-	{
-		sha3_HashBuffer(256, SHA3_FLAGS_NONE, input_data, input_size, key, sizeof(key));
-		Salsa20_XORKeyStream(key, stage1_output, STAGE1_SIZE);
-	}
+	sha3_HashBuffer(256, SHA3_FLAGS_NONE, input_data, input_size, key, sizeof(key));
+	Salsa20_XORKeyStream(key, stage1_output, STAGE1_SIZE);
 
 	sort_indices(STAGE1_SIZE + 1, stage1_output, indices, tmp_indices);
 
@@ -380,27 +339,10 @@ bool xmrig::astrobwt::astrobwt_dero(const void* input_data, uint32_t input_size,
 		}
 	}
 
-#ifdef ASTROBWT_AVX2
-	if (hasAVX2 && avx2)
-		SHA3_256_AVX2_ASM(stage1_result, STAGE1_SIZE + 1, key);
-	else
-#endif
-		sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage1_result, STAGE1_SIZE + 1, key, sizeof(key));
+	sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage1_result, STAGE1_SIZE + 1, key, sizeof(key));
 
 	const int stage2_size = STAGE1_SIZE + (*(uint32_t*)(key) & 0xfffff);
-	if (stage2_size > stage2_max_size) {
-		return false;
-	}
-
-#ifdef ASTROBWT_AVX2
-	if (hasAVX2 && avx2) {
-		Salsa20_XORKeyStream_AVX256(key, stage2_output, stage2_size);
-	}
-	else
-#endif
-	{
-		Salsa20_XORKeyStream(key, stage2_output, stage2_size);
-	}
+	Salsa20_XORKeyStream(key, stage2_output, stage2_size);
 
 	sort_indices2(stage2_size + 1, stage2_output, indices, tmp_indices);
 
@@ -422,31 +364,7 @@ bool xmrig::astrobwt::astrobwt_dero(const void* input_data, uint32_t input_size,
 		}
 	}
 
-#ifdef ASTROBWT_AVX2
-	if (hasAVX2 && avx2)
-		SHA3_256_AVX2_ASM(stage2_result, stage2_size + 1, output_hash);
-	else
-#endif
-		sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage2_result, stage2_size + 1, output_hash, 32);
+	sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage2_result, stage2_size + 1, output_hash, 32);
 
 	return true;
 }
-
-
-void xmrig::astrobwt::init()
-{
-	if (!astrobwtInitialized) {
-#		ifdef ASTROBWT_AVX2
-		hasAVX2 = Cpu::info()->hasAVX2();
-#		endif
-
-		astrobwtInitialized = true;
-	}
-}
-
-
-template<>
-void xmrig::astrobwt::single_hash<xmrig::Algorithm::ASTROBWT_DERO>(const uint8_t* input, size_t size, uint8_t* output, cryptonight_ctx** ctx, uint64_t)
-{
-	astrobwt_dero(input, static_cast<uint32_t>(size), ctx[0]->memory, output, std::numeric_limits<int>::max(), true);
-}
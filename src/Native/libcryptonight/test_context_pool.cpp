@@ -0,0 +1,133 @@
+/*
+ * Context memory pool test and benchmark.
+ *
+ * The pool is sized for one single and one 2-way batch context. Freed contexts must hand their
+ * pool scratchpads to the next context of the same size; only contexts beyond what the pool
+ * holds may fall back to their own pages.
+ *
+ *   ./test_context_pool              run the checks
+ *   ./test_context_pool --benchmark  time freeing and allocating a pooled context
+ */
+
+#include <dlfcn.h>
+
+#include "../native_test.h"
+
+typedef bool (*init_pool_fn)(uint32_t, uint32_t, uint32_t, bool, int32_t);
+typedef void* (*alloc_fn)();
+typedef void* (*alloc_batch_fn)(uint32_t);
+typedef void (*free_fn)(void*);
+typedef void (*pool_stats_fn)(uint64_t*, uint64_t*, uint64_t*);
+
+static init_pool_fn init_pool;
+static alloc_fn alloc_context;
+static free_fn free_context;
+static alloc_batch_fn alloc_batch_context;
+static free_fn free_batch_context;
+static pool_stats_fn pool_stats;
+
+struct pool_state
+{
+    uint64_t pooled, fallback, free;
+};
+
+static bool expect_state(const char* name, pool_state expected)
+{
+    pool_state s;
+    pool_stats(&s.pooled, &s.fallback, &s.free);
+
+    if (s.pooled != expected.pooled || s.fallback != expected.fallback || s.free != expected.free) {
+        return test_fail(name, "expected pooled %llu fallback %llu free %llu\n  got      pooled %llu fallback %llu free %llu",
+            (unsigned long long) expected.pooled, (unsigned long long) expected.fallback, (unsigned long long) expected.free,
+            (unsigned long long) s.pooled, (unsigned long long) s.fallback, (unsigned long long) s.free);
+    }
+
+    return test_pass(name);
+}
+
+template<typename T>
+static bool resolve(void* library, const char* name, T& fn)
+{
+    fn = reinterpret_cast<T>(dlsym(library, name));
+    return fn != nullptr;
+}
+
+static bool run_checks()
+{
+    bool ok = true;
+
+    init_pool(1, 1, 2, false, -1);
+
+    void* a = alloc_context();
+    void* batch = alloc_batch_context(2);
+    ok &= expect_state("single and batch context from the pool", { 2, 0, 0 });
+
+    void* b = alloc_context();
+    ok &= expect_state("context beyond the pool falls back", { 2, 1, 0 });
+
+    free_context(b);
+    free_context(a);
+    ok &= expect_state("freed pool scratchpad kept for reuse", { 1, 0, 1 });
+
+    a = alloc_context();
+    ok &= expect_state("next context reuses it", { 2, 0, 0 });
+
+    free_batch_context(batch);
+    batch = alloc_batch_context(2);
+    ok &= expect_state("batch context reuses its size", { 2, 0, 0 });
+
+    // a 4-way batch needs more than the 2-way scratchpad waiting in the pool
+    free_batch_context(batch);
+    batch = alloc_batch_context(4);
+    ok &= expect_state("larger batch does not take a smaller scratchpad", { 1, 1, 1 });
+
+    free_batch_context(batch);
+    free_context(a);
+
+    return test_summary("context pool", ok);
+}
+
+static void run_benchmark()
+{
+    const int iterations = 10000;
+    void* ctx = alloc_context();
+
+    const double start = test_now_ns();
+
+    for (int i = 0; i < iterations; i++) {
+        free_context(ctx);
+        ctx = alloc_context();
+    }
+
+    const double elapsed = test_now_ns() - start;
+    printf("context pool: free + alloc %8.2f us\n", elapsed / 1e3 / iterations);
+
+    free_context(ctx);
+}
+
+int main(int argc, char** argv)
+{
+    void* library = dlopen("./libcryptonight.so", RTLD_LAZY | RTLD_LOCAL);
+
+    if (library == nullptr) {
+        printf("FAIL %s\n", dlerror());
+        return 1;
+    }
+
+    if (!resolve(library, "cryptonight_init_memory_pool_export", init_pool) ||
+        !resolve(library, "alloc_context_export", alloc_context) ||
+        !resolve(library, "free_context_export", free_context) ||
+        !resolve(library, "alloc_batch_context_export", alloc_batch_context) ||
+        !resolve(library, "free_batch_context_export", free_batch_context) ||
+        !resolve(library, "cryptonight_memory_pool_stats_export", pool_stats)) {
+        printf("FAIL missing exports\n");
+        return 1;
+    }
+
+    const bool ok = run_checks();
+
+    if (ok && test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return ok ? 0 : 1;
+}
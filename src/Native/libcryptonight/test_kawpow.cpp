@@ -0,0 +1,95 @@
+/*
+ * KawPow share verification test and benchmark.
+ *
+ * The share was mined with libkawpow's progpow::hash (block 100, epoch 0) for a synthetic
+ * i * 7 + 1 header, as no KawPow test vectors ship with the tree, and is checked through
+ * kawpow_verify.
+ *
+ *   ./test_kawpow                  run the verification cases
+ *   ./test_kawpow --benchmark      time accepted and rejected shares
+ */
+
+#include "../native_test.h"
+#include "kawpow.h"
+
+static const int block_number = 100;
+static const uint64_t nonce = 0x1122334455667788ull;
+static const char* expected_final = "60b7b1368aa216f57e7324d1153d488ecf36b44b5a374bc2e126fd75d2903fe8";
+static const char* expected_mix = "782647e3b4fa936f3de952763e99fcdc9ad0cd8df4c9c15a6991560f39f829af";
+
+static bool check(const char* name, const uint8_t* mix, const uint8_t* boundary, int expected_code, const char* final_hex)
+{
+    uint8_t header[32];
+    uint8_t final_hash[32];
+    char hex[65];
+
+    test_fill(header, sizeof(header));
+
+    const int code = kawpow_verify(block_number, header, nonce, mix, boundary, final_hash);
+    test_to_hex(final_hash, sizeof(final_hash), hex);
+
+    if (code != expected_code || (final_hex != nullptr && strcmp(hex, final_hex) != 0)) {
+        return test_fail(name, "expected code %d final %s\n  got      code %d final %s",
+            expected_code, final_hex ? final_hex : "-", code, hex);
+    }
+
+    return test_pass(name);
+}
+
+static bool run_cases()
+{
+    uint8_t mix[32], bad_mix[32], boundary[32], tight[32];
+    bool ok = true;
+
+    test_from_hex(expected_mix, mix, sizeof(mix));
+    memcpy(bad_mix, mix, sizeof(mix));
+    bad_mix[5] ^= 0x10;
+
+    /* the share's own final hash is the tightest boundary it still meets */
+    test_from_hex(expected_final, boundary, sizeof(boundary));
+    memcpy(tight, boundary, sizeof(tight));
+    tight[31]--;
+
+    ok &= check("valid share", mix, boundary, KAWPOW_OK, expected_final);
+    ok &= check("above boundary", mix, tight, KAWPOW_ABOVE_BOUNDARY, expected_final);
+
+    /* a forged mix that still meets the boundary must be caught by the light-cache recompute */
+    memset(boundary, 0xff, sizeof(boundary));
+    ok &= check("mix mismatch", bad_mix, boundary, KAWPOW_MIX_MISMATCH, nullptr);
+
+    return test_summary("KawPow", ok);
+}
+
+static void run_benchmark(const char* name, const uint8_t* boundary)
+{
+    const int iterations = 2000;
+    uint8_t header[32], mix[32], final_hash[32];
+
+    test_fill(header, sizeof(header));
+    test_from_hex(expected_mix, mix, sizeof(mix));
+
+    const double start = test_now_ns();
+
+    for (int i = 0; i < iterations; i++)
+        kawpow_verify(block_number, header, nonce, mix, boundary, final_hash);
+
+    const double elapsed = test_now_ns() - start;
+    printf("kawpow: %-28s %8.2f us/share\n", name, elapsed / 1e3 / iterations);
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_cases())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv)) {
+        uint8_t accepted[32], rejected[32];
+        memset(accepted, 0xff, sizeof(accepted));
+        memset(rejected, 0, sizeof(rejected));
+
+        run_benchmark("accepted", accepted);
+        run_benchmark("rejected", rejected);
+    }
+
+    return 0;
+}
@@ -0,0 +1,503 @@
+/* XMRig
+ * Copyright (c) 2018      Lee Clagett              <https://github.com/vtnerd>
+ * Copyright (c) 2018-2019 tevador                  <tevador@gmail.com>
+ * Copyright (c) 2000      Transmeta Corporation    <https://github.com/intel/msr-tools>
+ * Copyright (c) 2004-2008 H. Peter Anvin           <https://github.com/intel/msr-tools>
+ * Copyright (c) 2018-2021 SChernykh                <https://github.com/SChernykh>
+ * Copyright (c) 2016-2021 XMRig                    <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AstroBWT.h"
+#include "backend/cpu/Cpu.h"
+#include "base/crypto/sha3.h"
+#include "base/tools/bswap_64.h"
+#include "crypto/cn/CryptoNight.h"
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef XMRIG_ARM
+#include <emmintrin.h>
+#endif
+
+
+constexpr int STAGE1_SIZE = 147253;
+constexpr int ALLOCATION_SIZE = (STAGE1_SIZE + 1048576) + (128 - (STAGE1_SIZE & 63));
+
+constexpr int COUNTING_SORT_BITS = 10;
+constexpr int COUNTING_SORT_SIZE = 1 << COUNTING_SORT_BITS;
+constexpr int BUCKET_SORT_BITS = 13;
+constexpr int MAX_SORT_THREADS = 64;
+constexpr uint32_t MIN_KEYS_PER_SORT_THREAD = 32768;
+
+static_assert(xmrig::astrobwt::SCRATCHPAD_SIZE == 64 + static_cast<size_t>(ALLOCATION_SIZE) * 17, "AstroBWT scratchpad layout");
+
+static bool astrobwtInitialized = false;
+
+#ifdef ASTROBWT_AVX2
+static bool hasAVX2 = false;
+
+extern "C"
+#ifndef _MSC_VER
+__attribute__((ms_abi))
+#endif
+void SHA3_256_AVX2_ASM(const void* in, size_t inBytes, void* out);
+#endif
+
+#ifdef XMRIG_ARM
+extern "C" {
+#include "crypto/astrobwt/salsa20_ref/ecrypt-sync.h"
+}
+
+static void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
+{
+	uint8_t iv[8] = {};
+	ECRYPT_ctx ctx;
+	ECRYPT_keysetup(&ctx, static_cast<const uint8_t*>(key), 256, 64);
+	ECRYPT_ivsetup(&ctx, iv);
+	ECRYPT_keystream_bytes(&ctx, static_cast<uint8_t*>(output), size);
+	memset(static_cast<uint8_t*>(output) - 16, 0, 16);
+	memset(static_cast<uint8_t*>(output) + size, 0, 16);
+}
+#else
+#include "crypto/astrobwt/Salsa20.hpp"
+
+static void Salsa20_XORKeyStream(const void* key, void* output, size_t size)
+{
+	const uint64_t iv = 0;
+	ZeroTier::Salsa20 s(key, &iv);
+	s.XORKeyStream(output, static_cast<uint32_t>(size));
+	memset(static_cast<uint8_t*>(output) - 16, 0, 16);
+	memset(static_cast<uint8_t*>(output) + size, 0, 16);
+}
+
+extern "C" int salsa20_stream_avx2(void* c, uint64_t clen, const void* iv, const void* key);
+
+static void Salsa20_XORKeyStream_AVX256(const void* key, void* output, size_t size)
+{
+	const uint64_t iv = 0;
+	salsa20_stream_avx2(output, size, &iv, key);
+	memset(static_cast<uint8_t*>(output) - 16, 0, 16);
+	memset(static_cast<uint8_t*>(output) + size, 0, 16);
+}
+#endif
+
+static inline bool smaller(const uint8_t* v, uint64_t a, uint64_t b)
+{
+	const uint64_t value_a = a >> 21;
+	const uint64_t value_b = b >> 21;
+
+	if (value_a < value_b) {
+		return true;
+	}
+
+	if (value_a > value_b) {
+		return false;
+	}
+
+	a &= (1 << 21) - 1;
+	b &= (1 << 21) - 1;
+
+	if (a == b) {
+		return false;
+	}
+
+	const uint64_t data_a = bswap_64(*reinterpret_cast<const uint64_t*>(v + a + 5));
+	const uint64_t data_b = bswap_64(*reinterpret_cast<const uint64_t*>(v + b + 5));
+	return (data_a < data_b);
+}
+
+static inline uint64_t load_key(const uint8_t* v, uint32_t i)
+{
+	return (bswap_64(*reinterpret_cast<const uint64_t*>(v + i)) & (static_cast<uint64_t>(-1) << 21)) | i;
+}
+
+// Helper threads of one hashing thread. They are started by its first multi-threaded sort and
+// kept for the next ones, so a hash wakes them instead of creating and joining threads.
+class SortWorkers
+{
+public:
+	~SortWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_start.notify_all();
+
+		for (auto& w : m_workers) {
+			w.join();
+		}
+	}
+
+	// runs fn(0) .. fn(threads - 1), fn(0) on the calling thread
+	void run(int threads, const std::function<void(int)>& fn)
+	{
+		while (static_cast<int>(m_workers.size()) < threads - 1) {
+			const int t = static_cast<int>(m_workers.size()) + 1;
+			m_workers.emplace_back([this, t]() { work(t); });
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_fn = &fn;
+			m_threads = threads;
+			m_pending = threads - 1;
+			++m_generation;
+		}
+		m_start.notify_all();
+
+		fn(0);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this]() { return m_pending == 0; });
+		m_fn = nullptr;
+	}
+
+private:
+	void work(int t)
+	{
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		for (;;) {
+			m_start.wait(lock, [&]() { return m_stop || m_generation != seen; });
+			if (m_stop) {
+				return;
+			}
+
+			seen = m_generation;
+			if (t >= m_threads) {
+				continue;
+			}
+
+			const std::function<void(int)>& fn = *m_fn;
+			lock.unlock();
+			fn(t);
+			lock.lock();
+
+			if (--m_pending == 0) {
+				m_done.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_start;
+	std::condition_variable m_done;
+	const std::function<void(int)>* m_fn = nullptr;
+	uint64_t m_generation = 0;
+	int m_threads = 0;
+	int m_pending = 0;
+	bool m_stop = false;
+};
+
+static void run_sort_threads(int threads, const std::function<void(int)>& fn)
+{
+	if (threads == 1) {
+		fn(0);
+		return;
+	}
+
+	static thread_local std::unique_ptr<SortWorkers> workers;
+	if (!workers) {
+		workers.reset(new SortWorkers());
+	}
+
+	workers->run(threads, fn);
+}
+
+// Second pass over one top-level bucket: every key in it shares the top COUNTING_SORT_BITS bits.
+// The digit is only as wide as the bucket needs, so its counters and the bucket itself stay in L1.
+static void sort_bucket(const uint8_t* v, uint64_t* indices, uint32_t n, uint64_t* tmp_indices)
+{
+	if (n < 2) {
+		return;
+	}
+
+	if (n > 16) {
+		uint32_t bits = 0;
+		while ((bits < BUCKET_SORT_BITS) && (n >> bits)) {
+			++bits;
+		}
+		const uint32_t shift = 64 - COUNTING_SORT_BITS - bits;
+		const uint32_t mask = (1u << bits) - 1;
+
+		uint32_t counters[1 << BUCKET_SORT_BITS];
+		memset(counters, 0, sizeof(uint32_t) << bits);
+
+		for (uint32_t j = 0; j < n; ++j) {
+			const uint64_t k = indices[j];
+			tmp_indices[j] = k;
+			++counters[(k >> shift) & mask];
+		}
+
+		uint32_t sum = 0;
+		for (uint32_t j = 0; j <= mask; ++j) {
+			const uint32_t c = counters[j];
+			counters[j] = sum;
+			sum += c;
+		}
+
+		for (uint32_t j = 0; j < n; ++j) {
+			const uint64_t k = tmp_indices[j];
+			indices[counters[(k >> shift) & mask]++] = k;
+		}
+	}
+
+	uint64_t prev_t = indices[0];
+	for (uint64_t* p = indices + 1, *e = indices + n; p != e; ++p)
+	{
+		uint64_t t = *p;
+		if (smaller(v, t, prev_t))
+		{
+			const uint64_t t2 = prev_t;
+			uint64_t* p1 = p;
+			do
+			{
+				*p1 = prev_t;
+				--p1;
+
+				if (p1 <= indices) {
+					break;
+				}
+
+				prev_t = *(p1 - 1);
+			} while (smaller(v, t, prev_t));
+			*p1 = t;
+			t = t2;
+		}
+		prev_t = t;
+	}
+}
+
+// Stable scatter of keys [begin, end) into their top-level buckets. Keys are staged in one
+// cache line per bucket and written out a full line at a time, with non-temporal stores where
+// the line belongs to this thread alone, instead of touching 1024 destinations at random.
+static void scatter_keys(const uint8_t* v, uint32_t begin, uint32_t end, uint64_t* indices, uint32_t* positions)
+{
+	constexpr uint32_t LINE = 64 / sizeof(uint64_t);
+
+	alignas(64) static thread_local uint64_t lines[COUNTING_SORT_SIZE][LINE];
+	static thread_local uint32_t first[COUNTING_SORT_SIZE];
+
+	memcpy(first, positions, sizeof(first));
+
+	for (uint32_t i = begin; i < end; ++i) {
+		const uint64_t k = load_key(v, i);
+		const uint32_t b = static_cast<uint32_t>(k >> (64 - COUNTING_SORT_BITS));
+		const uint32_t pos = positions[b]++;
+
+		lines[b][pos & (LINE - 1)] = k;
+
+		if ((pos & (LINE - 1)) == LINE - 1) {
+			const uint32_t line = pos & ~(LINE - 1);
+			if (line >= first[b]) {
+#				ifdef XMRIG_ARM
+				memcpy(indices + line, lines[b], sizeof(lines[b]));
+#				else
+				__m128i* dst = reinterpret_cast<__m128i*>(indices + line);
+				const __m128i* src = reinterpret_cast<const __m128i*>(lines[b]);
+				_mm_stream_si128(dst + 0, _mm_load_si128(src + 0));
+				_mm_stream_si128(dst + 1, _mm_load_si128(src + 1));
+				_mm_stream_si128(dst + 2, _mm_load_si128(src + 2));
+				_mm_stream_si128(dst + 3, _mm_load_si128(src + 3));
+#				endif
+			}
+			else {
+				// first line of the bucket, shared with the end of the previous one
+				for (uint32_t j = first[b]; j <= pos; ++j) {
+					indices[j] = lines[b][j & (LINE - 1)];
+				}
+			}
+		}
+	}
+
+	for (uint32_t b = 0; b < COUNTING_SORT_SIZE; ++b) {
+		const uint32_t pos = positions[b];
+		for (uint32_t j = std::max(pos & ~(LINE - 1), first[b]); j < pos; ++j) {
+			indices[j] = lines[b][j & (LINE - 1)];
+		}
+	}
+
+#	ifndef XMRIG_ARM
+	_mm_sfence();
+#	endif
+}
+
+// MSD radix sort on the top COUNTING_SORT_BITS bits, then each bucket on its own (see sort_bucket).
+// Ties keep ascending index order, so the result doesn't depend on the thread count.
+// indices must be 64-byte aligned.
+static void sort_indices(uint32_t N, const uint8_t* v, uint64_t* indices, uint64_t* tmp_indices, int threads)
+{
+	// a thread is only worth waking for a share of the keys that outweighs handing it out
+	threads = std::max(1, std::min({ threads, MAX_SORT_THREADS, static_cast<int>(N / MIN_KEYS_PER_SORT_THREAD) }));
+
+	std::vector<uint32_t> counters(static_cast<size_t>(threads) * COUNTING_SORT_SIZE);
+	uint32_t bucket_start[COUNTING_SORT_SIZE + 1];
+
+	auto chunk_begin = [N, threads](int t) {
+		return static_cast<uint32_t>(static_cast<uint64_t>(N) * t / threads);
+	};
+
+	run_sort_threads(threads, [&](int t) {
+		uint32_t* c = &counters[static_cast<size_t>(t) * COUNTING_SORT_SIZE];
+		for (uint32_t i = chunk_begin(t), e = chunk_begin(t + 1); i < e; ++i) {
+			++c[bswap_64(*reinterpret_cast<const uint64_t*>(v + i)) >> (64 - COUNTING_SORT_BITS)];
+		}
+	});
+
+	// thread t writes its part of bucket b right after threads 0..t-1
+	uint32_t sum = 0;
+	for (uint32_t b = 0; b < COUNTING_SORT_SIZE; ++b) {
+		bucket_start[b] = sum;
+		for (int t = 0; t < threads; ++t) {
+			uint32_t& c = counters[static_cast<size_t>(t) * COUNTING_SORT_SIZE + b];
+			const uint32_t count = c;
+			c = sum;
+			sum += count;
+		}
+	}
+	bucket_start[COUNTING_SORT_SIZE] = sum;
+
+	run_sort_threads(threads, [&](int t) {
+		scatter_keys(v, chunk_begin(t), chunk_begin(t + 1), indices, &counters[static_cast<size_t>(t) * COUNTING_SORT_SIZE]);
+	});
+
+	std::atomic<uint32_t> next_bucket(0);
+	run_sort_threads(threads, [&](int) {
+		constexpr uint32_t BUCKETS_PER_STEP = 16;
+
+		for (uint32_t b; (b = next_bucket.fetch_add(BUCKETS_PER_STEP)) < COUNTING_SORT_SIZE;) {
+			for (const uint32_t e = b + BUCKETS_PER_STEP; b < e; ++b) {
+				const uint32_t begin = bucket_start[b];
+				sort_bucket(v, indices + begin, bucket_start[b + 1] - begin, tmp_indices + begin);
+			}
+		}
+	});
+}
+
+bool xmrig::astrobwt::astrobwt_dero(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash, int stage2_max_size, bool avx2, int sort_threads)
+{
+	alignas(8) uint8_t key[32];
+	uint8_t* scratchpad_ptr = (uint8_t*)(scratchpad) + 64;
+	uint8_t* stage1_output = scratchpad_ptr;
+	uint8_t* stage2_output = scratchpad_ptr;
+	uint64_t* indices = (uint64_t*)(scratchpad_ptr + ALLOCATION_SIZE);
+	uint64_t* tmp_indices = (uint64_t*)(scratchpad_ptr + ALLOCATION_SIZE * 9);
+	uint8_t* stage1_result = (uint8_t*)(tmp_indices);
+	uint8_t* stage2_result = (uint8_t*)(tmp_indices);
+
+#ifdef ASTROBWT_AVX2
+	if (hasAVX2 && avx2) {
+		SHA3_256_AVX2_ASM(input_data, input_size, key);
+		Salsa20_XORKeyStream_AVX256(key, stage1_output, STAGE1_SIZE);
+	}
+	else
+#endif
+	{
+		sha3_HashBuffer(256, SHA3_FLAGS_NONE, input_data, input_size, key, sizeof(key));
+		Salsa20_XORKeyStream(key, stage1_output, STAGE1_SIZE);
+	}
+
+	sort_indices(STAGE1_SIZE + 1, stage1_output, indices, tmp_indices, sort_threads);
+
+	{
+		const uint8_t* tmp = stage1_output - 1;
+		for (int i = 0; i <= STAGE1_SIZE; ++i) {
+			stage1_result[i] = tmp[indices[i] & ((1 << 21) - 1)];
+		}
+	}
+
+#ifdef ASTROBWT_AVX2
+	if (hasAVX2 && avx2)
+		SHA3_256_AVX2_ASM(stage1_result, STAGE1_SIZE + 1, key);
+	else
+#endif
+		sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage1_result, STAGE1_SIZE + 1, key, sizeof(key));
+
+	const int stage2_size = STAGE1_SIZE + (*(uint32_t*)(key) & 0xfffff);
+	if (stage2_size > stage2_max_size) {
+		return false;
+	}
+
+#ifdef ASTROBWT_AVX2
+	if (hasAVX2 && avx2) {
+		Salsa20_XORKeyStream_AVX256(key, stage2_output, stage2_size);
+	}
+	else
+#endif
+	{
+		Salsa20_XORKeyStream(key, stage2_output, stage2_size);
+	}
+
+	sort_indices(stage2_size + 1, stage2_output, indices, tmp_indices, sort_threads);
+
+	{
+		const uint8_t* tmp = stage2_output - 1;
+		int i = 0;
+		const int n = ((stage2_size + 1) / 4) * 4;
+
+		for (; i < n; i += 4)
+		{
+			stage2_result[i + 0] = tmp[indices[i + 0] & ((1 << 21) - 1)];
+			stage2_result[i + 1] = tmp[indices[i + 1] & ((1 << 21) - 1)];
+			stage2_result[i + 2] = tmp[indices[i + 2] & ((1 << 21) - 1)];
+			stage2_result[i + 3] = tmp[indices[i + 3] & ((1 << 21) - 1)];
+		}
+
+		for (; i <= stage2_size; ++i) {
+			stage2_result[i] = tmp[indices[i] & ((1 << 21) - 1)];
+		}
+	}
+
+#ifdef ASTROBWT_AVX2
+	if (hasAVX2 && avx2)
+		SHA3_256_AVX2_ASM(stage2_result, stage2_size + 1, output_hash);
+	else
+#endif
+		sha3_HashBuffer(256, SHA3_FLAGS_NONE, stage2_result, stage2_size + 1, output_hash, 32);
+
+	return true;
+}
+
+
+void xmrig::astrobwt::init()
+{
+	if (!astrobwtInitialized) {
+#		ifdef ASTROBWT_AVX2
+		hasAVX2 = Cpu::info()->hasAVX2();
+#		endif
+
+		astrobwtInitialized = true;
+	}
+}
+
+
+template<>
+void xmrig::astrobwt::single_hash<xmrig::Algorithm::ASTROBWT_DERO>(const uint8_t* input, size_t size, uint8_t* output, cryptonight_ctx** ctx, uint64_t)
+{
+	astrobwt_dero(input, static_cast<uint32_t>(size), ctx[0]->memory, output, std::numeric_limits<int>::max(), true);
+}
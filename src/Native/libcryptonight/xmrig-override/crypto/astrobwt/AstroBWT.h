@@ -31,7 +31,11 @@ namespace xmrig {
 
 namespace astrobwt {
 
-bool astrobwt_dero(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash, int stage2_max_size, bool avx2);
+constexpr size_t SCRATCHPAD_SIZE = 0x13637c0;
+
+// scratchpad must be at least SCRATCHPAD_SIZE bytes, 64-byte aligned. sort_threads > 1 splits
+// the suffix sorts across that many threads, the result is identical for any thread count
+bool astrobwt_dero(const void* input_data, uint32_t input_size, void* scratchpad, uint8_t* output_hash, int stage2_max_size, bool avx2, int sort_threads = 1);
 void init();
 
 template<Algorithm::Id ALGO>
@@ -42,6 +42,7 @@
 #include "crypto/cn/CryptoNight.h"
 #include "crypto/common/VirtualMemory.h"
 
+#include <algorithm>
 #include <thread>
 #include <atomic>
 #include <chrono>
@@ -153,6 +154,89 @@ namespace ghostrider
 {
 
 
+// Lanes per CryptoNight variant that still fit a core's share of the cache
+#ifdef XMRIG_ARM
+static constexpr size_t cn_max_ways[6] = { 1, 1, 1, 1, 1, 1 };
+#else
+static constexpr size_t cn_max_ways[6] = { 4, 4, 1, 2, 4, 4 };
+#endif
+
+
+void init_plan(Plan& plan, const uint8_t* data, bool verbose)
+{
+    // PrevBlockHash (GhostRider's seed) is stored in bytes [4; 36)
+    const uint8_t* seed = data + 4;
+
+    uint32_t core_indices[15];
+    select_indices(core_indices, seed);
+
+    uint32_t cn_indices[6];
+    select_indices(cn_indices, seed);
+
+    if (verbose) {
+        static uint32_t prev_indices[3];
+        if (memcmp(cn_indices, prev_indices, sizeof(prev_indices)) != 0) {
+            memcpy(prev_indices, cn_indices, sizeof(prev_indices));
+            for (int i = 0; i < 3; ++i) {
+                LOG_INFO("%s GhostRider algo %d: %s", Tags::cpu(), i + 1, cn_names[cn_indices[i]]);
+            }
+        }
+    }
+
+    const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
+
+    memcpy(plan.seed, seed, sizeof(plan.seed));
+
+    for (size_t i = 0; i < 15; ++i) {
+        plan.core[i] = core_hash[core_indices[i]];
+    }
+
+    for (size_t part = 0; part < 3; ++part) {
+        plan.cn_indices[part] = cn_indices[part];
+        plan.cn_ways[part] = cn_max_ways[cn_indices[part]];
+
+        for (size_t ways = 1; ways <= MAX_BATCH_WAYS; ++ways) {
+            plan.cn[part][ways - 1] = CnHash::fn(cn_hash[cn_indices[part]], av[ways], Assembly::AUTO);
+        }
+    }
+
+    plan.ready = true;
+}
+
+
+bool plan_matches(const Plan& plan, const uint8_t* data)
+{
+    return plan.ready && (memcmp(plan.seed, data + 4, sizeof(plan.seed)) == 0);
+}
+
+
+void hash_batch(const Plan& plan, const uint8_t* data, size_t size, size_t count, uint8_t* output, cryptonight_ctx** ctx)
+{
+    uint8_t tmp[64 * MAX_BATCH_WAYS];
+
+    for (size_t part = 0; part < 3; ++part) {
+        for (size_t i = 0; i < 5; ++i) {
+            for (size_t j = 0; j < count; ++j) {
+                plan.core[part * 5 + i](data + j * size, size, tmp + j * 64);
+            }
+            data = tmp;
+            size = 64;
+        }
+
+        for (size_t j = 0; j < count;) {
+            const size_t ways = std::min(plan.cn_ways[part], count - j);
+            plan.cn[part][ways - 1](tmp + j * 64, 64, output + j * 32, ctx, 0);
+            j += ways;
+        }
+
+        for (size_t j = 0; j < count; ++j) {
+            memcpy(tmp + j * 64, output + j * 32, 32);
+            memset(tmp + j * 64 + 32, 0, 32);
+        }
+    }
+}
+
+
 #ifdef XMRIG_FEATURE_HWLOC
 
 
@@ -769,59 +853,13 @@ void destroy_helper_thread(HelperThread*) {}
 
 void hash(const uint8_t* data, size_t size, uint8_t* output, cryptonight_ctx** ctx, HelperThread*, bool verbose)
 {
-    constexpr uint32_t N = 1;
-
-    // PrevBlockHash (GhostRider's seed) is stored in bytes [4; 36)
-    const uint8_t* seed = data + 4;
+    static thread_local Plan plan = {};
 
-    uint32_t core_indices[15];
-    select_indices(core_indices, seed);
-
-    uint32_t cn_indices[6];
-    select_indices(cn_indices, seed);
-
-#ifdef XMRIG_ARM
-    uint32_t step[6] = { 1, 1, 1, 1, 1, 1 };
-#else
-    uint32_t step[6] = { 4, 4, 1, 2, 4, 4 };
-#endif
-
-    if (verbose) {
-        static uint32_t prev_indices[3];
-        if (memcmp(cn_indices, prev_indices, sizeof(prev_indices)) != 0) {
-            memcpy(prev_indices, cn_indices, sizeof(prev_indices));
-            for (int i = 0; i < 3; ++i) {
-                LOG_INFO("%s GhostRider algo %d: %s", Tags::cpu(), i + 1, cn_names[cn_indices[i]]);
-            }
-        }
+    if (!plan_matches(plan, data)) {
+        init_plan(plan, data, verbose);
     }
 
-    const CnHash::AlgoVariant* av = Cpu::info()->hasAES() ? av_hw_aes : av_soft_aes;
-
-    const cn_hash_fun f[3] = {
-        CnHash::fn(cn_hash[cn_indices[0]], CnHash::AV_SINGLE, Assembly::AUTO),
-        CnHash::fn(cn_hash[cn_indices[1]], CnHash::AV_SINGLE, Assembly::AUTO),
-        CnHash::fn(cn_hash[cn_indices[2]], CnHash::AV_SINGLE, Assembly::AUTO),
-    };
-
-    uint8_t tmp[64 * N];
-
-    for (uint64_t part = 0; part < 3; ++part) {
-        for (uint64_t i = 0; i < 5; ++i) {
-            for (uint64_t j = 0; j < N; ++j) {
-                core_hash[core_indices[part * 5 + i]](data + j * size, size, tmp + j * 64);
-                data = tmp;
-                size = 64;
-            }
-        }
-        for (uint64_t j = 0, k = step[cn_indices[part]]; j < N; j += k) {
-            f[part](tmp + j * 64, 64, output + j * 32, ctx, 0);
-        }
-        for (uint64_t j = 0; j < N; ++j) {
-            memcpy(tmp + j * 64, output + j * 32, 32);
-            memset(tmp + j * 64 + 32, 0, 32);
-        }
-    }
+    hash_batch(plan, data, size, 1, output, ctx);
 }
 
 
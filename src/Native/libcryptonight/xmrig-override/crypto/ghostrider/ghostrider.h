@@ -38,6 +38,32 @@ namespace ghostrider
 
 struct HelperThread;
 
+// Max. lanes hashed together by hash_batch()
+constexpr size_t MAX_BATCH_WAYS = 4;
+
+// Everything about a hash that depends only on the seed (PrevBlockHash, input bytes [4; 36)):
+// the core hash order and the CryptoNight variants, resolved for 1..MAX_BATCH_WAYS lanes.
+// All shares of a job use the same seed, so a plan is built once per job.
+struct Plan
+{
+    using core_hash_fun = void (*)(const uint8_t* data, size_t size, uint8_t* output);
+    using cn_hash_fun = void (*)(const uint8_t* input, size_t size, uint8_t* output, cryptonight_ctx** ctx, uint64_t height);
+
+    uint8_t seed[32];
+    uint32_t cn_indices[3];
+    core_hash_fun core[15];
+    cn_hash_fun cn[3][MAX_BATCH_WAYS];  // [part][lanes - 1]
+    size_t cn_ways[3];                  // lanes worth running together for each part
+    bool ready;
+};
+
+void init_plan(Plan& plan, const uint8_t* data, bool verbose = false);
+bool plan_matches(const Plan& plan, const uint8_t* data);
+
+// Hashes `count` (1..MAX_BATCH_WAYS) inputs of `size` bytes stored back to back, all sharing the plan's seed.
+// ctx must have `count` contexts with scratchpads of at least 2 MB.
+void hash_batch(const Plan& plan, const uint8_t* data, size_t size, size_t count, uint8_t* output, cryptonight_ctx** ctx);
+
 void benchmark();
 HelperThread* create_helper_thread(int64_t cpu_index, const std::vector<int64_t>& affinities);
 void destroy_helper_thread(HelperThread* t);
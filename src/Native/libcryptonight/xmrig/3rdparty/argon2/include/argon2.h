@@ -432,14 +432,13 @@ ARGON2_PUBLIC size_t argon2_encodedlen(uint32_t t_cost, uint32_t m_cost,
 #define ARGON2_SELECTABLE_IMPL
 
 /**
- * Selects the fastest available optimized implementation.
- * @param out The file for debug output (e. g. stderr; pass NULL for no
- * debug output)
- * @param prefix What to print before each line; NULL is equivalent to empty
- * string
+ * Selects the fastest available optimized implementation, or the one named by
+ * the ARGON2_IMPL environment variable. Runs once per process no matter how
+ * many threads call it; hashing calls it implicitly.
  */
 ARGON2_PUBLIC void argon2_select_impl();
 ARGON2_PUBLIC const char *argon2_get_impl_name();
+/* Forces an implementation; fails for names the CPU doesn't support */
 ARGON2_PUBLIC int argon2_select_impl_by_name(const char *name);
 
 /* signals support for passing preallocated memory: */
@@ -1,15 +1,20 @@
 #include <time.h>
 #include <string.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#endif
 
 #include "impl-select.h"
 #include "3rdparty/argon2.h"
 
 
-extern uint64_t uv_hrtime(void);
-
-
-#define BENCH_SAMPLES 1024U
+#define BENCH_SAMPLES 256U
 #define BENCH_MEM_BLOCKS 512
+#define IMPL_ENV_VAR "ARGON2_IMPL"
 
 
 #ifdef _MSC_VER
@@ -17,15 +22,73 @@ extern uint64_t uv_hrtime(void);
 #endif
 
 
-static argon2_impl selected_argon_impl = { "default", NULL, fill_segment_default };
+static const argon2_impl default_argon_impl = { "default", NULL, fill_segment_default };
+
+/* entries of the static list in argon2_get_impl_list(), swapped as a whole so readers never see a torn impl */
+static const argon2_impl *volatile selected_argon_impl = &default_argon_impl;
+
+#ifdef _WIN32
+static INIT_ONCE select_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_once_t select_once = PTHREAD_ONCE_INIT;
+#endif
+
+
+static uint64_t hrtime(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart * (1000000000.0 / freq.QuadPart));
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+
+static void set_impl(const argon2_impl *impl)
+{
+#ifdef __GNUC__
+    __atomic_store_n(&selected_argon_impl, impl, __ATOMIC_RELEASE);
+#else
+    selected_argon_impl = impl;
+#endif
+}
+
+
+static const argon2_impl *get_impl(void)
+{
+#ifdef __GNUC__
+    return __atomic_load_n(&selected_argon_impl, __ATOMIC_ACQUIRE);
+#else
+    return selected_argon_impl;
+#endif
+}
+
+
+static const argon2_impl *find_impl(const char *name)
+{
+    argon2_impl_list impls;
+    argon2_get_impl_list(&impls);
+
+    for (uint32_t i = 0; i < impls.count; i++) {
+        const argon2_impl *impl = &impls.entries[i];
+
+        /* implementations the CPU (or the build) lacks are stubs that don't fill anything */
+        if (strcasecmp(impl->name, name) == 0 && (impl->check == NULL || impl->check())) {
+            return impl;
+        }
+    }
 
+    return NULL;
+}
 
-/* the benchmark routine is not thread-safe, so we can use a global var here: */
-static block memory[BENCH_MEM_BLOCKS];
 
-#if 0
-static uint64_t benchmark_impl(const argon2_impl *impl) {
-    memset(memory, 0, sizeof(memory));
+static uint64_t benchmark_impl(const argon2_impl *impl, block *memory) {
+    memset(memory, 0, sizeof(block) * BENCH_MEM_BLOCKS);
 
     argon2_instance_t instance;
     instance.version        = ARGON2_VERSION_NUMBER;
@@ -48,21 +111,36 @@ static uint64_t benchmark_impl(const argon2_impl *impl) {
     impl->fill_segment(&instance, pos);
 
     /* OK, now measure: */
-    const uint64_t time = uv_hrtime();
+    const uint64_t time = hrtime();
 
     for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
         impl->fill_segment(&instance, pos);
     }
 
-    return uv_hrtime() - time;
+    return hrtime() - time;
 }
 
 
-void argon2_select_impl()
+static void select_impl(void)
 {
+    const char *forced = getenv(IMPL_ENV_VAR);
+    if (forced != NULL && forced[0] != '\0') {
+        const argon2_impl *impl = find_impl(forced);
+
+        if (impl != NULL) {
+            set_impl(impl);
+            return;
+        }
+    }
+
+    block *memory = (block *) malloc(sizeof(block) * BENCH_MEM_BLOCKS);
+    if (memory == NULL) {
+        return;
+    }
+
     argon2_impl_list impls;
     const argon2_impl *best_impl = NULL;
-    uint64_t best_bench = UINT_MAX;
+    uint64_t best_bench = UINT64_MAX;
 
     argon2_get_impl_list(&impls);
 
@@ -73,45 +151,67 @@ void argon2_select_impl()
             continue;
         }
 
-        const uint64_t bench = benchmark_impl(impl);
+        const uint64_t bench = benchmark_impl(impl, memory);
         if (bench < best_bench) {
             best_bench = bench;
             best_impl  = impl;
         }
     }
 
+    free(memory);
+
     if (best_impl != NULL) {
-        selected_argon_impl = *best_impl;
+        set_impl(best_impl);
     }
 }
+
+
+#ifdef _WIN32
+static BOOL CALLBACK select_impl_once(PINIT_ONCE once, PVOID param, PVOID *context)
+{
+    select_impl();
+    return TRUE;
+}
 #endif
 
-void xmrig_ar2_fill_segment(const argon2_instance_t *instance, argon2_position_t position)
+
+/* Picks the implementation once per process: ARGON2_IMPL if it names a supported one, else the fastest */
+void argon2_select_impl()
 {
-    selected_argon_impl.fill_segment(instance, position);
+#ifdef _WIN32
+    InitOnceExecuteOnce(&select_once, select_impl_once, NULL, NULL);
+#else
+    pthread_once(&select_once, select_impl);
+#endif
 }
 
 
-const char *argon2_get_impl_name()
+void xmrig_ar2_fill_segment(const argon2_instance_t *instance, argon2_position_t position)
 {
-    return selected_argon_impl.name;
+    argon2_select_impl();
+
+    get_impl()->fill_segment(instance, position);
 }
 
 
-int argon2_select_impl_by_name(const char *name)
+const char *argon2_get_impl_name()
 {
-    argon2_impl_list impls;
-    argon2_get_impl_list(&impls);
+    argon2_select_impl();
 
-    for (uint32_t i = 0; i < impls.count; i++) {
-        const argon2_impl *impl = &impls.entries[i];
+    return get_impl()->name;
+}
 
-        if (strcasecmp(impl->name, name) == 0) {
-            selected_argon_impl = *impl;
 
-            return 1;
-        }
+int argon2_select_impl_by_name(const char *name)
+{
+    const argon2_impl *impl = find_impl(name);
+    if (impl == NULL) {
+        return 0;
     }
 
-    return 0;
+    /* make sure a pending automatic selection can't overwrite the choice */
+    argon2_select_impl();
+    set_impl(impl);
+
+    return 1;
 }
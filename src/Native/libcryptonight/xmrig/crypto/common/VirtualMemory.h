@@ -47,6 +47,7 @@ public:
 
     inline bool isHugePages() const                                 { return m_flags.test(FLAG_HUGEPAGES); }
     inline bool isOneGbPages() const                                { return m_flags.test(FLAG_1GB_PAGES); }
+    inline bool isPooled() const                                    { return m_flags.test(FLAG_EXTERNAL); }
     inline size_t size() const                                      { return m_size; }
     inline size_t capacity() const                                  { return m_capacity; }
     inline uint8_t *raw() const                                     { return m_scratchpad; }
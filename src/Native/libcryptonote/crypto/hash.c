@@ -8,6 +8,7 @@
 
 #include "hash-ops.h"
 #include "keccak.h"
+#include "../../libmultihash/keccak/keccakf1600.h"
 
 void hash_permutation(union hash_state *state) {
   keccakf((uint64_t*)state, 24);
@@ -18,7 +19,5 @@ void hash_process(union hash_state *state, const uint8_t *buf, size_t count) {
 }
 
 void cn_fast_hash(const void *data, size_t length, char *hash) {
-  union hash_state state;
-  hash_process(&state, data, length);
-  memcpy(hash, &state, HASH_SIZE);
+  keccak_sponge((uint8_t*)hash, HASH_SIZE, data, length, HASH_DATA_AREA, KECCAK_PAD);
 }
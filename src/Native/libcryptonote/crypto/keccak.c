@@ -4,6 +4,7 @@
 
 #include "hash-ops.h"
 #include "keccak.h"
+#include "../../libmultihash/keccak/keccakf1600.h"
 
 const uint64_t keccakf_rndc[24] = 
 {
@@ -29,13 +30,19 @@ const int keccakf_piln[24] =
     15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1 
 };
 
-// update the state with given number of rounds
+// update the state with given number of rounds; the full 24 run on libmultihash's
+// lane-complementing Keccak-f[1600], which is compiled into this library
 
 void keccakf(uint64_t st[25], int rounds)
 {
     int i, j, round;
     uint64_t t, bc[5];
 
+    if (rounds == KECCAK_ROUNDS) {
+        keccakf1600(st);
+        return;
+    }
+
     for (round = 0; round < rounds; round++) {
 
         // Theta
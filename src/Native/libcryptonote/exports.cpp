@@ -1,6 +1,12 @@
 #include <cmath>
 #include <stdint.h>
 #include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 #include <algorithm>
 #include "cryptonote_core/cryptonote_basic.h"
 #include "cryptonote_core/cryptonote_format_utils.h"
@@ -46,43 +52,335 @@ extern "C" MODULE_API bool convert_blob_export(const char* input, unsigned int i
 	return true;
 }
 
-extern "C" MODULE_API uint64_t decode_address_export(const char* input, unsigned int inputSize)
+/*
+ * Hashing blob template: everything convert_blob_export derives from a block template that stays
+ * the same between shares, recorded once per template. The hashing blob is the serialized block
+ * header (ending in the 4-byte nonce), the transaction tree root and the transaction count; of
+ * those, a share changes only the nonce and, through the extra nonce in the reserved area of the
+ * miner tx extra, the miner tx hash. That hash covers the whole miner tx for v1 transactions and
+ * the prefix for v2, whose base and prunable rct hashes are kept.
+ *
+ * The miner tx is the first leaf of the transaction tree, so the template also keeps the branch
+ * of sibling nodes on the path from that leaf to the root (tree_branch): the root for a new miner
+ * tx hash takes tree_depth Keccak calls instead of rehashing every transaction.
+ */
+struct blob_template
 {
-	blobdata input_blob = std::string(input, inputSize);
-	blobdata data = "";
+	blobdata blob;
+	size_t header_size;
+	size_t nonce_offset;
+	size_t miner_tx_offset;
+	size_t miner_tx_hashed_size;		// bytes of the miner tx its (prefix) hash covers
+	size_t reserved_offset;
+	size_t reserved_size;
+	bool miner_tx_v1;
+	crypto::hash rct_hashes[2];			// v2: base and prunable
+	std::vector<crypto::hash> tree_branch;	// siblings of the miner tx leaf, root side first
+	blobdata tx_count;					// varint after the tree root
+};
 
-	uint64_t prefix;
-	bool decodeResult = tools::base58::decode_addr(input_blob, prefix, data);
+// per-thread buffer reused by convert_blob_template_export, so a share allocates nothing once warm
+static thread_local blobdata template_miner_tx;
+
+static bool blob_matches(const blobdata& blob, size_t offset, const blobdata& part)
+{
+	return offset + part.size() <= blob.size() && blob.compare(offset, part.size(), part) == 0;
+}
+
+static void template_miner_tx_hash(const blob_template* tmpl, const unsigned char* extraNonce, unsigned int extraNonceSize, crypto::hash& h)
+{
+	template_miner_tx.assign(tmpl->blob, tmpl->miner_tx_offset, tmpl->miner_tx_hashed_size);
+	memcpy(&template_miner_tx[tmpl->reserved_offset - tmpl->miner_tx_offset], extraNonce, extraNonceSize);
+
+	if (tmpl->miner_tx_v1)
+	{
+		crypto::cn_fast_hash(template_miner_tx.data(), template_miner_tx.size(), h);
+		return;
+	}
+
+	crypto::hash hashes[3];
+	crypto::cn_fast_hash(template_miner_tx.data(), template_miner_tx.size(), hashes[0]);
+	hashes[1] = tmpl->rct_hashes[0];
+	hashes[2] = tmpl->rct_hashes[1];
+	crypto::cn_fast_hash(hashes, sizeof(hashes), h);
+}
+
+// reservedSize bytes at reservedOffset of the block blob (in the miner tx) are what shares patch;
+// returns NULL if the blob doesn't parse or its layout isn't one the template can patch
+extern "C" MODULE_API void* convert_blob_template_create_export(const char* input, unsigned int inputSize, unsigned int reservedOffset, unsigned int reservedSize)
+{
+	blob_template* tmpl = new blob_template();
+	tmpl->blob = std::string(input, inputSize);
+
+	block block = AUTO_VAL_INIT(block);
+	if (!parse_and_validate_block_from_blob(tmpl->blob, block))
+	{
+		delete tmpl;
+		return nullptr;
+	}
+
+	// offsets of the parts as serialized again; the template is only usable if that reproduces the blob
+	const blobdata header = t_serializable_object_to_blob(static_cast<const block_header&>(block));
+	const blobdata miner_tx = t_serializable_object_to_blob(block.miner_tx);
+	const blobdata miner_tx_prefix = t_serializable_object_to_blob(static_cast<const transaction_prefix&>(block.miner_tx));
+
+	tmpl->header_size = header.size();
+	tmpl->nonce_offset = header.size() - sizeof(uint32_t);
+	tmpl->miner_tx_offset = header.size();
+	tmpl->miner_tx_v1 = block.miner_tx.version == 1;
+	tmpl->miner_tx_hashed_size = tmpl->miner_tx_v1 ? miner_tx.size() : miner_tx_prefix.size();
+	tmpl->reserved_offset = reservedOffset;
+	tmpl->reserved_size = reservedSize;
+
+	crypto::hash miner_tx_hash;
+	get_transaction_hash(block.miner_tx, miner_tx_hash);
+
+	if (!blob_matches(tmpl->blob, 0, header) || !blob_matches(tmpl->blob, tmpl->miner_tx_offset, miner_tx) ||
+		reservedOffset < tmpl->miner_tx_offset || reservedOffset + reservedSize > tmpl->miner_tx_offset + tmpl->miner_tx_hashed_size)
+	{
+		delete tmpl;
+		return nullptr;
+	}
+
+	if (!tmpl->miner_tx_v1)
+	{
+		// recover the rct hashes from the tx hash: hash of (prefix, base, prunable)
+		crypto::hash hashes[3];
+		crypto::cn_fast_hash(miner_tx_prefix.data(), miner_tx_prefix.size(), hashes[0]);
+
+		std::stringstream ss;
+		binary_archive<true> ba(ss);
+		const size_t outputs = block.miner_tx.vout.size();
+		if (!block.miner_tx.rct_signatures.serialize_rctsig_base(ba, block.miner_tx.vin.size(), outputs))
+		{
+			delete tmpl;
+			return nullptr;
+		}
+		crypto::cn_fast_hash(ss.str().data(), ss.str().size(), hashes[1]);
 
-	if (!decodeResult || data.length() == 0)
-		return 0L;	// error
+		// a coinbase tx has no prunable part
+		hashes[2] = null_hash;
+
+		tmpl->rct_hashes[0] = hashes[1];
+		tmpl->rct_hashes[1] = hashes[2];
+
+		if (crypto::cn_fast_hash(hashes, sizeof(hashes)) != miner_tx_hash)
+		{
+			delete tmpl;
+			return nullptr;
+		}
+	}
+
+	// the branch doesn't depend on the miner tx leaf itself
+	std::vector<crypto::hash> leaves(1, null_hash);
+	leaves.insert(leaves.end(), block.tx_hashes.begin(), block.tx_hashes.end());
+
+	tmpl->tree_branch.resize(crypto::tree_depth(leaves.size()));
+	if (!tmpl->tree_branch.empty())
+		crypto::tree_branch(leaves.data(), leaves.size(), tmpl->tree_branch.data());
+
+	tmpl->tx_count = tools::get_varint_data(block.tx_hashes.size() + 1);
+	return tmpl;
+}
+
+extern "C" MODULE_API void convert_blob_template_free_export(void* tmpl)
+{
+	delete static_cast<blob_template*>(tmpl);
+}
+
+// size of the hashing blobs convert_blob_template_export produces
+extern "C" MODULE_API unsigned int convert_blob_template_size_export(const void* tmpl)
+{
+	const blob_template* t = static_cast<const blob_template*>(tmpl);
+	return (unsigned int) (t->header_size + sizeof(crypto::hash) + t->tx_count.size());
+}
+
+/*
+ * Same as convert_blob_export for the template with extraNonceSize (<= reservedSize) bytes written
+ * at its reserved offset and, unless null, the 4-byte nonce written into the header.
+ */
+extern "C" MODULE_API bool convert_blob_template_export(const void* tmpl, const unsigned char* extraNonce, unsigned int extraNonceSize,
+	const unsigned char* nonce, unsigned char *output, unsigned int *outputSize)
+{
+	const blob_template* t = static_cast<const blob_template*>(tmpl);
+	unsigned int originalOutputSize = *outputSize;
+
+	*outputSize = convert_blob_template_size_export(t);
+
+	if (extraNonceSize > t->reserved_size)
+	{
+		*outputSize = 0;
+		return false;
+	}
+
+	// output buffer big enough?
+	if (*outputSize > originalOutputSize)
+		return false;
+
+	memcpy(output, t->blob.data(), t->header_size);
+	if (nonce)
+		memcpy(output + t->nonce_offset, nonce, sizeof(uint32_t));
+
+	crypto::hash miner_tx_hash, root;
+	template_miner_tx_hash(t, extraNonce, extraNonceSize, miner_tx_hash);
+
+	// the miner tx is the leftmost leaf: a null path
+	crypto::tree_hash_from_branch(t->tree_branch.data(), t->tree_branch.size(), miner_tx_hash, nullptr, root);
+
+	memcpy(output + t->header_size, &root, sizeof(crypto::hash));
+	memcpy(output + t->header_size + sizeof(crypto::hash), t->tx_count.data(), t->tx_count.size());
+	return true;
+}
+
+/*
+ * Address validation results, both prefixes of an address at once: one base58 decode and one
+ * check_key pair (ed25519 point decompression, the expensive part) per address. Addresses that
+ * decode but fail the key checks are cached too, as 0; strings that are not base58 addresses at
+ * all are not, so junk input cannot push real addresses out. Bounded, least recently used
+ * entries go first.
+ */
+struct address_prefixes
+{
+	uint64_t prefix;			// decode_address_export
+	uint64_t integrated_prefix;	// decode_integrated_address_export
+};
+
+static const size_t address_cache_capacity = 1 << 16;
+
+// the longest address decode_address_prefixes accepts: a 10-byte varint prefix, the spend and view
+// keys, an 8-byte payment id and a 4-byte checksum are 86 bytes, ten full base58 blocks of 11
+// characters and 9 for the last 6 bytes
+static const size_t address_max_length = 10 * 11 + 9;
+
+static std::mutex address_cache_lock;
+static std::list<std::pair<std::string, address_prefixes>> address_cache_lru;	// most recent first
+static std::unordered_map<std::string, std::list<std::pair<std::string, address_prefixes>>::iterator> address_cache;
+
+// decoded is set when address is base58 with a valid checksum, whether or not the keys check out
+static address_prefixes decode_address_prefixes(const std::string& address, bool& decoded)
+{
+	address_prefixes result = { 0, 0 };
+
+	blobdata data = "";
+	uint64_t prefix;
+	decoded = tools::base58::decode_addr(address, prefix, data) && data.length() != 0;
+	if (!decoded)
+		return result;	// error
 
 	account_public_address adr;
-	if (!::serialization::parse_binary(data, adr))
-		return 0L;
+	integrated_address iadr;
+	const bool is_address = ::serialization::parse_binary(data, adr);
+	const bool is_integrated = ::serialization::parse_binary(data, iadr);
+
+	if (!is_address && !is_integrated)
+		return result;
+
+	// both layouts start with the same spend and view keys
+	const account_public_address& keys = is_address ? adr : iadr.adr;
+	if (!crypto::check_key(keys.m_spend_public_key) || !crypto::check_key(keys.m_view_public_key))
+		return result;
 
-	if (!crypto::check_key(adr.m_spend_public_key) || !crypto::check_key(adr.m_view_public_key))
-		return 0L;
+	if (is_address)
+		result.prefix = prefix;
+	if (is_integrated)
+		result.integrated_prefix = prefix;
 
-	return prefix;
+	return result;
+}
+
+static address_prefixes lookup_address(const char* input, unsigned int inputSize)
+{
+	if (inputSize > address_max_length)
+		return { 0, 0 };
+
+	const std::string address(input, inputSize);
+
+	{
+		std::lock_guard<std::mutex> lock(address_cache_lock);
+
+		auto it = address_cache.find(address);
+		if (it != address_cache.end())
+		{
+			address_cache_lru.splice(address_cache_lru.begin(), address_cache_lru, it->second);
+			return it->second->second;
+		}
+	}
+
+	// decoded without the lock; two threads missing on the same address both decode it
+	bool decoded;
+	const address_prefixes result = decode_address_prefixes(address, decoded);
+
+	if (!decoded)
+		return result;
+
+	std::lock_guard<std::mutex> lock(address_cache_lock);
+
+	if (address_cache.find(address) == address_cache.end())
+	{
+		address_cache_lru.emplace_front(address, result);
+		address_cache[address] = address_cache_lru.begin();
+
+		if (address_cache.size() > address_cache_capacity)
+		{
+			address_cache.erase(address_cache_lru.back().first);
+			address_cache_lru.pop_back();
+		}
+	}
+
+	return result;
+}
+
+extern "C" MODULE_API uint64_t decode_address_export(const char* input, unsigned int inputSize)
+{
+	return lookup_address(input, inputSize).prefix;
 }
 
 extern "C" MODULE_API uint64_t decode_integrated_address_export(const char* input, unsigned int inputSize)
 {
-    blobdata input_blob = std::string(input, inputSize);
-    blobdata data = "";
+	return lookup_address(input, inputSize).integrated_prefix;
+}
+
+/*
+ * decode_address_export and decode_integrated_address_export for count addresses, e.g. every
+ * address of a payout; addresses the cache doesn't have are decoded on one thread per core.
+ */
+extern "C" MODULE_API void validate_addresses_batch_export(const char* const* inputs, const uint32_t* inputSizes, uint32_t count,
+	uint64_t* prefixes, uint64_t* integratedPrefixes)
+{
+	const uint32_t per_thread_min = 16;
+	const uint32_t threads = std::max(1u, std::min(std::thread::hardware_concurrency(), count / per_thread_min));
+
+	auto validate = [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const address_prefixes result = lookup_address(inputs[i], inputSizes[i]);
+			prefixes[i] = result.prefix;
+			integratedPrefixes[i] = result.integrated_prefix;
+		}
+	};
 
-    uint64_t prefix;
-    bool decodeResult = tools::base58::decode_addr(input_blob, prefix, data);
+	std::vector<std::thread> workers;
+	uint32_t started = 1;
 
-    if (!decodeResult || data.length() == 0)
-        return 0L;	// error
+	// a slice whose thread cannot be started is validated here instead
+	for (; started < threads; started++)
+	{
+		try
+		{
+			workers.emplace_back(validate, (uint64_t) count * started / threads, (uint64_t) count * (started + 1) / threads);
+		}
+		catch (const std::system_error&)
+		{
+			break;
+		}
+	}
 
-    integrated_address iadr;
-    if (!::serialization::parse_binary(data, iadr) || !crypto::check_key(iadr.adr.m_spend_public_key) || !crypto::check_key(iadr.adr.m_view_public_key))
-        return 0L;	// error
+	validate(0, count / threads);
+	validate((uint64_t) count * started / threads, count);
 
-    return prefix;
+	for (auto& worker : workers)
+		worker.join();
 }
 
 extern "C" MODULE_API void cn_fast_hash_export(const char* input, unsigned char *output, uint32_t inputSize)
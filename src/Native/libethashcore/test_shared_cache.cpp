@@ -0,0 +1,73 @@
+/*
+ * Process-wide epoch context cache test.
+ *
+ * libkawpow and libfiropow are loaded side by side with RTLD_LOCAL, as the pool loads them, and
+ * must get the one epoch context libethashcore built, counted once in its statistics.
+ *
+ *   ./test_shared_cache
+ */
+
+#include <dlfcn.h>
+
+#include "../native_test.h"
+#include "../libkawpow/ethash/epoch_cache.hpp"
+
+typedef const void* (*global_context_fn)(int);
+typedef void* (*create_context_fn)(int);
+typedef void (*destroy_context_fn)(void*);
+typedef void (*get_stats_fn)(epoch_cache_stats*);
+
+static void* load(const char* path)
+{
+    void* library = dlopen(path, RTLD_LAZY | RTLD_LOCAL);
+
+    if (library == nullptr)
+        printf("FAIL %s\n", dlerror());
+
+    return library;
+}
+
+int main()
+{
+    void* kawpow = load("../libkawpow/libkawpow.so");
+    void* firopow = load("../libfiropow/libfiropow.so");
+
+    if (kawpow == nullptr || firopow == nullptr)
+        return 1;
+
+    auto global_context = reinterpret_cast<global_context_fn>(dlsym(kawpow, "ethash_get_global_epoch_context"));
+    auto create_context = reinterpret_cast<create_context_fn>(dlsym(firopow, "firopow_create_epoch_context"));
+    auto destroy_context = reinterpret_cast<destroy_context_fn>(dlsym(firopow, "firopow_destroy_epoch_context"));
+    auto kawpow_stats = reinterpret_cast<get_stats_fn>(dlsym(kawpow, "epoch_cache_get_stats"));
+    auto firopow_stats = reinterpret_cast<get_stats_fn>(dlsym(firopow, "epoch_cache_get_stats"));
+
+    if (!global_context || !create_context || !destroy_context || !kawpow_stats || !firopow_stats) {
+        printf("FAIL missing exports\n");
+        return 1;
+    }
+
+    bool ok = true;
+
+    const void* a = global_context(0);
+    void* b = create_context(0);
+
+    if (a == nullptr || a != b)
+        ok = test_fail("one context per process", "expected libfiropow to get %p, got %p", a, b);
+    else
+        test_pass("one context per process");
+
+    destroy_context(b);
+
+    epoch_cache_stats k, f;
+    kawpow_stats(&k);
+    firopow_stats(&f);
+
+    if (k.entries != 1 || k.misses != 1 || f.entries != k.entries || f.misses != k.misses || f.hits != k.hits) {
+        ok = test_fail("one set of statistics", "expected 1 entry and 1 miss in both, got %u/%llu and %u/%llu",
+            k.entries, (unsigned long long) k.misses, f.entries, (unsigned long long) f.misses);
+    } else {
+        test_pass("one set of statistics");
+    }
+
+    return test_summary("shared cache", ok) ? 0 : 1;
+}
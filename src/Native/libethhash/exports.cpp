@@ -18,6 +18,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "sha3.h"
 #include "internal.h"
 #include "ethash.h"
+#include "../libkawpow/ethash/epoch_cache.hpp"
 
 extern "C" bool ethash_get_default_dirname(char* strbuf, size_t buffsize);
 
@@ -37,14 +38,29 @@ extern "C" MODULE_API uint64_t ethash_get_cachesize_export(uint64_t const block_
 	return ethash_get_cachesize(block_number);
 }
 
+static std::shared_ptr<void> build_light(int epoch_number, size_t& size)
+{
+	ethash_light_t light = ethash_light_new(static_cast<uint64_t>(epoch_number) * ETHASH_EPOCH_LENGTH);
+	if (!light)
+		return nullptr;
+
+	size = sizeof(*light) + light->cache_size;
+	return std::shared_ptr<void>(light, [](void* p) { ethash_light_delete(static_cast<ethash_light_t>(p)); });
+}
+
+// Light caches come from the epoch cache: every handle for an epoch is the same light,
+// released with ethash_light_delete_export once per ethash_light_new_export
 extern "C" MODULE_API ethash_light_t ethash_light_new_export(uint64_t block_number)
 {
-	return ethash_light_new(block_number);
+	const int epoch_number = static_cast<int>(block_number / ETHASH_EPOCH_LENGTH);
+
+	return static_cast<ethash_light_t>(epoch_cache::pin(
+		epoch_cache::acquire(epoch_cache::family::ethash, epoch_number, build_light)));
 }
 
 extern "C" MODULE_API void ethash_light_delete_export(ethash_light_t light)
 {
-	ethash_light_delete(light);
+	epoch_cache::unpin(light);
 }
 
 extern "C" MODULE_API void ethash_light_compute_export(
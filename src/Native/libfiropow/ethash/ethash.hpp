@@ -169,4 +169,12 @@ inline const epoch_context_full& get_global_epoch_context_full(int epoch_number)
 {
     return *ethash_get_global_epoch_context_full(epoch_number);
 }
+
+/// Get epoch context from the process-wide epoch cache (epoch_cache.hpp).
+///
+/// Every call for the same epoch returns the same context, kept alive by the returned pointer.
+/// Returns null if the context could not be allocated.
+std::shared_ptr<const epoch_context> get_shared_epoch_context(int epoch_number) noexcept;
+
+std::shared_ptr<const epoch_context_full> get_shared_epoch_context_full(int epoch_number) noexcept;
 }  // namespace ethash
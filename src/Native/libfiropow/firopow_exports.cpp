@@ -4,6 +4,7 @@
 
 #include "firopow.hpp"
 #include "ethash/ethash.hpp"
+#include "../libkawpow/ethash/epoch_cache.hpp"
 #include <cstring>
 
 extern "C"
@@ -11,35 +12,24 @@ extern "C"
 
 // Minimal C API exports for the basic functionality we've implemented
 
-/// Create FiroPow epoch context (uses ethash context for now)
+/// Get FiroPow epoch context (ethash context) from the epoch cache. Every call for an epoch
+/// returns the same context, kept alive until each call has been matched by a destroy.
 EXPORT firopow::epoch_context* firopow_create_epoch_context(int epoch_number) noexcept
 {
-    return ethash_create_epoch_context(epoch_number);
+    return static_cast<firopow::epoch_context*>(epoch_cache::pin(
+        std::const_pointer_cast<firopow::epoch_context>(ethash::get_shared_epoch_context(epoch_number))));
 }
 
-/// Destroy FiroPow epoch context
+/// Release FiroPow epoch context
 EXPORT void firopow_destroy_epoch_context(firopow::epoch_context* context) noexcept
 {
-    ethash_destroy_epoch_context(context);
+    epoch_cache::unpin(context);
 }
 
-/// FiroPow hash calculation - using our implemented hash function
-EXPORT void firopow_hash(const firopow::epoch_context* context, int block_number,
-    const firopow::hash256* header_hash, uint64_t nonce, firopow::hash256* final_hash, firopow::hash256* mix_hash) noexcept
-{
-    if (!context || !header_hash || !final_hash || !mix_hash)
-        return;
-
-    auto result = firopow::hash(*context, block_number, *header_hash, nonce);
-    *final_hash = result.final_hash;
-    *mix_hash = result.mix_hash;
-}
-
-/// Get epoch number from block number - using our implemented function
-EXPORT int firopow_get_epoch_number(int block_number) noexcept
-{
-    return firopow::get_epoch_number(block_number);
-}
+// firopow_hash, firopow_verify_export and firopow_get_epoch_number are left out until the library
+// has a FiroPow kernel pinned to Firo mainnet vectors: firopow/firopow.cpp is a verbatim copy of
+// libkawpow's progpow.cpp (KawPow padding and period) and ethash.h carries KawPow's epoch length,
+// so anything built on them would compute KawPow under the FiroPow name.
 
 /// Copy hash256 from byte array
 EXPORT void firopow_hash256_from_bytes(const uint8_t* bytes, firopow::hash256* hash) noexcept
@@ -0,0 +1,89 @@
+/*
+ * libfiropow export test and benchmark.
+ *
+ * The library must not export a hash or share verification built on libkawpow's ProgPoW kernel,
+ * and firopow_create_epoch_context must hand out the cached context of an epoch until every
+ * create has been matched by a destroy.
+ *
+ *   ./test_firopow                  run the checks
+ *   ./test_firopow --benchmark      time creating and destroying a cached epoch context
+ */
+
+#include <dlfcn.h>
+
+#include "../native_test.h"
+
+typedef void* (*create_context_fn)(int);
+typedef void (*destroy_context_fn)(void*);
+
+static create_context_fn create_context;
+static destroy_context_fn destroy_context;
+
+static bool check_not_exported(void* library, const char* name)
+{
+    char check[96];
+
+    snprintf(check, sizeof(check), "%s not exported", name);
+    return dlsym(library, name) == nullptr ? test_pass(check) : test_fail(check, "exported without a FiroPow kernel");
+}
+
+static bool check_context_cache()
+{
+    void* a = create_context(0);
+    void* b = create_context(0);
+    const bool ok = a != nullptr && a == b;
+
+    destroy_context(b);
+    destroy_context(a);
+
+    if (!ok)
+        return test_fail("epoch context cache", "expected one context for epoch 0, got %p and %p", a, b);
+
+    return test_pass("epoch context cache");
+}
+
+static void run_benchmark()
+{
+    const int iterations = 100000;
+    void* pinned = create_context(0);
+    const double start = test_now_ns();
+
+    for (int i = 0; i < iterations; i++)
+        destroy_context(create_context(0));
+
+    const double elapsed = test_now_ns() - start;
+    printf("firopow: cached epoch context create + destroy %8.1f ns\n", elapsed / iterations);
+
+    destroy_context(pinned);
+}
+
+int main(int argc, char** argv)
+{
+    void* library = dlopen("./libfiropow.so", RTLD_LAZY | RTLD_LOCAL);
+    bool ok = true;
+
+    if (library == nullptr) {
+        printf("FAIL %s\n", dlerror());
+        return 1;
+    }
+
+    create_context = reinterpret_cast<create_context_fn>(dlsym(library, "firopow_create_epoch_context"));
+    destroy_context = reinterpret_cast<destroy_context_fn>(dlsym(library, "firopow_destroy_epoch_context"));
+
+    if (create_context == nullptr || destroy_context == nullptr) {
+        printf("FAIL missing exports\n");
+        return 1;
+    }
+
+    ok &= check_not_exported(library, "firopow_hash");
+    ok &= check_not_exported(library, "firopow_verify_export");
+    ok &= check_not_exported(library, "firopow_verify_batch_export");
+    ok &= check_context_cache();
+
+    test_summary("FiroPow", ok);
+
+    if (ok && test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Epoch context cache, see epoch_cache.hpp
+
+#include "epoch_cache.hpp"
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace epoch_cache
+{
+namespace
+{
+struct entry
+{
+    family fam;
+    int epoch_number;
+    std::shared_ptr<void> context;
+    size_t size;
+    bool ready;  // built; context is null if the build failed
+};
+
+using key = std::pair<int, int>;
+using entry_list = std::list<std::shared_ptr<entry>>;
+
+struct state
+{
+    std::mutex mutex;
+    std::condition_variable built;
+    entry_list lru;  // most recently used first
+    std::map<key, entry_list::iterator> index;
+    uint64_t budget = default_budget;
+    uint64_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    std::mutex pins_mutex;
+    std::unordered_map<const void*, std::pair<std::shared_ptr<void>, size_t>> pins;
+};
+
+state& cache()
+{
+    // never destroyed: thread-local context pointers may still be released during exit
+    static state* s = new state();
+    return *s;
+}
+
+// Drops least recently used contexts until the cache fits its budget, skipping keep and the
+// contexts still being built. The dropped entries are returned so the caller can free them
+// after unlocking.
+std::vector<std::shared_ptr<entry>> evict(state& s, const entry* keep)
+{
+    std::vector<std::shared_ptr<entry>> dropped;
+
+    for (auto it = s.lru.end(); s.bytes > s.budget && it != s.lru.begin();)
+    {
+        --it;
+        const std::shared_ptr<entry>& e = *it;
+
+        if (e.get() == keep || !e->ready)
+            continue;
+
+        s.bytes -= e->size;
+        s.evictions++;
+        s.index.erase(key{static_cast<int>(e->fam), e->epoch_number});
+        dropped.push_back(e);
+        it = s.lru.erase(it);
+    }
+
+    return dropped;
+}
+}  // namespace
+
+std::shared_ptr<void> acquire(family f, int epoch_number, const builder& build)
+{
+    state& s = cache();
+    const key k{static_cast<int>(f), epoch_number};
+    std::unique_lock<std::mutex> lock{s.mutex};
+
+    const auto found = s.index.find(k);
+    if (found != s.index.end())
+    {
+        s.lru.splice(s.lru.begin(), s.lru, found->second);
+        s.hits++;
+
+        const std::shared_ptr<entry> e = *found->second;
+        s.built.wait(lock, [&] { return e->ready; });
+        return e->context;
+    }
+
+    s.misses++;
+
+    const std::shared_ptr<entry> e{new entry{f, epoch_number, nullptr, 0, false}};
+    s.lru.push_front(e);
+    s.index[k] = s.lru.begin();
+    lock.unlock();
+
+    size_t size = 0;
+    std::shared_ptr<void> context = build(epoch_number, size);
+    std::vector<std::shared_ptr<entry>> dropped;
+
+    lock.lock();
+    e->ready = true;
+
+    if (context)
+    {
+        e->context = context;
+        e->size = size;
+        s.bytes += size;
+        dropped = evict(s, e.get());
+    }
+    else
+    {
+        // not kept, so the next acquire tries again
+        s.lru.erase(s.index[k]);
+        s.index.erase(k);
+    }
+
+    lock.unlock();
+    s.built.notify_all();
+
+    return context;
+}
+
+void* pin(std::shared_ptr<void> context)
+{
+    if (!context)
+        return nullptr;
+
+    state& s = cache();
+    std::lock_guard<std::mutex> lock{s.pins_mutex};
+
+    auto& p = s.pins[context.get()];
+    if (p.second++ == 0)
+        p.first = std::move(context);
+
+    return p.first.get();
+}
+
+bool unpin(const void* context)
+{
+    state& s = cache();
+    std::shared_ptr<void> released;
+    std::lock_guard<std::mutex> lock{s.pins_mutex};
+
+    const auto it = s.pins.find(context);
+    if (it == s.pins.end())
+        return false;
+
+    if (--it->second.second == 0)
+    {
+        released = std::move(it->second.first);
+        s.pins.erase(it);
+    }
+
+    return true;
+}
+}  // namespace epoch_cache
+
+using namespace epoch_cache;
+
+void epoch_cache_set_budget(uint64_t bytes)
+{
+    state& s = cache();
+    std::vector<std::shared_ptr<entry>> dropped;
+    std::lock_guard<std::mutex> lock{s.mutex};
+
+    s.budget = bytes;
+    dropped = evict(s, nullptr);
+}
+
+void epoch_cache_get_stats(epoch_cache_stats* stats)
+{
+    if (!stats)
+        return;
+
+    state& s = cache();
+    std::lock_guard<std::mutex> lock{s.mutex};
+
+    stats->budget = s.budget;
+    stats->bytes = s.bytes;
+    stats->entries = static_cast<uint32_t>(s.lru.size());
+    stats->hits = s.hits;
+    stats->misses = s.misses;
+    stats->evictions = s.evictions;
+}
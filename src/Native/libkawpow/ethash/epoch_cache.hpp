@@ -0,0 +1,73 @@
+// Epoch context cache used by the Ethash-family libraries: libethhash's light caches and the
+// ethash::epoch_context of libkawpow, libfiropow and libcryptonight's KawPow verification.
+//
+// Contexts are keyed by (family, epoch) and handed out as shared pointers, so an evicted context
+// stays alive until its last user lets go of it. Contexts of any number of epochs are kept until
+// together they exceed the memory budget; then the least recently used ones are dropped, never
+// the one just built. Each context is built once: threads asking for it during the build wait
+// for that build instead of starting their own.
+//
+// The cache is per process: epoch_cache.cpp is built, with the ethash light code the contexts are
+// made of, into libethashcore, which the Ethash-family libraries link against. Loading several of
+// them side by side therefore builds an epoch once and keeps it under one budget. The Windows
+// projects still compile their own copy into each DLL, so there the cache is per library.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#if defined(_MSC_VER)
+#define EPOCH_CACHE_API __declspec(dllexport)
+#else
+#define EPOCH_CACHE_API __attribute__((visibility("default")))
+#endif
+
+namespace epoch_cache
+{
+enum class family : int
+{
+    ethash = 0,        // libethhash's ethash_light
+    progpow = 1,       // ethash::epoch_context: light cache and ProgPoW L1 cache (KawPow, FiroPow)
+    progpow_full = 2,  // ethash::epoch_context_full
+};
+
+// about a dozen light contexts at current epochs
+constexpr uint64_t default_budget = uint64_t(1) << 30;
+
+// builds the context of an epoch and sets size to the bytes it holds; null on failure
+using builder = std::function<std::shared_ptr<void>(int epoch_number, size_t& size)>;
+
+// the context of (f, epoch_number), built with build on a miss; null if the build failed
+std::shared_ptr<void> acquire(family f, int epoch_number, const builder& build);
+
+template <typename T>
+std::shared_ptr<T> acquire(family f, int epoch_number, const builder& build)
+{
+    return std::static_pointer_cast<T>(acquire(f, epoch_number, build));
+}
+
+// For C APIs handing out raw pointers: pin keeps a context alive until unpin has been called
+// once per pin. unpin returns false for a pointer that is not pinned.
+void* pin(std::shared_ptr<void> context);
+bool unpin(const void* context);
+}  // namespace epoch_cache
+
+extern "C" {
+
+struct epoch_cache_stats
+{
+    uint64_t budget;
+    uint64_t bytes;      // held by the cache, including contexts also held by users
+    uint32_t entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+// budget and statistics of the process-wide cache
+EPOCH_CACHE_API void epoch_cache_set_budget(uint64_t bytes);
+EPOCH_CACHE_API void epoch_cache_get_stats(struct epoch_cache_stats* stats);
+}
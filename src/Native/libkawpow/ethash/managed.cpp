@@ -3,9 +3,10 @@
 // Licensed under the Apache License, Version 2.0.
 
 #include "ethash-internal.hpp"
+#include "epoch_cache.hpp"
+#include "progpow.hpp"
 
 #include <memory>
-#include <mutex>
 
 #if !defined(__has_cpp_attribute)
 #define __has_cpp_attribute(x) 0
@@ -23,39 +24,45 @@ using namespace ethash;
 
 namespace
 {
-std::mutex shared_context_mutex;
-std::shared_ptr<epoch_context> shared_context;
-thread_local std::shared_ptr<epoch_context> thread_local_context;
+thread_local std::shared_ptr<const epoch_context> thread_local_context;
+thread_local std::shared_ptr<const epoch_context_full> thread_local_context_full;
 
-std::mutex shared_context_full_mutex;
-std::shared_ptr<epoch_context_full> shared_context_full;
-thread_local std::shared_ptr<epoch_context_full> thread_local_context_full;
+std::shared_ptr<void> build_context(int epoch_number, size_t& size) noexcept
+{
+    epoch_context* const context = ethash_create_epoch_context(epoch_number);
+    if (!context)
+        return nullptr;
+
+    size = get_light_cache_size(context->light_cache_num_items) + progpow::l1_cache_size;
+    return std::shared_ptr<void>{context,
+        [](void* p) { ethash_destroy_epoch_context(static_cast<epoch_context*>(p)); }};
+}
+
+std::shared_ptr<void> build_context_full(int epoch_number, size_t& size) noexcept
+{
+    epoch_context_full* const context = ethash_create_epoch_context_full(epoch_number);
+    if (!context)
+        return nullptr;
+
+    // the dataset is allocated up front and only filled on use
+    size = get_light_cache_size(context->light_cache_num_items) +
+           static_cast<size_t>(get_full_dataset_size(context->full_dataset_num_items));
+    return std::shared_ptr<void>{context,
+        [](void* p) { ethash_destroy_epoch_context_full(static_cast<epoch_context_full*>(p)); }};
+}
 
 /// Update thread local epoch context.
 ///
 /// This function is on the slow path. It's separated to allow inlining the fast
-/// path.
-///
-/// @todo: Redesign to guarantee deallocation before new allocation.
+/// path. Contexts of other epochs stay in the epoch cache, so threads alternating
+/// between epochs (pools with coins in different epochs) do not rebuild them.
 ATTRIBUTE_NOINLINE
 void update_local_context(int epoch_number)
 {
     // Release the shared pointer of the obsoleted context.
     thread_local_context.reset();
 
-    // Local context invalid, check the shared context.
-    std::lock_guard<std::mutex> lock{shared_context_mutex};
-
-    if (!shared_context || shared_context->epoch_number != epoch_number)
-    {
-        // Release the shared pointer of the obsoleted context.
-        shared_context.reset();
-
-        // Build new context.
-        shared_context = create_epoch_context(epoch_number);
-    }
-
-    thread_local_context = shared_context;
+    thread_local_context = get_shared_epoch_context(epoch_number);
 }
 
 ATTRIBUTE_NOINLINE
@@ -64,21 +71,22 @@ void update_local_context_full(int epoch_number)
     // Release the shared pointer of the obsoleted context.
     thread_local_context_full.reset();
 
-    // Local context invalid, check the shared context.
-    std::lock_guard<std::mutex> lock{shared_context_full_mutex};
-
-    if (!shared_context_full || shared_context_full->epoch_number != epoch_number)
-    {
-        // Release the shared pointer of the obsoleted context.
-        shared_context_full.reset();
+    thread_local_context_full = get_shared_epoch_context_full(epoch_number);
+}
+}  // namespace
 
-        // Build new context.
-        shared_context_full = create_epoch_context_full(epoch_number);
-    }
+std::shared_ptr<const epoch_context> ethash::get_shared_epoch_context(int epoch_number) noexcept
+{
+    return epoch_cache::acquire<const epoch_context>(
+        epoch_cache::family::progpow, epoch_number, build_context);
+}
 
-    thread_local_context_full = shared_context_full;
+std::shared_ptr<const epoch_context_full> ethash::get_shared_epoch_context_full(
+    int epoch_number) noexcept
+{
+    return epoch_cache::acquire<const epoch_context_full>(
+        epoch_cache::family::progpow_full, epoch_number, build_context_full);
 }
-}  // namespace
 
 const ethash_epoch_context* ethash_get_global_epoch_context(int epoch_number) noexcept
 {
@@ -0,0 +1,205 @@
+/*
+ * Epoch context cache test and benchmark.
+ *
+ * Hits, single builds under concurrency, LRU eviction against the budget, contexts outliving
+ * their eviction and pinning are checked with small stand-in contexts; then the ProgPoW epoch
+ * contexts of epochs 0 and 1 are taken through ethash_get_global_epoch_context.
+ *
+ *   ./test_epoch_cache              run the checks
+ *   ./test_epoch_cache --benchmark  time a thread switching between two epochs against a rebuild
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../native_test.h"
+#include "ethash/epoch_cache.hpp"
+#include "ethash/ethash.hpp"
+
+using epoch_cache::family;
+
+static std::atomic<int> builds{0};
+static std::atomic<int> frees{0};
+
+static const size_t stand_in_size = 100;
+
+static std::shared_ptr<void> build_stand_in(int epoch_number, size_t& size)
+{
+    builds++;
+    size = stand_in_size;
+    return std::shared_ptr<void>{new int(epoch_number), [](void* p) {
+        frees++;
+        delete static_cast<int*>(p);
+    }};
+}
+
+static std::shared_ptr<void> build_slowly(int epoch_number, size_t& size)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return build_stand_in(epoch_number, size);
+}
+
+static std::shared_ptr<void> build_failing(int, size_t&)
+{
+    builds++;
+    return nullptr;
+}
+
+static bool check_hits()
+{
+    builds = 0;
+
+    auto a = epoch_cache::acquire(family::ethash, 100, build_stand_in);
+    auto b = epoch_cache::acquire(family::ethash, 100, build_stand_in);
+    auto c = epoch_cache::acquire(family::progpow_full, 100, build_stand_in);
+
+    return test_check("one build per (family, epoch)", a && a == b && c != a && builds == 2);
+}
+
+static bool check_concurrent()
+{
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<void>> contexts(8);
+
+    builds = 0;
+
+    for (size_t i = 0; i < contexts.size(); i++)
+        threads.emplace_back([&, i] { contexts[i] = epoch_cache::acquire(family::ethash, 200, build_slowly); });
+
+    for (auto& t : threads)
+        t.join();
+
+    bool same = contexts[0] != nullptr;
+    for (auto& context : contexts)
+        same &= context == contexts[0];
+
+    return test_check("concurrent misses wait for one build", same && builds == 1);
+}
+
+static bool check_eviction()
+{
+    bool ok = true;
+
+    epoch_cache_set_budget(0);
+    epoch_cache_set_budget(3 * stand_in_size);
+    builds = 0;
+    frees = 0;
+
+    epoch_cache::acquire(family::ethash, 300, build_stand_in);
+    epoch_cache::acquire(family::ethash, 301, build_stand_in);
+    auto held = epoch_cache::acquire(family::ethash, 302, build_stand_in);
+    epoch_cache::acquire(family::ethash, 300, build_stand_in);
+
+    // 301 is the least recently used
+    epoch_cache::acquire(family::ethash, 303, build_stand_in);
+    ok &= test_check("least recently used context evicted over budget", builds == 4 && frees == 1);
+
+    epoch_cache::acquire(family::ethash, 300, build_stand_in);
+    ok &= test_check("recently used context kept", builds == 4);
+
+    // evicted while in use: freed when the last user lets go
+    epoch_cache_set_budget(0);
+    ok &= test_check("evicted context alive while held", frees == 3 && *static_cast<int*>(held.get()) == 302);
+    held.reset();
+    ok &= test_check("evicted context freed by its last user", frees == 4);
+
+    epoch_cache_set_budget(stand_in_size);
+    epoch_cache::acquire(family::ethash, 304, build_stand_in);
+    epoch_cache::acquire(family::ethash, 305, build_stand_in);
+
+    epoch_cache_stats stats;
+    epoch_cache_get_stats(&stats);
+    ok &= test_check("budget of one context keeps the newest", stats.entries == 1 && stats.bytes == stand_in_size);
+
+    epoch_cache_set_budget(epoch_cache::default_budget);
+    return ok;
+}
+
+static bool check_failed_build()
+{
+    builds = 0;
+
+    auto a = epoch_cache::acquire(family::ethash, 400, build_failing);
+    auto b = epoch_cache::acquire(family::ethash, 400, build_stand_in);
+
+    return test_check("failed build not cached", !a && b && builds == 2);
+}
+
+static bool check_pins()
+{
+    bool ok = true;
+
+    // start from an empty cache
+    epoch_cache_set_budget(0);
+    epoch_cache_set_budget(epoch_cache::default_budget);
+    frees = 0;
+
+    void* p = epoch_cache::pin(epoch_cache::acquire(family::ethash, 500, build_stand_in));
+    void* q = epoch_cache::pin(epoch_cache::acquire(family::ethash, 500, build_stand_in));
+    epoch_cache_set_budget(0);
+    epoch_cache_set_budget(epoch_cache::default_budget);
+
+    ok &= test_check("pinned context survives eviction", p == q && frees == 0);
+    ok &= test_check("first unpin keeps it", epoch_cache::unpin(p) && frees == 0);
+    ok &= test_check("last unpin frees it", epoch_cache::unpin(q) && frees == 1);
+    ok &= test_check("unpin of unknown pointer", !epoch_cache::unpin(q));
+
+    return ok;
+}
+
+static bool check_progpow()
+{
+    const auto a = ethash::get_shared_epoch_context(0);
+    const auto b = ethash::get_shared_epoch_context(0);
+    bool ok = test_check("shared progpow context", a && a == b && a->epoch_number == 0);
+
+    bool matches = true;
+    for (int i = 0; i < 4; i++)
+        matches &= ethash_get_global_epoch_context(i & 1)->epoch_number == (i & 1);
+
+    ok &= test_check("global context from the cache", matches && ethash_get_global_epoch_context(0) == a.get());
+    return ok;
+}
+
+static void run_benchmark()
+{
+    const int switches = 10000;
+
+    ethash_get_global_epoch_context(0);
+    ethash_get_global_epoch_context(1);
+
+    double start = test_now_ns();
+
+    for (int i = 0; i < switches; i++)
+        ethash_get_global_epoch_context(i & 1);
+
+    const double cached = (test_now_ns() - start) / 1e3;
+
+    start = test_now_ns();
+    ethash_destroy_epoch_context(ethash_create_epoch_context(1));
+    const double rebuild = (test_now_ns() - start) / 1e3;
+
+    printf("epoch switch, cached    %12.2f us\n", cached / switches);
+    printf("epoch switch, rebuilt   %12.2f us\n", rebuild);
+}
+
+int main(int argc, char** argv)
+{
+    bool ok = true;
+
+    ok &= check_hits();
+    ok &= check_concurrent();
+    ok &= check_eviction();
+    ok &= check_failed_build();
+    ok &= check_pins();
+    ok &= check_progpow();
+
+    test_summary("epoch cache", ok);
+
+    if (ok && test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return ok ? 0 : 1;
+}
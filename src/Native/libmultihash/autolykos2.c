@@ -0,0 +1,300 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "autolykos2.h"
+#include "difficulty.h"
+
+#ifdef _WIN32
+#include "blake2/ref/blake2.h"
+#else
+#include "blake2/sse/blake2.h"
+#endif
+
+/*
+ * Autolykos v2 share verification, matching the managed ErgoJob implementation:
+ *
+ *   i  = (blake2b256(coinbase)[24..32] mod n)
+ *   e  = blake2b256(i || h || M)[1..32]
+ *   j  = 32 indexes read from blake2b256(e || coinbase) mod n
+ *   f  = sum of blake2b256(j[k] || h || M)[1..32] as 256-bit integers
+ *   hit = blake2b256(f)
+ *
+ * where h is the big-endian height and M the 8 KB table of big-endian 64-bit counters 0..1023.
+ *
+ * Nearly all the work is in the 33 hashes over i/j || h || M. Those messages share everything
+ * but their first 64-bit word, so they are hashed several at a time with one BLAKE2b lane per
+ * vector element: the per-lane first word is the only non-broadcast load, and M is generated
+ * on the fly instead of being read from memory.
+ */
+
+#define ELEMENT_WORDS   1025                        /* j || h, then M */
+#define ELEMENT_BLOCKS  ((ELEMENT_WORDS + 15) / 16)
+#define ELEMENT_COUNT   32
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#define bswap_64(x) _byteswap_uint64(x)
+#else
+#define bswap_64(x) __builtin_bswap64(x)
+#endif
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+#define WAYS 8
+typedef __m512i lane_t;
+
+#define ADD(a, b)       _mm512_add_epi64(a, b)
+#define XOR(a, b)       _mm512_xor_si512(a, b)
+#define ROR32(x)        _mm512_ror_epi64(x, 32)
+#define ROR24(x)        _mm512_ror_epi64(x, 24)
+#define ROR16(x)        _mm512_ror_epi64(x, 16)
+#define ROR63(x)        _mm512_ror_epi64(x, 63)
+#define SET1(x)         _mm512_set1_epi64((long long) (x))
+#define LOAD(p)         _mm512_loadu_si512((const void*) (p))
+#define STORE(p, x)     _mm512_storeu_si512((void*) (p), x)
+
+#elif defined(__AVX2__)
+#include <immintrin.h>
+
+#define WAYS 4
+typedef __m256i lane_t;
+
+#define ADD(a, b)       _mm256_add_epi64(a, b)
+#define XOR(a, b)       _mm256_xor_si256(a, b)
+#define ROR32(x)        _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))
+#define ROR24(x)        _mm256_shuffle_epi8(x, _mm256_setr_epi8( \
+                            3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10, \
+                            3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10))
+#define ROR16(x)        _mm256_shuffle_epi8(x, _mm256_setr_epi8( \
+                            2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9, \
+                            2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9))
+#define ROR63(x)        _mm256_or_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x))
+#define SET1(x)         _mm256_set1_epi64x((long long) (x))
+#define LOAD(p)         _mm256_loadu_si256((const __m256i*) (p))
+#define STORE(p, x)     _mm256_storeu_si256((__m256i*) (p), x)
+
+#else
+
+#define WAYS 1
+typedef uint64_t lane_t;
+
+#define ADD(a, b)       ((a) + (b))
+#define XOR(a, b)       ((a) ^ (b))
+#define ROR(x, n)       (((x) >> (n)) | ((x) << (64 - (n))))
+#define ROR32(x)        ROR(x, 32)
+#define ROR24(x)        ROR(x, 24)
+#define ROR16(x)        ROR(x, 16)
+#define ROR63(x)        ROR(x, 63)
+#define SET1(x)         ((uint64_t) (x))
+#define LOAD(p)         (*(p))
+#define STORE(p, x)     (*(p) = (x))
+
+#endif
+
+static const uint64_t blake2b_iv[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+    { 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+    {  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+    {  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+    {  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+    { 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+    { 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+    {  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+    { 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 },
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+};
+
+#define G(r, i, a, b, c, d)                                     \
+    do {                                                        \
+        a = ADD(ADD(a, b), m[blake2b_sigma[r][2 * i]]);         \
+        d = ROR32(XOR(d, a));                                   \
+        c = ADD(c, d);                                          \
+        b = ROR24(XOR(b, c));                                   \
+        a = ADD(ADD(a, b), m[blake2b_sigma[r][2 * i + 1]]);     \
+        d = ROR16(XOR(d, a));                                   \
+        c = ADD(c, d);                                          \
+        b = ROR63(XOR(b, c));                                   \
+    } while (0)
+
+static void blake2b_compress_ways(lane_t h[8], const lane_t m[16], uint64_t counter, int last)
+{
+    lane_t v[16];
+    int r;
+
+    for (r = 0; r < 8; r++) {
+        v[r] = h[r];
+        v[r + 8] = SET1(blake2b_iv[r]);
+    }
+
+    v[12] = XOR(v[12], SET1(counter));
+
+    if (last)
+        v[14] = XOR(v[14], SET1(~0ULL));
+
+    for (r = 0; r < 12; r++) {
+        G(r, 0, v[0], v[4], v[ 8], v[12]);
+        G(r, 1, v[1], v[5], v[ 9], v[13]);
+        G(r, 2, v[2], v[6], v[10], v[14]);
+        G(r, 3, v[3], v[7], v[11], v[15]);
+        G(r, 4, v[0], v[5], v[10], v[15]);
+        G(r, 5, v[1], v[6], v[11], v[12]);
+        G(r, 6, v[2], v[7], v[ 8], v[13]);
+        G(r, 7, v[3], v[4], v[ 9], v[14]);
+    }
+
+    for (r = 0; r < 8; r++)
+        h[r] = XOR(h[r], XOR(v[r], v[r + 8]));
+}
+
+/* BLAKE2b-256 of prefix[lane] || M for WAYS lanes, prefix being the 8 message bytes j || h */
+static void element_hashes(const uint64_t prefix[WAYS], uint8_t out[WAYS][32])
+{
+    lane_t h[8];
+    lane_t m[16];
+    uint64_t words[WAYS];
+    int b, k, lane;
+
+    for (k = 0; k < 8; k++)
+        h[k] = SET1(blake2b_iv[k]);
+
+    /* parameter block: 32 byte digest, no key, fanout and depth 1 */
+    h[0] = XOR(h[0], SET1(0x01010000ULL ^ 32));
+
+    for (b = 0; b < ELEMENT_BLOCKS; b++) {
+        const int last = b == ELEMENT_BLOCKS - 1;
+
+        for (k = 0; k < 16; k++) {
+            const int q = b * 16 + k;
+
+            if (q == 0)
+                m[k] = LOAD(prefix);
+            else if (q < ELEMENT_WORDS)
+                m[k] = SET1(bswap_64((uint64_t) (q - 1)));
+            else
+                m[k] = SET1(0);
+        }
+
+        blake2b_compress_ways(h, m, last ? ELEMENT_WORDS * 8 : (uint64_t) (b + 1) * 128, last);
+    }
+
+    for (k = 0; k < 4; k++) {
+        STORE(words, h[k]);
+
+        for (lane = 0; lane < WAYS; lane++)
+            memcpy(out[lane] + k * 8, &words[lane], 8);
+    }
+}
+
+static uint64_t element_prefix(uint32_t index, uint32_t height)
+{
+    const uint8_t bytes[8] = {
+        (uint8_t) (index >> 24), (uint8_t) (index >> 16), (uint8_t) (index >> 8), (uint8_t) index,
+        (uint8_t) (height >> 24), (uint8_t) (height >> 16), (uint8_t) (height >> 8), (uint8_t) height,
+    };
+    uint64_t word;
+
+    memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+static uint32_t read_be32(const uint8_t* p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+static uint64_t read_be64(const uint8_t* p)
+{
+    return ((uint64_t) read_be32(p) << 32) | read_be32(p + 4);
+}
+
+/* sum += the 31 byte big-endian number at p; limbs are least significant first */
+static void add_element(uint64_t sum[4], const uint8_t* p)
+{
+    const uint64_t x[4] = {
+        read_be64(p + 23),
+        read_be64(p + 15),
+        read_be64(p + 7),
+        read_be64(p - 1) & 0x00ffffffffffffffULL,
+    };
+    uint64_t carry = 0;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        const uint64_t s = sum[i] + x[i];
+        const uint64_t c = s < x[i];
+
+        sum[i] = s + carry;
+        carry = c | (sum[i] < s);
+    }
+}
+
+int autolykos2_blake2b_ways(void)
+{
+    return WAYS;
+}
+
+int autolykos2_verify(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n,
+    const uint8_t target[32], uint8_t hit[32])
+{
+    uint8_t hash[32];
+    uint8_t seed[31 + AUTOLYKOS2_MAX_COINBASE];
+    uint8_t indexes[64];
+    uint8_t elements[WAYS][32];
+    uint64_t prefix[WAYS];
+    uint64_t sum[4] = { 0 };
+    uint8_t f[32];
+    u256 hit_value, target_value;
+    int k, lane;
+
+    memset(hit, 0xff, 32);
+
+    if (coinbase_len > AUTOLYKOS2_MAX_COINBASE || n == 0)
+        return 0;
+
+    /* i, then e from the element hash of i */
+    blake2b(hash, 32, coinbase, coinbase_len, NULL, 0);
+
+    for (lane = 0; lane < WAYS; lane++)
+        prefix[lane] = element_prefix((uint32_t) (read_be64(hash + 24) % n), height);
+
+    element_hashes(prefix, elements);
+
+    /* the 32 indexes are read from the seed hash repeated twice */
+    memcpy(seed, elements[0] + 1, 31);
+    memcpy(seed + 31, coinbase, coinbase_len);
+    blake2b(indexes, 32, seed, 31 + coinbase_len, NULL, 0);
+    memcpy(indexes + 32, indexes, 32);
+
+    for (k = 0; k < ELEMENT_COUNT; k += WAYS) {
+        for (lane = 0; lane < WAYS; lane++)
+            prefix[lane] = element_prefix(read_be32(indexes + k + lane) % n, height);
+
+        element_hashes(prefix, elements);
+
+        for (lane = 0; lane < WAYS; lane++)
+            add_element(sum, elements[lane] + 1);
+    }
+
+    for (k = 0; k < 4; k++) {
+        const uint64_t limb = sum[3 - k];
+        int i;
+
+        for (i = 0; i < 8; i++)
+            f[k * 8 + i] = (uint8_t) (limb >> (56 - i * 8));
+    }
+
+    blake2b(hit, 32, f, 32, NULL, 0);
+
+    u256_from_be(&hit_value, hit);
+    u256_from_be(&target_value, target);
+
+    return u256_cmp(&hit_value, &target_value) < 0;
+}
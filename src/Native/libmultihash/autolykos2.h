@@ -0,0 +1,27 @@
+#ifndef AUTOLYKOS2_H
+#define AUTOLYKOS2_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define AUTOLYKOS2_MAX_COINBASE 128
+
+/*
+ * Verifies an Ergo (Autolykos v2) share. coinbase is msg || nonce, n the table size for height.
+ * hit receives the 256-bit hit as a big-endian number; returns 1 if hit < target (big-endian),
+ * 0 otherwise or if coinbase_len exceeds AUTOLYKOS2_MAX_COINBASE.
+ */
+int autolykos2_verify(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n,
+    const uint8_t target[32], uint8_t hit[32]);
+
+/* number of element hashes computed side by side (8 with AVX-512, 4 with AVX2, else 1) */
+int autolykos2_blake2b_ways(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
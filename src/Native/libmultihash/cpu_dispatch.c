@@ -0,0 +1,256 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cpu_dispatch.h"
+#include "autolykos2.h"
+#include "keccak/keccakf1600.h"
+
+#ifdef MULTIHASH_DISPATCH
+#include "blake2/sse/blake2.h"
+#endif
+
+struct kernel
+{
+    const char* name;
+    isa_level level;
+};
+
+/*
+ * sph, scrypt's salsa20/8 and single Keccak-f[1600] permutations (SHA-3, heavyhash) are plain
+ * C. Building them for AVX2 or AVX-512 made no measurable difference, so they are only compiled
+ * for the baseline. The keccak entry is the multi-buffer sponge behind the batch exports.
+ */
+static struct kernel kernels[] = {
+    { "blake2b", ISA_BASELINE },
+    { "blake2s", ISA_BASELINE },
+    { "autolykos2", ISA_BASELINE },
+    { "sph", ISA_BASELINE },
+    { "sha3", ISA_BASELINE },
+    { "scrypt", ISA_BASELINE },
+    { "heavyhash", ISA_BASELINE },
+    { "keccak", ISA_BASELINE },
+};
+
+#define KERNEL_COUNT (sizeof(kernels) / sizeof(kernels[0]))
+
+static isa_level detect_isa_level(void)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return ISA_AVX2;
+    if (__builtin_cpu_supports("avx"))
+        return ISA_AVX;
+    if (__builtin_cpu_supports("sse4.1"))
+        return ISA_SSE41;
+#endif
+
+    return ISA_BASELINE;
+}
+
+isa_level cpu_isa_level(void)
+{
+    static int level = -1;
+
+    if (level < 0)
+        level = (int) detect_isa_level();
+
+    return (isa_level) level;
+}
+
+const char* isa_level_name(isa_level level)
+{
+    switch (level) {
+    case ISA_SSE41:
+        return "sse41";
+    case ISA_AVX:
+        return "avx";
+    case ISA_AVX2:
+        return "avx2";
+    case ISA_AVX512:
+        return "avx512";
+    default:
+        return "baseline";
+    }
+}
+
+static void set_kernel_level(const char* name, isa_level level)
+{
+    size_t i;
+
+    for (i = 0; i < KERNEL_COUNT; i++) {
+        if (strcmp(kernels[i].name, name) == 0)
+            kernels[i].level = level;
+    }
+}
+
+#ifdef MULTIHASH_DISPATCH
+typedef int (*blake2_fn)(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen);
+typedef int (*autolykos2_verify_fn)(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n,
+    const uint8_t target[32], uint8_t hit[32]);
+typedef int (*autolykos2_ways_fn)(void);
+typedef void (*keccak_sponge_batch_fn)(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count,
+    size_t rate, uint8_t pad);
+typedef int (*keccak_ways_fn)(void);
+
+/* the variants are the same sources built with -Dname=name_<isa>, see the Makefile */
+#define BLAKE2_VARIANT(isa) \
+    int blake2b_##isa(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen); \
+    int blake2s_##isa(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen);
+
+#define AUTOLYKOS2_VARIANT(isa) \
+    int autolykos2_verify_##isa(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n, \
+        const uint8_t target[32], uint8_t hit[32]); \
+    int autolykos2_blake2b_ways_##isa(void);
+
+#define KECCAK_VARIANT(isa) \
+    void keccak_sponge_batch_##isa(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count, \
+        size_t rate, uint8_t pad); \
+    int keccak_batch_ways_##isa(void);
+
+BLAKE2_VARIANT(sse2)
+BLAKE2_VARIANT(sse41)
+BLAKE2_VARIANT(avx)
+
+AUTOLYKOS2_VARIANT(baseline)
+AUTOLYKOS2_VARIANT(avx2)
+AUTOLYKOS2_VARIANT(avx512)
+
+KECCAK_VARIANT(baseline)
+KECCAK_VARIANT(avx2)
+KECCAK_VARIANT(avx512)
+
+static blake2_fn blake2b_impl = blake2b_sse2;
+static blake2_fn blake2s_impl = blake2s_sse2;
+static autolykos2_verify_fn autolykos2_verify_impl = autolykos2_verify_baseline;
+static autolykos2_ways_fn autolykos2_ways_impl = autolykos2_blake2b_ways_baseline;
+static keccak_sponge_batch_fn keccak_sponge_batch_impl = keccak_sponge_batch_baseline;
+static keccak_ways_fn keccak_ways_impl = keccak_batch_ways_baseline;
+
+__attribute__((constructor))
+static void select_kernels(void)
+{
+    const isa_level level = cpu_isa_level();
+
+    if (level >= ISA_AVX) {
+        blake2b_impl = blake2b_avx;
+        blake2s_impl = blake2s_avx;
+    }
+    else if (level >= ISA_SSE41) {
+        blake2b_impl = blake2b_sse41;
+        blake2s_impl = blake2s_sse41;
+    }
+
+    set_kernel_level("blake2b", level >= ISA_AVX ? ISA_AVX : level);
+    set_kernel_level("blake2s", level >= ISA_AVX ? ISA_AVX : level);
+
+    if (level >= ISA_AVX512) {
+        autolykos2_verify_impl = autolykos2_verify_avx512;
+        autolykos2_ways_impl = autolykos2_blake2b_ways_avx512;
+        set_kernel_level("autolykos2", ISA_AVX512);
+    }
+    else if (level >= ISA_AVX2) {
+        autolykos2_verify_impl = autolykos2_verify_avx2;
+        autolykos2_ways_impl = autolykos2_blake2b_ways_avx2;
+        set_kernel_level("autolykos2", ISA_AVX2);
+    }
+
+    if (level >= ISA_AVX512) {
+        keccak_sponge_batch_impl = keccak_sponge_batch_avx512;
+        keccak_ways_impl = keccak_batch_ways_avx512;
+        set_kernel_level("keccak", ISA_AVX512);
+    }
+    else if (level >= ISA_AVX2) {
+        keccak_sponge_batch_impl = keccak_sponge_batch_avx2;
+        keccak_ways_impl = keccak_batch_ways_avx2;
+        set_kernel_level("keccak", ISA_AVX2);
+    }
+}
+
+int blake2b(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen)
+{
+    return blake2b_impl(out, outlen, in, inlen, key, keylen);
+}
+
+int blake2s(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen)
+{
+    return blake2s_impl(out, outlen, in, inlen, key, keylen);
+}
+
+int blake2(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen)
+{
+    return blake2b_impl(out, outlen, in, inlen, key, keylen);
+}
+
+int autolykos2_verify(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n,
+    const uint8_t target[32], uint8_t hit[32])
+{
+    return autolykos2_verify_impl(coinbase, coinbase_len, height, n, target, hit);
+}
+
+int autolykos2_blake2b_ways(void)
+{
+    return autolykos2_ways_impl();
+}
+
+void keccak_sponge_batch(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count, size_t rate, uint8_t pad)
+{
+    keccak_sponge_batch_impl(out, outlen, in, inlen, count, rate, pad);
+}
+
+int keccak_batch_ways(void)
+{
+    return keccak_ways_impl();
+}
+
+/* selected by the constructor */
+static void update_levels(void)
+{
+}
+#else
+/* single build: autolykos2.c and keccak_batch.c picked their width from the compiler flags */
+static void update_levels(void)
+{
+    const int ways = autolykos2_blake2b_ways();
+    const int keccak_ways = keccak_batch_ways();
+
+    set_kernel_level("autolykos2", ways == 8 ? ISA_AVX512 : ways == 4 ? ISA_AVX2 : ISA_BASELINE);
+    set_kernel_level("keccak", keccak_ways == 8 ? ISA_AVX512 : keccak_ways == 4 ? ISA_AVX2 : ISA_BASELINE);
+}
+#endif
+
+const char* cpu_kernel_isa(const char* kernel)
+{
+    size_t i;
+
+    update_levels();
+
+    for (i = 0; i < KERNEL_COUNT; i++) {
+        if (strcmp(kernels[i].name, kernel) == 0)
+            return isa_level_name(kernels[i].level);
+    }
+
+    return NULL;
+}
+
+const char* cpu_dispatch_report(void)
+{
+    static char report[256];
+    size_t i, len = 0;
+
+    if (report[0])
+        return report;
+
+    update_levels();
+
+    for (i = 0; i < KERNEL_COUNT; i++) {
+        len += snprintf(report + len, sizeof(report) - len, "%s%s=%s",
+            i ? " " : "", kernels[i].name, isa_level_name(kernels[i].level));
+    }
+
+    return report;
+}
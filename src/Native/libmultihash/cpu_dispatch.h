@@ -0,0 +1,41 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Load-time selection of the SIMD kernels in libmultihash.
+ *
+ * The library is compiled for the baseline of the target architecture. Kernels that
+ * have instruction set specific code (BLAKE2, the Autolykos2 element hashes, multi-buffer
+ * Keccak) are built once per instruction set with renamed entry points, and the best
+ * variant the CPU supports is picked once when the library is loaded.
+ */
+
+typedef enum
+{
+    ISA_BASELINE,
+    ISA_SSE41,
+    ISA_AVX,
+    ISA_AVX2,
+    ISA_AVX512,
+} isa_level;
+
+/* highest level supported by the CPU and the operating system */
+isa_level cpu_isa_level(void);
+
+const char* isa_level_name(isa_level level);
+
+/* level the named kernel runs at, or NULL for an unknown kernel */
+const char* cpu_kernel_isa(const char* kernel);
+
+/* "kernel=level" pairs for every kernel, separated by spaces */
+const char* cpu_dispatch_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,10 +1,26 @@
 #include <stdio.h>
-#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
-#define false 0
-#define true 1
-#define uint32_t unsigned int
+#include "dcrypt.h"
+
+/*
+ * Dcrypt hashes the input, then walks a chain of SHA-256 digests of hex strings
+ * and finally hashes the concatenation of every chain link followed by the input.
+ *
+ * The chain used to be materialised in a 1 MB heap buffer (plus several small
+ * allocations and in-place hex conversions) on every call. Here the final hash is
+ * fed incrementally as the chain is produced, and digests are kept as nibbles and
+ * expanded to ASCII hex directly into the SHA-256 message schedule. The whole
+ * workspace is a fixed-size structure on the calling thread's stack, so the
+ * worst-case memory footprint is bounded and no allocator is involved.
+ *
+ * The output is bit-identical to the historical implementation, including its
+ * non-standard SHA-256 padding (see dcrypt_sha256_padded_len).
+ */
+
+#define DCRYPT_DIGEST_NIBBLES 64
+#define DCRYPT_MAX_MIXED_LEN 1048576
 
 #define Ch(x, y, z)     ((x & (y ^ z)) ^ z)
 #define Maj(x, y, z)    ((x & (y | z)) | (y & z))
@@ -14,8 +30,8 @@
 #define s0(x)           (ROTR(x, 7) ^ ROTR(x, 18) ^ (x >> 3))
 #define s1(x)           (ROTR(x, 17) ^ ROTR(x, 19) ^ (x >> 10))
 
-const char hexmap[16] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
-const uint32_t K[64] = {
+static const unsigned char hexmap[16] = {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'};
+static const uint32_t K[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
     0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -34,134 +50,230 @@ const uint32_t K[64] = {
     0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-void sha256(unsigned char * instr, unsigned char * hash, unsigned int len)
-{
-
- uint32_t H[8] = {
+static const uint32_t H0[8] = {
     0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
- };
- uint32_t W[64] = {0};
- unsigned int T1, T2, t;
- unsigned int a, b, c, d, e, f, g, h, i;
- unsigned int curBlock = 0;
-
- unsigned int l = (len + 1) / 4 + 2;
- unsigned int N = (l + 15) / 16;
- instr[len] = 128; // Hash Terminator
- for (t = len + 1; t < N * 64; t++) instr[t] = 0;
-
- for (curBlock = 0; curBlock < N; curBlock ++) {
-  for (t = 0; t < 16; t++) W[t] = (instr[curBlock * 64 + t * 4 + 0] << 24) + (instr[curBlock * 64 + t * 4 + 1] << 16) + (instr[curBlock * 64 + t * 4 + 2] << 8) + instr[curBlock * 64 + t * 4 + 3];
-  if (curBlock == N - 1) W[15] = len * 8;
-  for (t = 16; t < 64; t++) W[t] = s1(W[t-2]) + W[t-7] + s0(W[t-15]) + W[t-16];
-
-  a = H[0]; b = H[1]; c = H[2]; d = H[3]; e = H[4]; f = H[5]; g = H[6]; h = H[7];
-  for (t = 0; t < 64 ; t++) {
-   T1 = h + S1(e) + Ch(e,f,g) + K[t] + W[t];
-   T2 = S0(a) + Maj(a,b,c);
-   h = g;
-   g = f;
-   f = e;
-   e = d + T1;
-   d = c;
-   c = b;
-   b = a;
-   a = T1 + T2;
-  }
-
-  H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
- }
-
-
- t = 0; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 1; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 2; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 3; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 4; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 5; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 6; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
- t = 7; i = H[t]; hash[t * 8 + 7] = i & 0xf; hash[t * 8 + 6] = (i >> 4) & 0xf; hash[t * 8 + 5] = (i >> 8) & 0xf; hash[t * 8 + 4] = (i >> 12) & 0xf; hash[t * 8 + 3] = (i >> 16) & 0xf; hash[t * 8 + 2] = (i >> 20) & 0xf; hash[t * 8 + 1] = (i >> 24) & 0xf; hash[t * 8 + 0] = (i >> 28) & 0xf;
+};
+
+typedef struct
+{
+    uint32_t H[8];
+    unsigned char buf[64];
+    uint32_t buf_len;
+    uint32_t total_len;
+} dcrypt_sha256_ctx;
+
+/* Per-call workspace. Lives on the stack; its size does not depend on the input. */
+typedef struct
+{
+    dcrypt_sha256_ctx final;            /* running hash over mixed chain || input */
+    unsigned char hashed[DCRYPT_DIGEST_NIBBLES];
+    unsigned char chain[DCRYPT_DIGEST_NIBBLES];
+} dcrypt_workspace;
+
+static void dcrypt_sha256_compress(uint32_t H[8], uint32_t W[64])
+{
+    uint32_t T1, T2, t;
+    uint32_t a, b, c, d, e, f, g, h;
+
+    for (t = 16; t < 64; t++) W[t] = s1(W[t-2]) + W[t-7] + s0(W[t-15]) + W[t-16];
+
+    a = H[0]; b = H[1]; c = H[2]; d = H[3]; e = H[4]; f = H[5]; g = H[6]; h = H[7];
+    for (t = 0; t < 64; t++) {
+        T1 = h + S1(e) + Ch(e,f,g) + K[t] + W[t];
+        T2 = S0(a) + Maj(a,b,c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + T1;
+        d = c;
+        c = b;
+        b = a;
+        a = T1 + T2;
+    }
+
+    H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+}
+
+static void dcrypt_sha256_block(uint32_t H[8], const unsigned char* block)
+{
+    uint32_t W[64];
+    uint32_t t;
+
+    for (t = 0; t < 16; t++)
+        W[t] = ((uint32_t) block[t * 4] << 24) | ((uint32_t) block[t * 4 + 1] << 16) | ((uint32_t) block[t * 4 + 2] << 8) | block[t * 4 + 3];
+
+    dcrypt_sha256_compress(H, W);
+}
+
+/* Compresses the ASCII hex spelling of a 64-nibble digest without building the string */
+static void dcrypt_sha256_hex_block(uint32_t H[8], const unsigned char* nibbles)
+{
+    uint32_t W[64];
+    uint32_t t;
+
+    for (t = 0; t < 16; t++)
+        W[t] = ((uint32_t) hexmap[nibbles[t * 4]] << 24) | ((uint32_t) hexmap[nibbles[t * 4 + 1]] << 16) |
+            ((uint32_t) hexmap[nibbles[t * 4 + 2]] << 8) | hexmap[nibbles[t * 4 + 3]];
+
+    dcrypt_sha256_compress(H, W);
+}
+
+/*
+ * Dcrypt's SHA-256 pads the message to ((len + 1) / 4 + 17) / 16 blocks rather than
+ * the standard ceil((len + 9) / 64). For some lengths the 64-bit length field therefore
+ * shares its upper word with the 0x80 terminator or trailing message bytes, and only
+ * the low 32 bits of the bit length are stored. Consensus depends on this.
+ */
+static uint32_t dcrypt_sha256_padded_len(uint32_t len)
+{
+    uint32_t words = (len + 1) / 4 + 2;
+    return ((words + 15) / 16) * 64;
+}
+
+static void dcrypt_sha256_init(dcrypt_sha256_ctx* ctx)
+{
+    memcpy(ctx->H, H0, sizeof(H0));
+    ctx->buf_len = 0;
+    ctx->total_len = 0;
+}
+
+static void dcrypt_sha256_update(dcrypt_sha256_ctx* ctx, const unsigned char* data, uint32_t len)
+{
+    ctx->total_len += len;
+
+    if (ctx->buf_len) {
+        uint32_t n = 64 - ctx->buf_len;
+        if (n > len) n = len;
+
+        memcpy(ctx->buf + ctx->buf_len, data, n);
+        ctx->buf_len += n;
+        data += n;
+        len -= n;
+
+        if (ctx->buf_len < 64)
+            return;
+
+        dcrypt_sha256_block(ctx->H, ctx->buf);
+        ctx->buf_len = 0;
+    }
+
+    for (; len >= 64; data += 64, len -= 64)
+        dcrypt_sha256_block(ctx->H, data);
+
+    memcpy(ctx->buf, data, len);
+    ctx->buf_len = len;
 }
 
-void hexToAsc(unsigned char * tmp_list, unsigned int len) {
-  unsigned int i;
-  for (i = 0; i < len; i++) tmp_list[i] = hexmap[ tmp_list[i] ];
+/* Appends the hex spelling of a digest; callers only use this on block boundaries */
+static void dcrypt_sha256_update_hex(dcrypt_sha256_ctx* ctx, const unsigned char* nibbles)
+{
+    dcrypt_sha256_hex_block(ctx->H, nibbles);
+    ctx->total_len += DCRYPT_DIGEST_NIBBLES;
 }
 
+static void dcrypt_sha256_final(dcrypt_sha256_ctx* ctx, unsigned char* nibbles)
+{
+    uint32_t remaining = dcrypt_sha256_padded_len(ctx->total_len) - ctx->total_len;
+    uint32_t bits = ctx->total_len * 8;
+    uint32_t i, t;
+
+    /* terminator, zero fill, and the (truncated) bit length in the last four bytes */
+    for (i = 0; i < remaining; i++) {
+        unsigned char c = 0;
 
-unsigned char mix_hashed_num(unsigned char * hashedData, unsigned char * ret_list, unsigned int * ret_list_len) {
-  unsigned char * tmp_list = malloc(128);
-  unsigned int i, index = 0, tmp_val;
-  for (i = 0; i < 64; i++) tmp_list[i] = 255;
-  *ret_list_len = 0;
-  unsigned int counter = 0;
+        if (i == 0)
+            c = 128;
+        else if (i >= remaining - 4)
+            c = (unsigned char) (bits >> ((remaining - 1 - i) * 8));
 
-  unsigned char hashed_end = false;
-  while (hashed_end == false) {
-    counter += 1;
-    index += hashedData[index] + 1;
+        ctx->buf[ctx->buf_len++] = c;
 
-    if (index >= 64) {
-      index %= 64;
-      hexToAsc(hashedData, 64);
-      sha256(hashedData, hashedData, 64);
+        if (ctx->buf_len == 64) {
+            dcrypt_sha256_block(ctx->H, ctx->buf);
+            ctx->buf_len = 0;
+        }
     }
 
-    tmp_val = hexmap[ hashedData[index] ];
-    tmp_list[64] = tmp_val;
-    sha256(tmp_list, tmp_list, 65);
-    hexToAsc(tmp_list, 64);
+    for (t = 0; t < 8; t++) {
+        for (i = 0; i < 8; i++)
+            nibbles[t * 8 + i] = (ctx->H[t] >> (28 - i * 4)) & 0xf;
+    }
+}
 
-    if (index == 63)
-      if (tmp_val == tmp_list[63])
-        hashed_end = true;
+/* sha256 of (64 bytes of prefix) || suffix, where prefix is either all 0xff or hex nibbles */
+static void dcrypt_hash_chain_link(unsigned char* chain, int first, unsigned char suffix)
+{
+    dcrypt_sha256_ctx ctx;
 
-    for(i = 0; i < 64;i++) ret_list[*ret_list_len + i] = tmp_list[i];
-    *ret_list_len += 64;
+    dcrypt_sha256_init(&ctx);
 
-    if (*ret_list_len > 1048576) {
-      free(tmp_list); 
-      return false; 
+    if (first) {
+        unsigned char seed[DCRYPT_DIGEST_NIBBLES];
+        memset(seed, 255, sizeof(seed));
+        dcrypt_sha256_update(&ctx, seed, sizeof(seed));
+    } else {
+        dcrypt_sha256_update_hex(&ctx, chain);
     }
-  }
-  free(tmp_list); return true;
+
+    dcrypt_sha256_update(&ctx, &suffix, 1);
+    dcrypt_sha256_final(&ctx, chain);
 }
 
+static void dcrypt_rehash_hex(unsigned char* nibbles)
+{
+    dcrypt_sha256_ctx ctx;
+
+    dcrypt_sha256_init(&ctx);
+    dcrypt_sha256_update_hex(&ctx, nibbles);
+    dcrypt_sha256_final(&ctx, nibbles);
+}
+
+static int mix_hashed_num(dcrypt_workspace* ws)
+{
+    uint32_t index = 0;
+    uint32_t mixed_len = 0;
+    unsigned char tmp_val;
+    int first = 1;
+
+    for (;;) {
+        index += ws->hashed[index] + 1;
+
+        if (index >= 64) {
+            index %= 64;
+            dcrypt_rehash_hex(ws->hashed);
+        }
+
+        tmp_val = hexmap[ws->hashed[index]];
+        dcrypt_hash_chain_link(ws->chain, first, tmp_val);
+        first = 0;
 
-void dcrypt_hash(const char * input, char * hash, uint32_t len) {
-  unsigned char * instr = malloc(len);
-  memcpy( instr, input, len );
-  unsigned char * hashed = malloc(128);
-  unsigned char * mixedHash = malloc(1048576 + 1024); // This assumes a max length of work of 1024 bytes?;
-  unsigned char * finalToHash;
-  unsigned int lenMixedHash = 0;
-  sha256(instr, hashed, len); 
-  if (mix_hashed_num(hashed, mixedHash, &lenMixedHash) == true) {
-    finalToHash = malloc( lenMixedHash + len + 64 );
-    memcpy( finalToHash, mixedHash, lenMixedHash);
-    memcpy( &(finalToHash[lenMixedHash]), instr, len);
-    sha256(finalToHash, hash, len + lenMixedHash);
-    free(finalToHash);
-  } else {
-    printf("Buffer limit exceeded.\n");
-  }
-  free(mixedHash);
+        dcrypt_sha256_update_hex(&ws->final, ws->chain);
+        mixed_len += DCRYPT_DIGEST_NIBBLES;
+
+        if (mixed_len > DCRYPT_MAX_MIXED_LEN)
+            return 0;
+
+        if (index == 63 && tmp_val == hexmap[ws->chain[63]])
+            return 1;
+    }
 }
 
-/* :int main(int argc, char *argv[])
+void dcrypt_hash(const char* input, char* hash, uint32_t len)
 {
-  char * hash  = malloc(64);
-  int i;
-  
-  memset(hash,  0, 32);
-  char instr[128] = "The quick brown fox jumps over the lazy dog";
-
-  dcrypt_hash(instr, hash, 43); 
-  
-  printf("\nHash result\n");
-  for (i = 0 ; i < 64; i++) printf("%01x", hash[i]);  printf("\n");
-
-  free(hash);
-  return 0;
-} */
+    dcrypt_workspace ws;
+    dcrypt_sha256_ctx ctx;
+
+    dcrypt_sha256_init(&ctx);
+    dcrypt_sha256_update(&ctx, (const unsigned char*) input, len);
+    dcrypt_sha256_final(&ctx, ws.hashed);
+
+    dcrypt_sha256_init(&ws.final);
+
+    if (mix_hashed_num(&ws)) {
+        dcrypt_sha256_update(&ws.final, (const unsigned char*) input, len);
+        dcrypt_sha256_final(&ws.final, (unsigned char*) hash);
+    } else {
+        printf("Buffer limit exceeded.\n");
+    }
+}
@@ -0,0 +1,305 @@
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "difficulty.h"
+
+/*
+ * Fixed-width share difficulty math. Replaces the per-share BigInteger/BigRational
+ * round trip on the managed side: numbers live in four 64-bit limbs on the stack and
+ * diff1 / hash is reduced to a 55-bit quotient plus a sticky bit for the remainder, which
+ * is enough to round it to a double exactly once.
+ */
+
+#define QUOTIENT_BITS 55    /* 53 mantissa bits, a round bit and one more for the sticky */
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static int bit_length64(uint64_t x)
+{
+    unsigned long index;
+    return _BitScanReverse64(&index, x) ? (int) index + 1 : 0;
+}
+#else
+static int bit_length64(uint64_t x)
+{
+    return x ? 64 - __builtin_clzll(x) : 0;
+}
+#endif
+
+static uint64_t load_le64(const uint8_t* p)
+{
+    uint64_t x = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--)
+        x = (x << 8) | p[i];
+
+    return x;
+}
+
+static uint64_t load_be64(const uint8_t* p)
+{
+    uint64_t x = 0;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        x = (x << 8) | p[i];
+
+    return x;
+}
+
+void u256_from_le(u256* x, const uint8_t bytes[32])
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        x->limb[i] = load_le64(bytes + i * 8);
+}
+
+void u256_from_be(u256* x, const uint8_t bytes[32])
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        x->limb[i] = load_be64(bytes + (3 - i) * 8);
+}
+
+/* borrow out of a - b */
+static uint64_t u256_borrow(const u256* a, const u256* b)
+{
+    uint64_t borrow = 0;
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        const uint64_t d = a->limb[i] - b->limb[i];
+
+        borrow = (a->limb[i] < b->limb[i]) | (d < borrow);
+    }
+
+    return borrow;
+}
+
+int u256_cmp(const u256* a, const u256* b)
+{
+    return (int) u256_borrow(b, a) - (int) u256_borrow(a, b);
+}
+
+static int u256_bit_length(const u256* x)
+{
+    int i;
+
+    for (i = 3; i >= 0; i--) {
+        if (x->limb[i])
+            return i * 64 + bit_length64(x->limb[i]);
+    }
+
+    return 0;
+}
+
+/* out = x << shift as a 320-bit number, shift < 256 */
+static void shift_left(uint64_t out[5], const u256* x, int shift)
+{
+    const int words = shift / 64;
+    const int bits = shift % 64;
+    int i;
+
+    memset(out, 0, 5 * sizeof(uint64_t));
+
+    for (i = 0; i < 4; i++) {
+        out[i + words] |= x->limb[i] << bits;
+
+        if (bits && i + words + 1 < 5)
+            out[i + words + 1] |= x->limb[i] >> (64 - bits);
+    }
+}
+
+static void shift_left1(uint64_t x[5])
+{
+    int i;
+
+    for (i = 4; i > 0; i--)
+        x[i] = (x[i] << 1) | (x[i - 1] >> 63);
+
+    x[0] <<= 1;
+}
+
+static int greater_equal(const uint64_t a[5], const uint64_t b[5])
+{
+    int i;
+
+    for (i = 4; i >= 0; i--) {
+        if (a[i] != b[i])
+            return a[i] > b[i];
+    }
+
+    return 1;
+}
+
+static void subtract(uint64_t a[5], const uint64_t b[5])
+{
+    uint64_t borrow = 0;
+    int i;
+
+    for (i = 0; i < 5; i++) {
+        const uint64_t d = a[i] - b[i];
+        const uint64_t next = (a[i] < b[i]) | (d < borrow);
+
+        a[i] = d - borrow;
+        borrow = next;
+    }
+}
+
+static int is_zero(const uint64_t x[5])
+{
+    return (x[0] | x[1] | x[2] | x[3] | x[4]) == 0;
+}
+
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 uint128_t;
+
+/* bits [shift, shift + 128) of x */
+static uint128_t extract128(const uint64_t x[5], int shift)
+{
+    const int word = shift / 64;
+    const int bits = shift % 64;
+    uint64_t w[3];
+    int i;
+
+    for (i = 0; i < 3; i++)
+        w[i] = word + i < 5 ? x[word + i] : 0;
+
+    if (bits) {
+        w[0] = (w[0] >> bits) | (w[1] << (64 - bits));
+        w[1] = (w[1] >> bits) | (w[2] << (64 - bits));
+    }
+
+    return ((uint128_t) w[1] << 64) | w[0];
+}
+
+/*
+ * floor(rem * 2^(QUOTIENT_BITS - 1) / div) for div <= rem < 2 * div: a 128/64-bit division of the
+ * leading bits is off by at most one either way, which the exact remainder corrects.
+ */
+static uint64_t divide_quotient(uint64_t rem[5], const uint64_t div[5], int div_bits)
+{
+    const int shift = div_bits > 64 ? div_bits - 64 : 0;
+    uint64_t product[5];
+    uint64_t quotient;
+    uint128_t carry = 0;
+    int i;
+
+    for (i = 4; i > 0; i--)
+        rem[i] = (rem[i] << (QUOTIENT_BITS - 1)) | (rem[i - 1] >> (65 - QUOTIENT_BITS));
+
+    rem[0] <<= QUOTIENT_BITS - 1;
+
+    quotient = (uint64_t) (extract128(rem, shift) / (uint64_t) extract128(div, shift));
+
+    for (i = 0; i < 5; i++) {
+        carry += (uint128_t) quotient * div[i];
+        product[i] = (uint64_t) carry;
+        carry >>= 64;
+    }
+
+    while (!greater_equal(rem, product)) {
+        subtract(product, div);
+        quotient--;
+    }
+
+    subtract(rem, product);
+
+    while (greater_equal(rem, div)) {
+        subtract(rem, div);
+        quotient++;
+    }
+
+    return quotient;
+}
+#else
+/* restoring division, one quotient bit per step */
+static uint64_t divide_quotient(uint64_t rem[5], const uint64_t div[5], int div_bits)
+{
+    uint64_t quotient = 0;
+    int i;
+
+    (void) div_bits;
+
+    for (i = 0; i < QUOTIENT_BITS; i++) {
+        quotient <<= 1;
+
+        if (greater_equal(rem, div)) {
+            subtract(rem, div);
+            quotient |= 1;
+        }
+
+        shift_left1(rem);
+    }
+
+    return quotient;
+}
+#endif
+
+double u256_div_double(const u256* num, const u256* den)
+{
+    const int num_bits = u256_bit_length(num);
+    const int den_bits = u256_bit_length(den);
+    uint64_t rem[5], div[5];
+    uint64_t quotient, mantissa, sticky;
+    int exponent;
+
+    if (den_bits == 0)
+        return INFINITY;
+
+    if (num_bits == 0)
+        return 0.0;
+
+    /* align the top bits, so the first quotient bit is worth 2^exponent */
+    exponent = num_bits - den_bits;
+
+    if (exponent >= 0) {
+        shift_left(rem, num, 0);
+        shift_left(div, den, exponent);
+    }
+    else {
+        shift_left(rem, num, -exponent);
+        shift_left(div, den, 0);
+    }
+
+    if (!greater_equal(rem, div)) {
+        shift_left1(rem);
+        exponent--;
+    }
+
+    quotient = divide_quotient(rem, div, num_bits > den_bits ? num_bits : den_bits);
+
+    sticky = (quotient & 1) | !is_zero(rem);
+    mantissa = quotient >> 2;
+
+    /* round to nearest, ties to even; a carry into bit 53 is still exact as a double */
+    if (((quotient >> 1) & 1) && (sticky || (mantissa & 1)))
+        mantissa++;
+
+    return ldexp((double) mantissa, exponent - 52);
+}
+
+double share_difficulty(const uint8_t hash[32], const uint8_t diff1[32])
+{
+    u256 h, d;
+
+    u256_from_le(&h, hash);
+    u256_from_le(&d, diff1);
+
+    return u256_div_double(&d, &h);
+}
+
+int hash_meets_target(const uint8_t hash[32], const uint8_t target[32])
+{
+    u256 h, t;
+
+    u256_from_le(&h, hash);
+    u256_from_le(&t, target);
+
+    return (int) (u256_borrow(&t, &h) ^ 1);
+}
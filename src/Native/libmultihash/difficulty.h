@@ -0,0 +1,35 @@
+#ifndef DIFFICULTY_H
+#define DIFFICULTY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* 256-bit unsigned integer, least significant limb first */
+typedef struct
+{
+    uint64_t limb[4];
+} u256;
+
+void u256_from_le(u256* x, const uint8_t bytes[32]);
+void u256_from_be(u256* x, const uint8_t bytes[32]);
+
+/* -1, 0 or 1 as a <, == or > b, without data-dependent branches */
+int u256_cmp(const u256* a, const u256* b);
+
+/* num / den rounded to nearest (ties to even); +inf if den is zero */
+double u256_div_double(const u256* num, const u256* den);
+
+/* share difficulty diff1 / hash for 32 byte little-endian numbers, as Miningcore stores hashes */
+double share_difficulty(const uint8_t hash[32], const uint8_t diff1[32]);
+
+/* 1 if hash <= target, both 32 byte little-endian */
+int hash_meets_target(const uint8_t hash[32], const uint8_t target[32]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -30,6 +30,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "qubit.h"
 #include "s3.h"
 #include "verthash/tiny_sha3/sha3.h"
+#include "keccak/keccakf1600.h"
 #include "hefty1.h"
 #include "shavite3.h"
 #include "x13.h"
@@ -40,6 +41,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "x22i.h"
 #include "fresh.h"
 #include "dcrypt.h"
+#include "autolykos2.h"
+#include "difficulty.h"
+#include "cpu_dispatch.h"
 #include "jh.h"
 #include "c11.h"
 #include "Lyra2RE.h"
@@ -63,6 +67,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "blake2/sse/blake2.h"
 #endif
 
+#include <string.h>
+
 #ifdef _WIN32
 #define MODULE_API __declspec(dllexport)
 #else
@@ -86,12 +92,18 @@ extern "C" MODULE_API void sha256csm_export(const char* input, char* output, uin
 
 extern "C" MODULE_API void sha3_256_export(const char* input, char* output, uint32_t input_len)
 {
-    sha3(input, input_len, output, 32);
+    keccak_sponge((uint8_t*) output, 32, (const uint8_t*) input, input_len, KECCAK_RATE(256), SHA3_PAD);
 }
 
 extern "C" MODULE_API void sha3_512_export(const char* input, char* output, uint32_t input_len)
 {
-    sha3(input, input_len, output, 64);
+    keccak_sponge((uint8_t*) output, 64, (const uint8_t*) input, input_len, KECCAK_RATE(512), SHA3_PAD);
+}
+
+// SHA3-256 of count consecutive inputs of input_len bytes each, several at a time on AVX2 and AVX-512
+extern "C" MODULE_API void sha3_256_batch_export(const char* inputs, char* outputs, uint32_t input_len, uint32_t count)
+{
+    keccak_sponge_batch((uint8_t*) outputs, 32, (const uint8_t*) inputs, input_len, count, KECCAK_RATE(256), SHA3_PAD);
 }
 
 extern "C" MODULE_API void hmq17_export(const char* input, char* output, uint32_t input_len)
@@ -146,6 +158,12 @@ extern "C" MODULE_API void kezzak_export(const char* input, char* output, uint32
 	keccak_hash(input, output, input_len);
 }
 
+// Keccak-256 of count consecutive inputs of input_len bytes each
+extern "C" MODULE_API void kezzak_batch_export(const char* inputs, char* outputs, uint32_t input_len, uint32_t count)
+{
+	keccak_hash_batch(inputs, outputs, input_len, count);
+}
+
 extern "C" MODULE_API void bcrypt_export(const char* input, char* output, uint32_t input_len)
 {
 	bcrypt_hash(input, output);
@@ -181,6 +199,11 @@ extern "C" MODULE_API void blake2b_export(const char* input, char* output, uint3
     blake2b(output, output_len == -1 ? BLAKE2B_OUTBYTES : output_len, input, input_len, NULL, 0);
 }
 
+extern "C" MODULE_API bool autolykos2_verify_export(const unsigned char* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n, const unsigned char* target, unsigned char* hit)
+{
+	return autolykos2_verify(coinbase, coinbase_len, height, n, target, hit) != 0;
+}
+
 extern "C" MODULE_API void dcrypt_export(const char* input, char* output, uint32_t input_len)
 {
 	dcrypt_hash(input, output, input_len);
@@ -333,3 +356,114 @@ extern "C" MODULE_API bool equihash_verify_96_5_export(const char* header, int h
 
     return verifyEH_96_5(header, vecSolution, personalization);
 }
+
+extern "C" MODULE_API double share_difficulty_export(const unsigned char* hash, const unsigned char* diff1)
+{
+	return share_difficulty(hash, diff1);
+}
+
+extern "C" MODULE_API bool hash_meets_target_export(const unsigned char* hash, const unsigned char* target)
+{
+	return hash_meets_target(hash, target) != 0;
+}
+
+// Difficulty and target check for count consecutive 32 byte hashes
+extern "C" MODULE_API void share_difficulty_batch_export(const unsigned char* hashes, uint32_t count, const unsigned char* diff1,
+	const unsigned char* target, double* difficulties, unsigned char* meets_target)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		difficulties[i] = share_difficulty(hashes + i * 32, diff1);
+		meets_target[i] = (unsigned char) hash_meets_target(hashes + i * 32, target);
+	}
+}
+
+// dcrypt emits its 256 bit digest as 64 nibbles, one per byte, high nibble first
+static void dcrypt_share_hash(const char* input, char* output, uint32_t input_len)
+{
+	char nibbles[64];
+
+	dcrypt_hash(input, nibbles, input_len);
+
+	for (int i = 0; i < 32; i++)
+		output[i] = (char) (((nibbles[i * 2] & 0xf) << 4) | (nibbles[i * 2 + 1] & 0xf));
+}
+
+typedef void (*share_hash_fn)(const char* input, char* output, uint32_t input_len);
+typedef void (*share_hash_batch_fn)(const char* inputs, char* outputs, uint32_t input_len, uint32_t count);
+
+// Every hash writes exactly 32 bytes; batch is set for the algorithms that hash several inputs at once
+static const struct
+{
+	const char* name;
+	share_hash_fn hash;
+	share_hash_batch_fn batch;
+} share_hashes[] = {
+	{ "blake", blake_export },
+	{ "dcrypt", dcrypt_share_hash },
+	{ "fresh", fresh_export },
+	{ "fugue", fugue_export },
+	{ "geek", geek_export },
+	{ "groestl", groestl_export },
+	{ "groestl-myriad", groestl_myriad_export },
+	{ "heavyhash", heavyhash_export },
+	{ "hefty1", hefty1_export },
+	{ "hmq17", hmq17_export },
+	{ "jh", jh_export },
+	{ "kezzak", kezzak_export, kezzak_batch_export },
+	{ "nist5", nist5_export },
+	{ "phi", phi_export },
+	{ "quark", quark_export },
+	{ "qubit", qubit_export },
+	{ "s3", s3_export },
+	{ "sha256csm", sha256csm_export },
+	{ "sha3-256", sha3_256_export, sha3_256_batch_export },
+	{ "shavite3", shavite3_export },
+	{ "skein", skein_export },
+	{ "x11", x11_export },
+	{ "x13", x13_export },
+	{ "x15", x15_export },
+	{ "x16r", x16r_export },
+	{ "x16rv2", x16rv2_export },
+	{ "x16s", x16s_export },
+	{ "x17", x17_export },
+	{ "x21s", x21s_export },
+	{ "x22i", x22i_export },
+};
+
+/*
+ * Hashes count inputs of input_len bytes each with the named algorithm and classifies them in the
+ * same call, so the accept/reject decision is made before the hashes return to managed memory.
+ * Returns false if the algorithm is not one of share_hashes.
+ */
+extern "C" MODULE_API bool share_hash_batch_export(const char* algorithm, const unsigned char* inputs, uint32_t input_len, uint32_t count,
+	const unsigned char* diff1, const unsigned char* target, unsigned char* hashes, double* difficulties, unsigned char* meets_target)
+{
+	for (size_t i = 0; i < sizeof(share_hashes) / sizeof(share_hashes[0]); i++) {
+		if (strcmp(share_hashes[i].name, algorithm) != 0)
+			continue;
+
+		if (share_hashes[i].batch)
+			share_hashes[i].batch((const char*) inputs, (char*) hashes, input_len, count);
+		else {
+			for (uint32_t j = 0; j < count; j++)
+				share_hashes[i].hash((const char*) inputs + (size_t) j * input_len, (char*) hashes + j * 32, input_len);
+		}
+
+		share_difficulty_batch_export(hashes, count, diff1, target, difficulties, meets_target);
+		return true;
+	}
+
+	return false;
+}
+
+/* "kernel=level" for each dispatched kernel, e.g. "blake2b=avx autolykos2=avx512 ..." */
+extern "C" MODULE_API const char* cpu_dispatch_report_export()
+{
+	return cpu_dispatch_report();
+}
+
+/* instruction set level the named kernel runs at, or NULL for an unknown kernel */
+extern "C" MODULE_API const char* cpu_kernel_isa_export(const char* kernel)
+{
+	return cpu_kernel_isa(kernel);
+}
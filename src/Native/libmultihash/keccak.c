@@ -1,14 +1,14 @@
 #include "keccak.h"
 
-#include "sha3/sph_types.h"
-#include "sha3/sph_keccak.h"
+#include "keccak/keccakf1600.h"
 
 
 void keccak_hash(const char* input, char* output, uint32_t size)
 {
-    sph_keccak256_context ctx_keccak;
-    sph_keccak256_init(&ctx_keccak);
-    sph_keccak256 (&ctx_keccak, input, size);//80);
-    sph_keccak256_close(&ctx_keccak, output);
+    keccak_sponge((uint8_t*) output, 32, (const uint8_t*) input, size, KECCAK_RATE(256), KECCAK_PAD);
 }
 
+void keccak_hash_batch(const char* inputs, char* outputs, uint32_t size, uint32_t count)
+{
+    keccak_sponge_batch((uint8_t*) outputs, 32, (const uint8_t*) inputs, size, count, KECCAK_RATE(256), KECCAK_PAD);
+}
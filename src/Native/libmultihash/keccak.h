@@ -9,6 +9,9 @@ extern "C" {
 
 void keccak_hash(const char* input, char* output, uint32_t size);
 
+/* count consecutive inputs of size bytes each into consecutive 32 byte digests */
+void keccak_hash_batch(const char* inputs, char* outputs, uint32_t size, uint32_t count);
+
 #ifdef __cplusplus
 }
 #endif
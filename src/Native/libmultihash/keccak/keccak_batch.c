@@ -0,0 +1,214 @@
+#include <string.h>
+
+#include "keccakf1600.h"
+
+/*
+ * Multi-buffer Keccak: WAYS independent states, lane i of every state held in one vector, so a
+ * single pass over the round function permutes them all. The Makefile builds this file once per
+ * instruction set with its entry points renamed; the baseline build runs the scalar sponge.
+ */
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+#define WAYS 8
+
+typedef __m512i lane_t;
+
+#define V_LOAD(p) _mm512_loadu_si512((const void*) (p))
+#define V_STORE(p, v) _mm512_storeu_si512((void*) (p), v)
+#define V_SET1(x) _mm512_set1_epi64((long long) (x))
+#define V_XOR(a, b) _mm512_xor_si512(a, b)
+#define V_XOR5(a, b, c, d, e) _mm512_ternarylogic_epi64(_mm512_ternarylogic_epi64(a, b, c, 0x96), d, e, 0x96)
+#define V_ROL(a, n) _mm512_rol_epi64(a, n)
+/* a ^ (~b & c) */
+#define V_CHI(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0xd2)
+
+#elif defined(__AVX2__)
+#include <immintrin.h>
+
+#define WAYS 4
+
+typedef __m256i lane_t;
+
+#define V_LOAD(p) _mm256_loadu_si256((const __m256i*) (p))
+#define V_STORE(p, v) _mm256_storeu_si256((__m256i*) (p), v)
+#define V_SET1(x) _mm256_set1_epi64x((long long) (x))
+#define V_XOR(a, b) _mm256_xor_si256(a, b)
+#define V_XOR5(a, b, c, d, e) V_XOR(V_XOR(V_XOR(a, b), V_XOR(c, d)), e)
+#define V_ROL(a, n) _mm256_or_si256(_mm256_slli_epi64(a, n), _mm256_srli_epi64(a, 64 - (n)))
+#define V_CHI(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+
+#else
+
+#define WAYS 1
+
+#endif
+
+#if WAYS > 1
+
+static const uint64_t keccakf_rc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+/* the round of keccakf1600.c without lane complementing: both instruction sets have and-not */
+static void permute(lane_t s[25])
+{
+    lane_t Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+    lane_t b[25];
+    int round;
+
+    for (round = 0; round < 24; round++) {
+        Ca = V_XOR5(s[0], s[5], s[10], s[15], s[20]);
+        Ce = V_XOR5(s[1], s[6], s[11], s[16], s[21]);
+        Ci = V_XOR5(s[2], s[7], s[12], s[17], s[22]);
+        Co = V_XOR5(s[3], s[8], s[13], s[18], s[23]);
+        Cu = V_XOR5(s[4], s[9], s[14], s[19], s[24]);
+
+        Da = V_XOR(Cu, V_ROL(Ce, 1));
+        De = V_XOR(Ca, V_ROL(Ci, 1));
+        Di = V_XOR(Ce, V_ROL(Co, 1));
+        Do = V_XOR(Ci, V_ROL(Cu, 1));
+        Du = V_XOR(Co, V_ROL(Ca, 1));
+
+        Ba = V_XOR(s[0], Da);
+        Be = V_ROL(V_XOR(s[6], De), 44);
+        Bi = V_ROL(V_XOR(s[12], Di), 43);
+        Bo = V_ROL(V_XOR(s[18], Do), 21);
+        Bu = V_ROL(V_XOR(s[24], Du), 14);
+        b[0] = V_XOR(V_CHI(Ba, Be, Bi), V_SET1(keccakf_rc[round]));
+        b[1] = V_CHI(Be, Bi, Bo);
+        b[2] = V_CHI(Bi, Bo, Bu);
+        b[3] = V_CHI(Bo, Bu, Ba);
+        b[4] = V_CHI(Bu, Ba, Be);
+
+        Ba = V_ROL(V_XOR(s[3], Do), 28);
+        Be = V_ROL(V_XOR(s[9], Du), 20);
+        Bi = V_ROL(V_XOR(s[10], Da), 3);
+        Bo = V_ROL(V_XOR(s[16], De), 45);
+        Bu = V_ROL(V_XOR(s[22], Di), 61);
+        b[5] = V_CHI(Ba, Be, Bi);
+        b[6] = V_CHI(Be, Bi, Bo);
+        b[7] = V_CHI(Bi, Bo, Bu);
+        b[8] = V_CHI(Bo, Bu, Ba);
+        b[9] = V_CHI(Bu, Ba, Be);
+
+        Ba = V_ROL(V_XOR(s[1], De), 1);
+        Be = V_ROL(V_XOR(s[7], Di), 6);
+        Bi = V_ROL(V_XOR(s[13], Do), 25);
+        Bo = V_ROL(V_XOR(s[19], Du), 8);
+        Bu = V_ROL(V_XOR(s[20], Da), 18);
+        b[10] = V_CHI(Ba, Be, Bi);
+        b[11] = V_CHI(Be, Bi, Bo);
+        b[12] = V_CHI(Bi, Bo, Bu);
+        b[13] = V_CHI(Bo, Bu, Ba);
+        b[14] = V_CHI(Bu, Ba, Be);
+
+        Ba = V_ROL(V_XOR(s[4], Du), 27);
+        Be = V_ROL(V_XOR(s[5], Da), 36);
+        Bi = V_ROL(V_XOR(s[11], De), 10);
+        Bo = V_ROL(V_XOR(s[17], Di), 15);
+        Bu = V_ROL(V_XOR(s[23], Do), 56);
+        b[15] = V_CHI(Ba, Be, Bi);
+        b[16] = V_CHI(Be, Bi, Bo);
+        b[17] = V_CHI(Bi, Bo, Bu);
+        b[18] = V_CHI(Bo, Bu, Ba);
+        b[19] = V_CHI(Bu, Ba, Be);
+
+        Ba = V_ROL(V_XOR(s[2], Di), 62);
+        Be = V_ROL(V_XOR(s[8], Do), 55);
+        Bi = V_ROL(V_XOR(s[14], Du), 39);
+        Bo = V_ROL(V_XOR(s[15], Da), 41);
+        Bu = V_ROL(V_XOR(s[21], De), 2);
+        b[20] = V_CHI(Ba, Be, Bi);
+        b[21] = V_CHI(Be, Bi, Bo);
+        b[22] = V_CHI(Bi, Bo, Bu);
+        b[23] = V_CHI(Bo, Bu, Ba);
+        b[24] = V_CHI(Bu, Ba, Be);
+
+        memcpy(s, b, sizeof(b));
+    }
+}
+
+/* xors one block of each of the WAYS messages, stride bytes apart, into the states */
+static void absorb(lane_t s[25], const uint8_t* in, size_t stride, size_t rate)
+{
+    uint64_t words[WAYS];
+    size_t i, w;
+
+    for (i = 0; i < rate / 8; i++) {
+        for (w = 0; w < WAYS; w++)
+            memcpy(&words[w], in + w * stride + i * 8, 8);
+
+        s[i] = V_XOR(s[i], V_LOAD(words));
+    }
+}
+
+static void sponge_ways(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t rate, uint8_t pad)
+{
+    uint8_t last[WAYS][200];
+    uint64_t words[WAYS];
+    lane_t s[25];
+    size_t i, w, n, off;
+
+    for (i = 0; i < 25; i++)
+        s[i] = V_SET1(0);
+
+    for (off = 0; inlen - off >= rate; off += rate) {
+        absorb(s, in + off, inlen, rate);
+        permute(s);
+    }
+
+    for (w = 0; w < WAYS; w++) {
+        memset(last[w], 0, rate);
+        memcpy(last[w], in + w * inlen + off, inlen - off);
+        last[w][inlen - off] ^= pad;
+        last[w][rate - 1] ^= 0x80;
+    }
+
+    absorb(s, last[0], sizeof(last[0]), rate);
+    permute(s);
+
+    for (off = 0;;) {
+        n = outlen - off < rate ? outlen - off : rate;
+
+        for (i = 0; i < (n + 7) / 8; i++) {
+            const size_t len = n - i * 8 < 8 ? n - i * 8 : 8;
+
+            V_STORE(words, s[i]);
+
+            for (w = 0; w < WAYS; w++)
+                memcpy(out + w * outlen + off + i * 8, &words[w], len);
+        }
+
+        if ((off += n) == outlen)
+            break;
+
+        permute(s);
+    }
+}
+
+#endif
+
+void keccak_sponge_batch(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count, size_t rate, uint8_t pad)
+{
+    size_t i = 0;
+
+#if WAYS > 1
+    for (; i + WAYS <= count; i += WAYS)
+        sponge_ways(out + i * outlen, outlen, in + i * inlen, inlen, rate, pad);
+#endif
+
+    for (; i < count; i++)
+        keccak_sponge(out + i * outlen, outlen, in + i * inlen, inlen, rate, pad);
+}
+
+int keccak_batch_ways(void)
+{
+    return WAYS;
+}
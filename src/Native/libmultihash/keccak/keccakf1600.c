@@ -0,0 +1,161 @@
+#include <string.h>
+
+#include "keccakf1600.h"
+
+static const uint64_t keccakf_rc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+#define ROL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+/*
+ * One round from the A lanes into the E lanes, with the lanes named by row (b g k m s) and
+ * column (a e i o u).
+ *
+ * Lane complementing: be, bi, go, ki, mi and sa are kept inverted for the whole permutation,
+ * which turns all but one NOT of each chi row into an OR or into an operand the row already
+ * has, so a round needs 25 NOTs fewer on x86-64 without BMI's ANDN.
+ */
+#define KECCAK_ROUND(A, E, rc) \
+    do { \
+        uint64_t Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu; \
+        \
+        Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+        Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+        Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+        Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+        Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+        \
+        Da = Cu ^ ROL64(Ce, 1); \
+        De = Ca ^ ROL64(Ci, 1); \
+        Di = Ce ^ ROL64(Co, 1); \
+        Do = Ci ^ ROL64(Cu, 1); \
+        Du = Co ^ ROL64(Ca, 1); \
+        \
+        Ba = A##ba ^ Da; \
+        Be = ROL64(A##ge ^ De, 44); \
+        Bi = ROL64(A##ki ^ Di, 43); \
+        Bo = ROL64(A##mo ^ Do, 21); \
+        Bu = ROL64(A##su ^ Du, 14); \
+        E##ba = Ba ^ (Be | Bi) ^ (rc); \
+        E##be = Be ^ (~Bi | Bo); \
+        E##bi = Bi ^ (Bo & Bu); \
+        E##bo = Bo ^ (Bu | Ba); \
+        E##bu = Bu ^ (Ba & Be); \
+        \
+        Ba = ROL64(A##bo ^ Do, 28); \
+        Be = ROL64(A##gu ^ Du, 20); \
+        Bi = ROL64(A##ka ^ Da, 3); \
+        Bo = ROL64(A##me ^ De, 45); \
+        Bu = ROL64(A##si ^ Di, 61); \
+        E##ga = Ba ^ (Be | Bi); \
+        E##ge = Be ^ (Bi & Bo); \
+        E##gi = Bi ^ (Bo | ~Bu); \
+        E##go = Bo ^ (Bu | Ba); \
+        E##gu = Bu ^ (Ba & Be); \
+        \
+        Ba = ROL64(A##be ^ De, 1); \
+        Be = ROL64(A##gi ^ Di, 6); \
+        Bi = ROL64(A##ko ^ Do, 25); \
+        Bo = ROL64(A##mu ^ Du, 8); \
+        Bu = ROL64(A##sa ^ Da, 18); \
+        E##ka = Ba ^ (Be | Bi); \
+        E##ke = Be ^ (Bi & Bo); \
+        E##ki = Bi ^ (~Bo & Bu); \
+        E##ko = ~Bo ^ (Bu | Ba); \
+        E##ku = Bu ^ (Ba & Be); \
+        \
+        Ba = ROL64(A##bu ^ Du, 27); \
+        Be = ROL64(A##ga ^ Da, 36); \
+        Bi = ROL64(A##ke ^ De, 10); \
+        Bo = ROL64(A##mi ^ Di, 15); \
+        Bu = ROL64(A##so ^ Do, 56); \
+        E##ma = Ba ^ (Be & Bi); \
+        E##me = Be ^ (Bi | Bo); \
+        E##mi = Bi ^ (~Bo | Bu); \
+        E##mo = ~Bo ^ (Bu & Ba); \
+        E##mu = Bu ^ (Ba | Be); \
+        \
+        Ba = ROL64(A##bi ^ Di, 62); \
+        Be = ROL64(A##go ^ Do, 55); \
+        Bi = ROL64(A##ku ^ Du, 39); \
+        Bo = ROL64(A##ma ^ Da, 41); \
+        Bu = ROL64(A##se ^ De, 2); \
+        E##sa = Ba ^ (~Be & Bi); \
+        E##se = ~Be ^ (Bi | Bo); \
+        E##si = Bi ^ (Bo & Bu); \
+        E##so = Bo ^ (Bu | Ba); \
+        E##su = Bu ^ (Ba & Be); \
+    } while (0)
+
+void keccakf1600(uint64_t st[25])
+{
+    uint64_t Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku;
+    uint64_t Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+    uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+    uint64_t Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+    int round;
+
+    Aba = st[0];  Abe = ~st[1];  Abi = ~st[2];  Abo = st[3];   Abu = st[4];
+    Aga = st[5];  Age = st[6];   Agi = st[7];   Ago = ~st[8];  Agu = st[9];
+    Aka = st[10]; Ake = st[11];  Aki = ~st[12]; Ako = st[13];  Aku = st[14];
+    Ama = st[15]; Ame = st[16];  Ami = ~st[17]; Amo = st[18];  Amu = st[19];
+    Asa = ~st[20]; Ase = st[21]; Asi = st[22];  Aso = st[23];  Asu = st[24];
+
+    for (round = 0; round < 24; round += 2) {
+        KECCAK_ROUND(A, E, keccakf_rc[round]);
+        KECCAK_ROUND(E, A, keccakf_rc[round + 1]);
+    }
+
+    st[0] = Aba;   st[1] = ~Abe;  st[2] = ~Abi;   st[3] = Abo;   st[4] = Abu;
+    st[5] = Aga;   st[6] = Age;   st[7] = Agi;    st[8] = ~Ago;  st[9] = Agu;
+    st[10] = Aka;  st[11] = Ake;  st[12] = ~Aki;  st[13] = Ako;  st[14] = Aku;
+    st[15] = Ama;  st[16] = Ame;  st[17] = ~Ami;  st[18] = Amo;  st[19] = Amu;
+    st[20] = ~Asa; st[21] = Ase;  st[22] = Asi;   st[23] = Aso;  st[24] = Asu;
+}
+
+static void xor_bytes(uint64_t* st, const uint8_t* in, size_t len)
+{
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + 8 <= len; i += 8) {
+        memcpy(&word, in + i, 8);
+        st[i / 8] ^= word;
+    }
+
+    for (; i < len; i++)
+        ((uint8_t*) st)[i] ^= in[i];
+}
+
+void keccak_sponge(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t rate, uint8_t pad)
+{
+    uint64_t st[25] = { 0 };
+    size_t n;
+
+    for (; inlen >= rate; in += rate, inlen -= rate) {
+        xor_bytes(st, in, rate);
+        keccakf1600(st);
+    }
+
+    xor_bytes(st, in, inlen);
+    ((uint8_t*) st)[inlen] ^= pad;
+    ((uint8_t*) st)[rate - 1] ^= 0x80;
+    keccakf1600(st);
+
+    for (;;) {
+        n = outlen < rate ? outlen : rate;
+        memcpy(out, st, n);
+
+        if ((outlen -= n) == 0)
+            break;
+
+        out += n;
+        keccakf1600(st);
+    }
+}
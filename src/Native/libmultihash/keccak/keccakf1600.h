@@ -0,0 +1,47 @@
+#ifndef KECCAKF1600_H
+#define KECCAKF1600_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Keccak-f[1600] and the sponge over it, shared by every Keccak and SHA-3 user in libmultihash
+ * (kezzak, sha3_256/sha3_512, heavyhash, verthash) and by libcryptonote's cn_fast_hash.
+ *
+ * keccakf1600.c is plain C and is compiled into both libraries. keccak_batch.c runs several
+ * independent sponges in lockstep, one per 64-bit SIMD lane; libmultihash builds it once per
+ * instruction set and cpu_dispatch.c picks the variant when the library loads.
+ *
+ * States and messages are little-endian, like every target these libraries are built for.
+ */
+
+/* domain separation byte: original Keccak (Ethereum, CryptoNote, kezzak) and FIPS 202 SHA-3 */
+#define KECCAK_PAD 0x01
+#define SHA3_PAD 0x06
+
+/* rate in bytes of the Keccak/SHA-3 instance with a bits long digest */
+#define KECCAK_RATE(bits) (200 - (bits) / 4)
+
+void keccakf1600(uint64_t st[25]);
+
+/* absorbs in with the given rate and padding byte and squeezes outlen bytes into out */
+void keccak_sponge(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t rate, uint8_t pad);
+
+/*
+ * count sponges over consecutive inputs of inlen bytes each, writing consecutive outlen byte
+ * digests; the same as count calls of keccak_sponge.
+ */
+void keccak_sponge_batch(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count, size_t rate, uint8_t pad);
+
+/* sponges keccak_sponge_batch runs side by side: 1, 4 (AVX2) or 8 (AVX-512) */
+int keccak_batch_ways(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
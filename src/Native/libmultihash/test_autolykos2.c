@@ -0,0 +1,173 @@
+/*
+ * Autolykos v2 golden-vector test and benchmark.
+ *
+ * The vectors were produced by a straight port of the managed ErgoJob share
+ * validation for a synthetic coinbase, as no Ergo share vectors ship with the
+ * tree, and are also checked against the one-call-per-message reference. The benchmark compares the multi-buffer verifier against a
+ * reference that hashes every element message with one blake2b call each.
+ *
+ *   ./test_autolykos2              run the golden vectors
+ *   ./test_autolykos2 --benchmark  report us/share for both implementations
+ */
+
+#include "../native_test.h"
+#include "autolykos2.h"
+#include "blake2/sse/blake2.h"
+
+struct autolykos2_vector
+{
+    uint32_t height;
+    uint32_t n;
+    const char* expected;
+};
+
+/* coinbase = msg[i] = i * 7 + 1 (32 bytes) || nonce 0011223344556677 */
+static const struct autolykos2_vector vectors[] = {
+    { 500000,  67108864,   "6a3b0591e4b7fd9eccf2d2c3c20d73e262e7700d32c0bd9c56456b7e876d91a5" },
+    { 1234567, 126542850,  "127695a908aa5c3728873e467373014f708ccf85ff9a03e88278ed55cc5b417f" },
+    { 9300000, 2147387550, "7515eda361d611766eaca51fe7d043636ac7ec1325c86569192e85809aabfc0c" },
+};
+
+static void fill_coinbase(uint8_t* coinbase)
+{
+    static const uint8_t nonce[8] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77 };
+
+    test_fill(coinbase, 32);
+    memcpy(coinbase + 32, nonce, sizeof(nonce));
+}
+
+static void put_be32(uint8_t* p, uint32_t x)
+{
+    p[0] = (uint8_t) (x >> 24);
+    p[1] = (uint8_t) (x >> 16);
+    p[2] = (uint8_t) (x >> 8);
+    p[3] = (uint8_t) x;
+}
+
+static uint32_t get_be32(const uint8_t* p)
+{
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+
+/* one blake2b call per message, every message fully materialised */
+static void reference_hit(const uint8_t* coinbase, uint32_t len, uint32_t height, uint32_t n, uint8_t hit[32])
+{
+    static uint8_t message[8 + 8192];
+    uint8_t hash[32], seed[31 + 64], indexes[64], sum[32];
+    int i, k;
+
+    for (i = 0; i < 1024; i++) {
+        memset(message + 8 + i * 8, 0, 4);
+        put_be32(message + 8 + i * 8 + 4, (uint32_t) i);
+    }
+
+    put_be32(message + 4, height);
+
+    blake2b(hash, 32, coinbase, len, NULL, 0);
+    put_be32(message, (uint32_t) ((((uint64_t) get_be32(hash + 24) << 32) | get_be32(hash + 28)) % n));
+    blake2b(hash, 32, message, sizeof(message), NULL, 0);
+
+    memcpy(seed, hash + 1, 31);
+    memcpy(seed + 31, coinbase, len);
+    blake2b(indexes, 32, seed, 31 + len, NULL, 0);
+    memcpy(indexes + 32, indexes, 32);
+
+    memset(sum, 0, sizeof(sum));
+
+    for (k = 0; k < 32; k++) {
+        unsigned carry = 0;
+
+        put_be32(message, get_be32(indexes + k) % n);
+        blake2b(hash, 32, message, sizeof(message), NULL, 0);
+
+        for (i = 31; i >= 1; i--) {
+            carry += sum[i] + hash[i];
+            sum[i] = (uint8_t) carry;
+            carry >>= 8;
+        }
+
+        sum[0] = (uint8_t) (sum[0] + carry);
+    }
+
+    blake2b(hit, 32, sum, 32, NULL, 0);
+}
+
+static bool run_vectors(void)
+{
+    uint8_t coinbase[40], hit[32], reference[32], target[32];
+    char name[32];
+    bool ok = true;
+    size_t i;
+
+    fill_coinbase(coinbase);
+    printf("blake2b ways: %d\n", autolykos2_blake2b_ways());
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        const struct autolykos2_vector* v = &vectors[i];
+        int pass_self, pass_above;
+
+        /* the hit does not meet a target equal to itself, but meets that target plus one */
+        memset(target, 0, sizeof(target));
+        autolykos2_verify(coinbase, sizeof(coinbase), v->height, v->n, target, hit);
+        memcpy(target, hit, sizeof(target));
+        pass_self = autolykos2_verify(coinbase, sizeof(coinbase), v->height, v->n, target, hit);
+        target[31]++;
+        pass_above = autolykos2_verify(coinbase, sizeof(coinbase), v->height, v->n, target, hit);
+
+        reference_hit(coinbase, sizeof(coinbase), v->height, v->n, reference);
+
+        snprintf(name, sizeof(name), "height %u", v->height);
+        ok &= test_check_hex(name, hit, sizeof(hit), v->expected);
+
+        snprintf(name, sizeof(name), "height %u reference", v->height);
+        ok &= test_check(name, memcmp(hit, reference, 32) == 0);
+
+        snprintf(name, sizeof(name), "height %u target", v->height);
+        ok &= pass_self == 0 && pass_above == 1 ? test_pass(name) :
+            test_fail(name, "expected target checks 0 1, got %d %d", pass_self, pass_above);
+    }
+
+    return test_summary("Autolykos2", ok);
+}
+
+static void run_benchmark(void)
+{
+    const int iterations = 2000;
+    uint8_t coinbase[40], hit[32], target[32];
+    double start, us, batched;
+    int i;
+
+    fill_coinbase(coinbase);
+    memset(target, 0xff, sizeof(target));
+
+    start = test_now_ns();
+
+    for (i = 0; i < iterations; i++) {
+        coinbase[39] = (uint8_t) i;
+        reference_hit(coinbase, sizeof(coinbase), 1234567, 126542850, hit);
+    }
+
+    us = (test_now_ns() - start) / 1e3 / iterations;
+    printf("autolykos2 reference:    %8.2f us/share\n", us);
+
+    start = test_now_ns();
+
+    for (i = 0; i < iterations; i++) {
+        coinbase[39] = (uint8_t) i;
+        autolykos2_verify(coinbase, sizeof(coinbase), 1234567, 126542850, target, hit);
+    }
+
+    batched = (test_now_ns() - start) / 1e3 / iterations;
+    printf("autolykos2 %d-way:        %8.2f us/share (%.2fx)\n", autolykos2_blake2b_ways(), batched, us / batched);
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_vectors())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * CPU dispatch test and benchmark.
+ *
+ * Every instruction set variant linked into libmultihash that this CPU can run is
+ * checked against known answers (the RFC 7693 BLAKE2 "abc" vectors and a
+ * test_autolykos2 hit), so a variant the dispatcher would only pick on a
+ * different host is still exercised here.
+ *
+ *   ./test_cpu_dispatch              check the variants and print the selection
+ *   ./test_cpu_dispatch --benchmark  report ns per 80 byte blake2b/blake2s call per variant
+ */
+
+#include "../native_test.h"
+#include "cpu_dispatch.h"
+#include "autolykos2.h"
+#include "blake2/sse/blake2.h"
+
+typedef int (*blake2_fn)(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen);
+typedef int (*autolykos2_verify_fn)(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n,
+    const uint8_t target[32], uint8_t hit[32]);
+
+#define BLAKE2_VARIANT(isa) \
+    int blake2b_##isa(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen); \
+    int blake2s_##isa(void* out, size_t outlen, const void* in, size_t inlen, const void* key, size_t keylen);
+
+#define AUTOLYKOS2_VARIANT(isa) \
+    int autolykos2_verify_##isa(const uint8_t* coinbase, uint32_t coinbase_len, uint32_t height, uint32_t n, \
+        const uint8_t target[32], uint8_t hit[32]);
+
+BLAKE2_VARIANT(sse2)
+BLAKE2_VARIANT(sse41)
+BLAKE2_VARIANT(avx)
+
+AUTOLYKOS2_VARIANT(baseline)
+AUTOLYKOS2_VARIANT(avx2)
+AUTOLYKOS2_VARIANT(avx512)
+
+static const struct
+{
+    const char* name;
+    isa_level level;
+    blake2_fn blake2b;
+    blake2_fn blake2s;
+} blake2_variants[] = {
+    { "sse2", ISA_BASELINE, blake2b_sse2, blake2s_sse2 },
+    { "sse41", ISA_SSE41, blake2b_sse41, blake2s_sse41 },
+    { "avx", ISA_AVX, blake2b_avx, blake2s_avx },
+};
+
+static const struct
+{
+    const char* name;
+    isa_level level;
+    autolykos2_verify_fn verify;
+} autolykos2_variants[] = {
+    { "baseline", ISA_BASELINE, autolykos2_verify_baseline },
+    { "avx2", ISA_AVX2, autolykos2_verify_avx2 },
+    { "avx512", ISA_AVX512, autolykos2_verify_avx512 },
+};
+
+#define COUNT(x) (sizeof(x) / sizeof(x[0]))
+
+static const char blake2b_abc[] =
+    "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+    "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923";
+static const char blake2s_abc[] = "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982";
+
+/* test_autolykos2 vector for height 1234567 */
+static const char autolykos2_hit[] = "127695a908aa5c3728873e467373014f708ccf85ff9a03e88278ed55cc5b417f";
+
+static bool check(const char* kernel, const char* variant, const char* expected, const uint8_t* out, size_t len)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s %s", kernel, variant);
+    return test_check_hex(name, out, len, expected);
+}
+
+static bool run_checks(void)
+{
+    const isa_level level = cpu_isa_level();
+    uint8_t out[64], coinbase[40], target[32];
+    bool ok = true;
+    size_t i;
+
+    printf("cpu: %s\n", isa_level_name(level));
+    printf("selected: %s\n", cpu_dispatch_report());
+
+    for (i = 0; i < COUNT(blake2_variants); i++) {
+        if (blake2_variants[i].level > level)
+            continue;
+
+        blake2_variants[i].blake2b(out, 64, "abc", 3, NULL, 0);
+        ok &= check("blake2b", blake2_variants[i].name, blake2b_abc, out, 64);
+
+        blake2_variants[i].blake2s(out, 32, "abc", 3, NULL, 0);
+        ok &= check("blake2s", blake2_variants[i].name, blake2s_abc, out, 32);
+    }
+
+    test_fill(coinbase, 32);
+
+    for (i = 0; i < 8; i++)
+        coinbase[32 + i] = (uint8_t) (i * 0x11);
+
+    memset(target, 0xff, sizeof(target));
+
+    for (i = 0; i < COUNT(autolykos2_variants); i++) {
+        if (autolykos2_variants[i].level > level)
+            continue;
+
+        autolykos2_variants[i].verify(coinbase, sizeof(coinbase), 1234567, 126542850, target, out);
+        ok &= check("autolykos2", autolykos2_variants[i].name, autolykos2_hit, out, 32);
+    }
+
+    blake2b(out, 64, "abc", 3, NULL, 0);
+    ok &= check("blake2b", "dispatched", blake2b_abc, out, 64);
+
+    return test_summary("dispatch", ok);
+}
+
+static void run_benchmark(void)
+{
+    const int iterations = 1000000;
+    const isa_level level = cpu_isa_level();
+    uint8_t input[80] = { 0 }, out[32];
+    size_t i;
+    int k;
+
+    for (i = 0; i < COUNT(blake2_variants); i++) {
+        double start, b, s;
+
+        if (blake2_variants[i].level > level)
+            continue;
+
+        start = test_now_ns();
+
+        for (k = 0; k < iterations; k++) {
+            input[0] = (uint8_t) k;
+            blake2_variants[i].blake2b(out, 32, input, sizeof(input), NULL, 0);
+        }
+
+        b = (test_now_ns() - start) / iterations;
+        start = test_now_ns();
+
+        for (k = 0; k < iterations; k++) {
+            input[0] = (uint8_t) k;
+            blake2_variants[i].blake2s(out, 32, input, sizeof(input), NULL, 0);
+        }
+
+        s = (test_now_ns() - start) / iterations;
+        printf("blake2 %-6s blake2b %6.1f ns  blake2s %6.1f ns\n", blake2_variants[i].name, b, s);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_checks())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
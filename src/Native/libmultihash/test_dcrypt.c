@@ -0,0 +1,119 @@
+/*
+ * Dcrypt golden-vector test and benchmark.
+ *
+ * The vectors were produced by the original heap-based dcrypt implementation and
+ * pin the optimized version to bit-identical output (including the non-standard
+ * SHA-256 padding lengths 55..64).
+ *
+ *   ./test_dcrypt              run the golden vectors
+ *   ./test_dcrypt --benchmark  report ns/hash and heap usage during hashing
+ */
+
+#include <malloc.h>
+
+#include "../native_test.h"
+#include "dcrypt.h"
+
+struct dcrypt_vector
+{
+    uint32_t len;
+    const char* expected;
+};
+
+/* input[i] = i * 7 + 1 */
+static const struct dcrypt_vector vectors[] = {
+    { 0,   "9ff26acd44e03533de1b230d8ad1da5e9ec26861489243373555d09453ea5e6d" },
+    { 1,   "36347eb6f00926f1a4af9e8146948ee5ec739f6c635577681dbf8f63f5e96496" },
+    { 43,  "9a6d4415745e02724f492fd50d7a5cbe5f9b74f8cee4aa4c40e51a79cf450279" },
+    { 55,  "1a2133cfc859c9f132712c80b69b2a21f8c50f118bb8c68d04a30f3d23698bf6" },
+    { 56,  "d35d3a539591d4455b6f5cd73b3d3b3c389d360af8af0592f87c2fa21948d5d8" },
+    { 60,  "9ed0cb834e1b024cb2f62b8844269d92f1de482279f7731d15fe696ff287207a" },
+    { 63,  "41227685bddf420597d6c8798f0a958491f73c25b4a19e01610fe1b5a26c4786" },
+    { 64,  "37d7faf7c272fd9f3dcdf31de86fc2fd035c6ac6ac7fb8c2f25c0e8b80a949c6" },
+    { 80,  "1eb8a8dc0273a127a117b74b4e72a86288c808690c690bd5b20103f9871fd68d" },
+    { 119, "7a65f775e74ac3e8956223476ba78b3b4a1ddc0a456ae0d4de8f3f7f9ac3c665" },
+    { 128, "773d514d982e04cc739f43ccad39a4b5940977fb66e49a76f6ea81e8dfb10bb5" },
+    { 200, "2beca72939c5801195c347722b9bf2427605ca362df457a8a5f581715bec6d21" },
+};
+
+static const char fox[] = "The quick brown fox jumps over the lazy dog";
+static const char fox_expected[] = "a74369ea2f6434aa55e38820d35300ba6130d82e0121ef64de6218c9198a377d";
+
+/* dcrypt emits one nibble per output byte; they are packed high nibble first for the comparison */
+static bool check(const char* name, const uint8_t* input, uint32_t len, const char* expected)
+{
+    char nibbles[64];
+    uint8_t hash[32];
+    int i;
+
+    dcrypt_hash((const char*) input, nibbles, len);
+
+    for (i = 0; i < 32; i++)
+        hash[i] = (uint8_t) ((nibbles[i * 2] & 0xf) << 4 | (nibbles[i * 2 + 1] & 0xf));
+
+    return test_check_hex(name, hash, sizeof(hash), expected);
+}
+
+static bool run_vectors(void)
+{
+    uint8_t input[256];
+    char name[32];
+    size_t i;
+    bool ok = true;
+
+    test_fill(input, sizeof(input));
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        snprintf(name, sizeof(name), "len %u", vectors[i].len);
+        ok &= check(name, input, vectors[i].len, vectors[i].expected);
+    }
+
+    ok &= check("fox", (const uint8_t*) fox, (uint32_t) strlen(fox), fox_expected);
+
+    return test_summary("dcrypt", ok);
+}
+
+static void run_benchmark(void)
+{
+    const int iterations = 1000;
+    uint8_t input[80];
+    char hash[64];
+    double start, elapsed;
+    int i;
+
+    test_fill(input, sizeof(input));
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 before = mallinfo2();
+#endif
+
+    start = test_now_ns();
+
+    for (i = 0; i < iterations; i++) {
+        input[76] = (uint8_t) i;
+        input[77] = (uint8_t) (i >> 8);
+        dcrypt_hash((const char*) input, hash, sizeof(input));
+    }
+
+    elapsed = test_now_ns() - start;
+
+    printf("dcrypt: %d hashes of 80 bytes, %.0f ns/hash, %.0f hashes/sec\n",
+        iterations, elapsed / iterations, iterations / (elapsed / 1e9));
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 after = mallinfo2();
+    printf("dcrypt: heap in use grew by %zu bytes, arena grew by %zu bytes\n",
+        after.uordblks - before.uordblks, after.arena - before.arena);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_vectors())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Share difficulty golden-vector test and benchmark.
+ *
+ * Expected quotients were produced with Python's Fraction -> float conversion,
+ * which rounds exactly once; the vectors include ties in both directions and the
+ * hashes of Bitcoin blocks 0 and 100000 against the Bitcoin diff1.
+ *
+ *   ./test_difficulty              run the golden vectors
+ *   ./test_difficulty --benchmark  report ns per share_difficulty call
+ */
+
+#include <stdlib.h>
+
+#include "../native_test.h"
+#include "difficulty.h"
+
+struct difficulty_vector
+{
+    const char* diff1;      /* big-endian hex */
+    const char* hash;       /* big-endian hex */
+    const char* expected;   /* hex float */
+};
+
+static const struct difficulty_vector vectors[] = {
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "00000000ffff0000000000000000000000000000000000000000000000000000", "0x1.0000000000000p+0" },
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "000000007fff8000000000000000000000000000000000000000000000000000", "0x1.0000000000000p+1" },
+    { "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "0000000000000000000000000000000000000000000000000000000000000001", "0x1.0000000000000p+256" },
+    { "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "0x1.0000000000000p+0" },
+    { "0000000000000000000000000000000000000000000000000040000000000002", "0000000000000000000000000000000000000000000000000000000000000001", "0x1.0000000000000p+54" },
+    { "0000000000000000000000000000000000000000000000000040000000000006", "0000000000000000000000000000000000000000000000000000000000000001", "0x1.0000000000002p+54" },
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "00000000000404cb000000000000000000000000000000000000000000000000", "0x1.fd9b5e1504511p+13" },
+    { "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "00e39dd6e9a5cd87c19d4f8ee0ad0ab1f4a4fd4fb7c4df18c1c79a1e83c4a700", "0x1.1fec3d5b77ad9p+8" },
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "d23f0824128b2f330c5c7fd0a6a3a4506513270e269e0d37f2a74de452e6b438", "0x1.37b4ba0a8a7b7p-32" },
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "0000000000000081e8e25d940ed904759531985d5d9dc9f81818e811892f902b", "0x1.f8773d4319dc1p+24" },
+    { "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", "000000000000000000000000000000016f03675a1600a35a099950d836f675cc", "0x1.6521a867cd6d6p+127" },
+    { "0000000000000000000000000000000000000000000000000000000000000003", "0000000000000000000000000000000000000000000000000000000000000007", "0x1.b6db6db6db6dbp-2" },
+    /* Bitcoin blocks 0 and 100000 */
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "000000000019d6689c085ae165831e934ff763ae46a2a6c172b3f1b60a8ce26f", "0x1.3d0da43ca31e3p+11" },
+    { "00000000ffff0000000000000000000000000000000000000000000000000000", "000000000003ba27aa200b1cecaad478d2b00432346c3f1f3986da1afd33e506", "0x1.12bc39a06d2c2p+14" },
+};
+
+/* big-endian hex to the little-endian byte order used for hashes */
+static void from_hex_le(const char* hex, uint8_t out[32])
+{
+    int i;
+
+    test_from_hex(hex, out, 32);
+
+    for (i = 0; i < 16; i++) {
+        const uint8_t b = out[i];
+        out[i] = out[31 - i];
+        out[31 - i] = b;
+    }
+}
+
+static bool run_vectors(void)
+{
+    uint8_t diff1[32], hash[32];
+    char name[32];
+    bool ok = true;
+    size_t i;
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        const double expected = strtod(vectors[i].expected, NULL);
+        double result;
+
+        from_hex_le(vectors[i].diff1, diff1);
+        from_hex_le(vectors[i].hash, hash);
+        result = share_difficulty(hash, diff1);
+
+        snprintf(name, sizeof(name), "vector %zu", i);
+        ok &= result == expected ? test_pass(name) : test_fail(name, "expected %a\n  got      %a", expected, result);
+    }
+
+    /* a hash meets a target equal to itself but not one below it */
+    from_hex_le(vectors[8].hash, hash);
+    memcpy(diff1, hash, sizeof(diff1));
+
+    ok &= test_check("hash_meets_target", hash_meets_target(hash, diff1) && (diff1[0]--, !hash_meets_target(hash, diff1)));
+
+    memset(hash, 0, sizeof(hash));
+    ok &= test_check("zero hash", share_difficulty(hash, diff1) > 1e300);
+
+    return test_summary("difficulty", ok);
+}
+
+static void run_benchmark(void)
+{
+    const int iterations = 1000000;
+    uint8_t diff1[32], hash[32];
+    double start, sum = 0;
+    int i;
+
+    from_hex_le(vectors[0].diff1, diff1);
+    from_hex_le(vectors[9].hash, hash);
+
+    start = test_now_ns();
+
+    for (i = 0; i < iterations; i++) {
+        hash[0] = (uint8_t) i;
+        sum += share_difficulty(hash, diff1);
+    }
+
+    printf("share_difficulty: %.1f ns/call (checksum %g)\n", (test_now_ns() - start) / iterations, sum);
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_vectors())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * Keccak-f[1600] test and benchmark.
+ *
+ * The lane-complementing permutation is checked against a plain round-by-round one and the
+ * sponge against published SHA-3 and Keccak-256 digests. Every multi-buffer variant the CPU can
+ * run is compared with the scalar sponge over batch sizes that leave a remainder and inputs on
+ * both sides of the rate.
+ *
+ *   ./test_keccak              run the checks
+ *   ./test_keccak --benchmark  report ns per 80 byte Keccak-256, scalar and per batch variant
+ */
+
+#include "../native_test.h"
+#include "cpu_dispatch.h"
+#include "keccak/keccakf1600.h"
+
+typedef void (*sponge_batch_fn)(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count,
+    size_t rate, uint8_t pad);
+
+#define KECCAK_VARIANT(isa) \
+    void keccak_sponge_batch_##isa(uint8_t* out, size_t outlen, const uint8_t* in, size_t inlen, size_t count, \
+        size_t rate, uint8_t pad);
+
+KECCAK_VARIANT(baseline)
+KECCAK_VARIANT(avx2)
+KECCAK_VARIANT(avx512)
+
+static const struct
+{
+    const char* name;
+    isa_level level;
+    sponge_batch_fn batch;
+} variants[] = {
+    { "baseline", ISA_BASELINE, keccak_sponge_batch_baseline },
+    { "avx2", ISA_AVX2, keccak_sponge_batch_avx2 },
+    { "avx512", ISA_AVX512, keccak_sponge_batch_avx512 },
+};
+
+#define COUNT(x) (sizeof(x) / sizeof(x[0]))
+
+static const struct
+{
+    const char* name;
+    const char* input;
+    size_t bits;
+    uint8_t pad;
+    const char* digest;
+} vectors[] = {
+    { "sha3-256", "", 256, SHA3_PAD, "a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a" },
+    { "sha3-256", "abc", 256, SHA3_PAD, "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532" },
+    { "sha3-512", "abc", 512, SHA3_PAD,
+        "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e"
+        "10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0" },
+    { "keccak-256", "", 256, KECCAK_PAD, "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470" },
+    { "keccak-256", "abc", 256, KECCAK_PAD, "4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45" },
+};
+
+static const uint64_t round_constants[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+static const int rotations[24] = { 1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44 };
+static const int lanes[24] = { 10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1 };
+
+#define ROL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+/* the specification's round structure, one step at a time */
+static void reference_keccakf1600(uint64_t st[25])
+{
+    uint64_t bc[5], t;
+    int round, i, j;
+
+    for (round = 0; round < 24; round++) {
+        for (i = 0; i < 5; i++)
+            bc[i] = st[i] ^ st[i + 5] ^ st[i + 10] ^ st[i + 15] ^ st[i + 20];
+
+        for (i = 0; i < 5; i++) {
+            t = bc[(i + 4) % 5] ^ ROL64(bc[(i + 1) % 5], 1);
+            for (j = 0; j < 25; j += 5)
+                st[j + i] ^= t;
+        }
+
+        t = st[1];
+        for (i = 0; i < 24; i++) {
+            j = lanes[i];
+            bc[0] = st[j];
+            st[j] = ROL64(t, rotations[i]);
+            t = bc[0];
+        }
+
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++)
+                bc[i] = st[j + i];
+            for (i = 0; i < 5; i++)
+                st[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+        }
+
+        st[0] ^= round_constants[round];
+    }
+}
+
+static bool check_permutation(void)
+{
+    uint64_t a[25], b[25];
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    int i, n;
+
+    for (n = 0; n < 100; n++) {
+        for (i = 0; i < 25; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            a[i] = b[i] = n == 0 ? 0 : x;
+        }
+
+        keccakf1600(a);
+        reference_keccakf1600(b);
+
+        if (memcmp(a, b, sizeof(a)) != 0)
+            return test_fail("keccakf1600", "state %d", n);
+    }
+
+    return test_pass("keccakf1600");
+}
+
+static bool check_vectors(void)
+{
+    uint8_t out[64];
+    char name[32];
+    bool ok = true;
+    size_t i;
+
+    for (i = 0; i < COUNT(vectors); i++) {
+        keccak_sponge(out, vectors[i].bits / 8, (const uint8_t*) vectors[i].input, strlen(vectors[i].input),
+            KECCAK_RATE(vectors[i].bits), vectors[i].pad);
+
+        snprintf(name, sizeof(name), "%s(\"%s\")", vectors[i].name, vectors[i].input);
+        ok &= test_check_hex(name, out, vectors[i].bits / 8, vectors[i].digest);
+    }
+
+    return ok;
+}
+
+/* batch against scalar for rate 136 (Keccak-256), 72 (SHA3-512) and a 200 byte squeeze at rate 168 */
+static bool check_batch(const char* variant, sponge_batch_fn batch)
+{
+    static const size_t lengths[] = { 0, 1, 71, 72, 80, 135, 136, 137, 300 };
+    static const size_t counts[] = { 1, 3, 4, 8, 13, 17 };
+    static const struct { size_t rate, outlen; } shapes[] = { { 136, 32 }, { 72, 64 }, { 168, 200 } };
+    static uint8_t in[17 * 300], out[17 * 200], expected[17 * 200];
+    char name[64];
+    size_t l, c, s, i;
+
+    snprintf(name, sizeof(name), "keccak batch %s", variant);
+
+    for (i = 0; i < sizeof(in); i++)
+        in[i] = (uint8_t) (i * 131 + 7);
+
+    for (s = 0; s < COUNT(shapes); s++) {
+        for (l = 0; l < COUNT(lengths); l++) {
+            for (c = 0; c < COUNT(counts); c++) {
+                const size_t rate = shapes[s].rate, outlen = shapes[s].outlen, len = lengths[l], count = counts[c];
+
+                for (i = 0; i < count; i++)
+                    keccak_sponge(expected + i * outlen, outlen, in + i * len, len, rate, KECCAK_PAD);
+
+                memset(out, 0, sizeof(out));
+                batch(out, outlen, in, len, count, rate, KECCAK_PAD);
+
+                if (memcmp(out, expected, count * outlen) != 0)
+                    return test_fail(name, "rate %zu length %zu count %zu", rate, len, count);
+            }
+        }
+    }
+
+    return test_pass(name);
+}
+
+static bool run_checks(void)
+{
+    const isa_level level = cpu_isa_level();
+    bool ok = true;
+    size_t i;
+
+    ok &= check_permutation();
+    ok &= check_vectors();
+
+    for (i = 0; i < COUNT(variants); i++) {
+        if (variants[i].level <= level)
+            ok &= check_batch(variants[i].name, variants[i].batch);
+    }
+
+    ok &= check_batch("dispatched", keccak_sponge_batch);
+
+    return test_summary("Keccak", ok);
+}
+
+static void run_benchmark(void)
+{
+    const int iterations = 1000000;
+    const int batch = 64;
+    const isa_level level = cpu_isa_level();
+    static uint8_t inputs[64 * 80], outputs[64 * 32];
+    double start;
+    size_t i;
+    int k;
+
+    start = test_now_ns();
+
+    for (k = 0; k < iterations; k++) {
+        inputs[0] = (uint8_t) k;
+        keccak_sponge(outputs, 32, inputs, 80, KECCAK_RATE(256), KECCAK_PAD);
+    }
+
+    printf("keccak-256 scalar   %6.1f ns\n", (test_now_ns() - start) / iterations);
+
+    for (i = 0; i < COUNT(variants); i++) {
+        if (variants[i].level > level)
+            continue;
+
+        start = test_now_ns();
+
+        for (k = 0; k < iterations / batch; k++) {
+            inputs[0] = (uint8_t) k;
+            variants[i].batch(outputs, 32, inputs, 80, batch, KECCAK_RATE(256), KECCAK_PAD);
+        }
+
+        printf("keccak-256 %-8s %6.1f ns per hash in batches of %d\n", variants[i].name,
+            (test_now_ns() - start) / ((iterations / batch) * batch), batch);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (!run_checks())
+        return 1;
+
+    if (test_benchmark_requested(argc, argv))
+        run_benchmark();
+
+    return 0;
+}
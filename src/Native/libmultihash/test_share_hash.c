@@ -0,0 +1,171 @@
+/*
+ * share_hash_batch_export test and benchmark.
+ *
+ * Shares are hashed into a buffer of exactly count * 32 bytes followed by a guard region, which
+ * must be left untouched; the hashes and difficulties must match those of the single-hash exports.
+ * dcrypt's 64 output nibbles are packed into 32 bytes, high nibble first.
+ *
+ *   ./test_share_hash              run the checks
+ *   ./test_share_hash --benchmark  report ns per share for dcrypt and sha3-256
+ */
+
+#include <dlfcn.h>
+
+#include "../native_test.h"
+#include "dcrypt.h"
+#include "difficulty.h"
+
+/* loaded lazily like the managed side does, as the library leaves a few equihash helpers unresolved */
+static bool (*share_hash_batch_export)(const char* algorithm, const unsigned char* inputs, uint32_t input_len, uint32_t count,
+    const unsigned char* diff1, const unsigned char* target, unsigned char* hashes, double* difficulties, unsigned char* meets_target);
+static void (*sha3_256_export)(const char* input, char* output, uint32_t input_len);
+
+#define COUNT 4
+#define INPUT_LEN 80
+#define GUARD 64
+#define GUARD_BYTE 0xa5
+
+/* input 1 is the 80 byte golden vector of test_dcrypt.c */
+static const char dcrypt_expected[] = "1eb8a8dc0273a127a117b74b4e72a86288c808690c690bd5b20103f9871fd68d";
+
+static unsigned char inputs[COUNT * INPUT_LEN];
+static unsigned char diff1[32];
+static unsigned char target[32];
+
+/* input j is input[i] = i * 7 + 1, with byte 0 replaced by j */
+static void fill_inputs(void)
+{
+    uint32_t j;
+
+    for (j = 0; j < COUNT; j++) {
+        test_fill(inputs + j * INPUT_LEN, INPUT_LEN);
+        inputs[j * INPUT_LEN] = (unsigned char) j;
+    }
+
+    /* 00000000ffff0000... as little-endian */
+    memset(diff1, 0, sizeof(diff1));
+    diff1[26] = 0xff;
+    diff1[27] = 0xff;
+    memset(target, 0xff, sizeof(target));
+}
+
+static bool guard_intact(const unsigned char* guard)
+{
+    int i;
+
+    for (i = 0; i < GUARD; i++) {
+        if (guard[i] != GUARD_BYTE)
+            return false;
+    }
+
+    return true;
+}
+
+/* hashes must be what hash_one produces for each input, with matching difficulties */
+static bool check(const char* algorithm, void (*hash_one)(const unsigned char* input, unsigned char* output))
+{
+    unsigned char hashes[COUNT * 32 + GUARD];
+    unsigned char expected[32];
+    double difficulties[COUNT];
+    unsigned char meets_target[COUNT];
+    bool ok = true;
+    int j;
+
+    memset(hashes, GUARD_BYTE, sizeof(hashes));
+
+    if (!share_hash_batch_export(algorithm, inputs, INPUT_LEN, COUNT, diff1, target, hashes, difficulties, meets_target))
+        return test_fail(algorithm, "not a share hash");
+
+    if (!guard_intact(hashes + COUNT * 32))
+        ok = test_fail(algorithm, "wrote past count * 32 bytes");
+
+    for (j = 0; j < COUNT; j++) {
+        hash_one(inputs + j * INPUT_LEN, expected);
+
+        if (memcmp(hashes + j * 32, expected, 32) != 0)
+            ok = test_fail(algorithm, "hash %d", j);
+
+        if (difficulties[j] != share_difficulty(expected, diff1) || meets_target[j] != 1)
+            ok = test_fail(algorithm, "difficulty %d", j);
+    }
+
+    return ok ? test_pass(algorithm) : false;
+}
+
+static void dcrypt_packed(const unsigned char* input, unsigned char* output)
+{
+    char nibbles[64];
+    int i;
+
+    dcrypt_hash((const char*) input, nibbles, INPUT_LEN);
+
+    for (i = 0; i < 32; i++)
+        output[i] = (unsigned char) ((nibbles[i * 2] << 4) | nibbles[i * 2 + 1]);
+}
+
+static bool check_dcrypt_vector(void)
+{
+    unsigned char hash[32];
+
+    dcrypt_packed(inputs + INPUT_LEN, hash);
+    return test_check_hex("dcrypt packing", hash, sizeof(hash), dcrypt_expected);
+}
+
+static void sha3_256(const unsigned char* input, unsigned char* output)
+{
+    sha3_256_export((const char*) input, (char*) output, INPUT_LEN);
+}
+
+static void run_benchmark(const char* algorithm, int iterations)
+{
+    unsigned char hashes[COUNT * 32];
+    double difficulties[COUNT];
+    unsigned char meets_target[COUNT];
+    double start, elapsed;
+    int i;
+
+    start = test_now_ns();
+
+    for (i = 0; i < iterations; i++)
+        share_hash_batch_export(algorithm, inputs, INPUT_LEN, COUNT, diff1, target, hashes, difficulties, meets_target);
+
+    elapsed = test_now_ns() - start;
+
+    printf("share_hash %-10s %10.0f ns/share\n", algorithm, elapsed / ((double) iterations * COUNT));
+}
+
+int main(int argc, char** argv)
+{
+    bool ok = true;
+    void* library = dlopen("./libmultihash.so", RTLD_LAZY | RTLD_LOCAL);
+
+    if (!library) {
+        printf("FAIL %s\n", dlerror());
+        return 1;
+    }
+
+    *(void**) &share_hash_batch_export = dlsym(library, "share_hash_batch_export");
+    *(void**) &sha3_256_export = dlsym(library, "sha3_256_export");
+
+    if (!share_hash_batch_export || !sha3_256_export) {
+        printf("FAIL missing exports\n");
+        return 1;
+    }
+
+    fill_inputs();
+
+    ok &= check_dcrypt_vector();
+    ok &= check("dcrypt", dcrypt_packed);
+    ok &= check("sha3-256", sha3_256);
+    ok &= test_check("unknown algorithm rejected",
+        !share_hash_batch_export("no-such-algorithm", inputs, INPUT_LEN, COUNT, diff1, target, NULL, NULL, NULL));
+
+    test_summary("share hash", ok);
+
+    if (ok && test_benchmark_requested(argc, argv)) {
+        run_benchmark("dcrypt", 250);
+        run_benchmark("sha3-256", 100000);
+    }
+
+    return ok ? 0 : 1;
+}
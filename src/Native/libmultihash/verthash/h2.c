@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "tiny_sha3/sha3.h"
+#include "../keccak/keccakf1600.h"
 
 #ifdef _MSC_VER
 #include <malloc.h>
@@ -487,19 +488,20 @@ int verthash(const unsigned char* input, const size_t input_size, unsigned char*
 
     unsigned char p0[N_SUBSET];
 
+    // the N_ITER headers differ only in their first byte; their SHA3-512s run as one batch
 #ifndef _MSC_VER
-    unsigned char input_header[input_size];
+    unsigned char input_headers[N_ITER * input_size];
 #else
-    unsigned char* input_header = _alloca(input_size);
+    unsigned char* input_headers = _alloca(N_ITER * input_size);
 #endif // !MSVC
 
-    memcpy(input_header, input, input_size);
-
     for(size_t i = 0; i < N_ITER; i++) {
-    	input_header[0] += 1;
-    	sha3(&input_header[0], input_size, p0+i*P0_SIZE, P0_SIZE);
+    	memcpy(input_headers + i * input_size, input, input_size);
+    	input_headers[i * input_size] += (unsigned char) (i + 1);
     }
 
+    keccak_sponge_batch(p0, P0_SIZE, input_headers, input_size, N_ITER, 200 - 2 * P0_SIZE, SHA3_PAD);
+
     uint32_t* p0_index = (uint32_t*)p0;
     uint32_t seek_indexes[N_INDEXES];
 
@@ -0,0 +1,521 @@
+/*
+ * Shared RandomX caches, datasets and VM pools per (realm, seed).
+ *
+ * Before this every managed VM allocated its own cache, and in full-memory mode its own 2 GB
+ * dataset, initialized on one thread. Here a seed is prepared once: the cache, then the dataset
+ * split into one slice per init thread, then the VMs, all of which point at the same dataset.
+ *
+ * The next seed can be prepared ahead of its activation height on low-priority threads, while the
+ * current one keeps hashing. Activation then swaps the realm's current seed in one step, without
+ * a validation stall. Seeds are reference counted: a hash holds its seed for the duration of the
+ * call, so the seed retired by a switch stays alive until the hashes running on it return.
+ *
+ * rx_hash looks the seed up under the realms lock on every call. Callers hashing many shares on
+ * one seed open an rx_seed_handle once instead and hash on it without any lookup.
+ */
+
+#include "rx_realm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct rx_seed
+{
+    randomx_cache* cache = nullptr;
+    randomx_dataset* dataset = nullptr;
+    std::vector<randomx_vm*> vms;
+    std::unique_ptr<std::atomic<bool>[]> busy;
+
+    ~rx_seed()
+    {
+        for (randomx_vm* vm : vms)
+            randomx_destroy_vm(vm);
+
+        if (dataset != nullptr)
+            randomx_release_dataset(dataset);
+
+        if (cache != nullptr)
+            randomx_release_cache(cache);
+    }
+
+    // claims an idle VM; sleeps while all of them are hashing
+    size_t acquire()
+    {
+        static thread_local size_t hint = 0;
+        size_t i;
+
+        while (!try_acquire(hint, i)) {
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            waiters++;
+            idle.wait(lock, [this]() { return any_idle(); });
+            waiters--;
+        }
+
+        hint = i;
+        return i;
+    }
+
+    void release(size_t i)
+    {
+        busy[i].store(false);
+
+        // a thread that found every VM busy is told under the lock, so it can't miss this one
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            idle.notify_one();
+        }
+    }
+
+private:
+    std::mutex idle_mutex;
+    std::condition_variable idle;
+    std::atomic<uint32_t> waiters{ 0 };
+
+    bool try_acquire(size_t hint, size_t& claimed)
+    {
+        for (size_t n = 0; n < vms.size(); n++) {
+            const size_t i = (hint + n) % vms.size();
+
+            if (!busy[i].load(std::memory_order_relaxed) && !busy[i].exchange(true, std::memory_order_acquire)) {
+                claimed = i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool any_idle() const
+    {
+        for (size_t i = 0; i < vms.size(); i++) {
+            if (!busy[i].load())
+                return true;
+        }
+
+        return false;
+    }
+};
+
+typedef std::shared_future<std::shared_ptr<rx_seed>> seed_future;
+
+struct pending_seed
+{
+    seed_future future;
+    const void* owner;                              // the preparation's promise, told apart from a later one
+};
+
+struct rx_realm
+{
+    std::map<std::string, std::shared_ptr<rx_seed>> seeds;
+    std::map<std::string, pending_seed> pending;    // seeds being prepared
+    std::string current;                            // seed activated last
+};
+
+std::mutex realms_mutex;                            // guards realms, held only for lookups and swaps
+std::map<std::string, rx_realm> realms;
+
+// background preparation must not slow down share validation on the current seed
+void lower_priority()
+{
+#ifdef __linux__
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+}
+
+uint32_t thread_count(int32_t requested)
+{
+    return requested > 0 ? static_cast<uint32_t>(requested) : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// large pages are a preference; retry without them when none are available
+randomx_cache* alloc_cache(randomx_flags flags)
+{
+    randomx_cache* cache = randomx_alloc_cache(flags);
+
+    if (cache == nullptr && (flags & RANDOMX_FLAG_LARGE_PAGES))
+        cache = randomx_alloc_cache(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES));
+
+    return cache;
+}
+
+randomx_dataset* alloc_dataset(randomx_flags flags)
+{
+    randomx_dataset* dataset = randomx_alloc_dataset(flags);
+
+    if (dataset == nullptr && (flags & RANDOMX_FLAG_LARGE_PAGES))
+        dataset = randomx_alloc_dataset(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES));
+
+    return dataset;
+}
+
+randomx_vm* create_vm(randomx_flags flags, randomx_cache* cache, randomx_dataset* dataset)
+{
+    randomx_vm* vm = randomx_create_vm(flags, cache, dataset);
+
+    if (vm == nullptr && (flags & RANDOMX_FLAG_LARGE_PAGES))
+        vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES), cache, dataset);
+
+    return vm;
+}
+
+void init_dataset(randomx_dataset* dataset, randomx_cache* cache, uint32_t threads, bool background)
+{
+    const unsigned long items = randomx_dataset_item_count();
+    std::vector<std::thread> workers;
+
+    for (uint32_t t = 1; t < threads; t++) {
+        const unsigned long start = items * t / threads;
+        const unsigned long end = items * (t + 1) / threads;
+
+        workers.emplace_back([=]() {
+            if (background)
+                lower_priority();
+
+            randomx_init_dataset(dataset, cache, start, end - start);
+        });
+    }
+
+    randomx_init_dataset(dataset, cache, 0, items / threads);
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+std::shared_ptr<rx_seed> build_seed(const std::string& key, randomx_flags flags, uint32_t vm_count, uint32_t init_threads, bool background)
+{
+    auto seed = std::make_shared<rx_seed>();
+
+    seed->cache = alloc_cache(flags);
+    if (seed->cache == nullptr)
+        return nullptr;
+
+    randomx_init_cache(seed->cache, key.data(), key.size());
+
+    if (flags & RANDOMX_FLAG_FULL_MEM) {
+        seed->dataset = alloc_dataset(flags);
+        if (seed->dataset == nullptr)
+            return nullptr;
+
+        init_dataset(seed->dataset, seed->cache, init_threads, background);
+
+        // full-memory VMs only read the dataset
+        randomx_release_cache(seed->cache);
+        seed->cache = nullptr;
+    }
+
+    seed->vms.resize(vm_count, nullptr);
+    seed->busy.reset(new std::atomic<bool>[vm_count]);
+
+    for (uint32_t i = 0; i < vm_count; i++) {
+        seed->busy[i].store(false);
+        seed->vms[i] = create_vm(flags, seed->cache, seed->dataset);
+
+        if (seed->vms[i] == nullptr) {
+            seed->vms.resize(i);
+            return nullptr;
+        }
+    }
+
+    return seed;
+}
+
+std::shared_ptr<rx_seed> find_seed(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    if (realm == nullptr || seed == nullptr)
+        return nullptr;
+
+    // the lookup keys are kept per thread, so once warm a lookup allocates nothing
+    static thread_local std::string realm_key, seed_key;
+    realm_key.assign(realm);
+    seed_key.assign(reinterpret_cast<const char*>(seed), seed_len);
+
+    std::lock_guard<std::mutex> lock(realms_mutex);
+
+    auto r = realms.find(realm_key);
+    if (r == realms.end())
+        return nullptr;
+
+    auto s = r->second.seeds.find(seed_key);
+    return s != r->second.seeds.end() ? s->second : nullptr;
+}
+
+void hash_one(rx_seed& s, const uint8_t* input, uint32_t input_len, uint8_t* output)
+{
+    const size_t vm = s.acquire();
+    randomx_calculate_hash(s.vms[vm], input, input_len, output);
+    s.release(vm);
+}
+
+void hash_batch(rx_seed& s, const uint8_t* const* inputs, const uint32_t* input_lengths, uint32_t count, uint8_t* outputs)
+{
+    if (count == 0)
+        return;
+
+    const size_t vm = s.acquire();
+    randomx_vm* machine = s.vms[vm];
+
+    randomx_calculate_hash_first(machine, inputs[0], input_lengths[0]);
+
+    for (uint32_t i = 1; i < count; i++)
+        randomx_calculate_hash_next(machine, inputs[i], input_lengths[i], outputs + static_cast<size_t>(i - 1) * 32);
+
+    randomx_calculate_hash_last(machine, outputs + static_cast<size_t>(count - 1) * 32);
+
+    s.release(vm);
+}
+
+/*
+ * Returns the seed, starting its preparation unless it is ready or already being prepared.
+ * A caller that needs the seed now and finds a background preparation waits for that one
+ * instead of building the seed a second time.
+ */
+seed_future start_seed(const std::string& realm, const std::string& key, randomx_flags flags, uint32_t vm_count,
+    uint32_t init_threads, bool background)
+{
+    auto promise = std::make_shared<std::promise<std::shared_ptr<rx_seed>>>();
+    seed_future future = promise->get_future().share();
+
+    {
+        std::lock_guard<std::mutex> lock(realms_mutex);
+        rx_realm& r = realms[realm];
+
+        auto s = r.seeds.find(key);
+        if (s != r.seeds.end()) {
+            promise->set_value(s->second);
+            return future;
+        }
+
+        auto p = r.pending.find(key);
+        if (p != r.pending.end())
+            return p->second.future;
+
+        r.pending[key] = pending_seed{ future, promise.get() };
+    }
+
+    auto build = [=]() {
+        if (background)
+            lower_priority();
+
+        auto prepared = build_seed(key, flags, vm_count, init_threads, background);
+
+        {
+            std::lock_guard<std::mutex> lock(realms_mutex);
+            rx_realm& r = realms[realm];
+
+            // an activation of another seed meanwhile dropped this preparation; it is freed below
+            // unless a caller waiting on it takes it
+            auto p = r.pending.find(key);
+
+            if (p != r.pending.end() && p->second.owner == promise.get()) {
+                if (prepared != nullptr)
+                    r.seeds[key] = prepared;
+
+                r.pending.erase(p);
+            }
+        }
+
+        promise->set_value(prepared);
+    };
+
+    if (background)
+        std::thread(build).detach();
+    else
+        build();
+
+    return future;
+}
+
+}
+
+extern "C" RX_REALM_API bool rx_realm_set_seed(const char* realm, const uint8_t* seed, uint32_t seed_len, int32_t flags,
+    int32_t vm_count, int32_t init_threads)
+{
+    if (realm == nullptr || seed == nullptr)
+        return false;
+
+    const std::string key(reinterpret_cast<const char*>(seed), seed_len);
+    std::shared_ptr<rx_seed> s = start_seed(realm, key, static_cast<randomx_flags>(flags), thread_count(vm_count),
+        thread_count(init_threads), false).get();
+
+    if (s == nullptr)
+        return false;
+
+    // the seed may come from a preparation an activation dropped while this call waited for it
+    std::lock_guard<std::mutex> lock(realms_mutex);
+    realms[realm].seeds.emplace(key, std::move(s));
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_realm_prepare_seed(const char* realm, const uint8_t* seed, uint32_t seed_len, int32_t flags,
+    int32_t vm_count, int32_t init_threads)
+{
+    if (realm == nullptr || seed == nullptr)
+        return false;
+
+    const std::string key(reinterpret_cast<const char*>(seed), seed_len);
+
+    start_seed(realm, key, static_cast<randomx_flags>(flags), thread_count(vm_count), thread_count(init_threads), true);
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_realm_activate_seed(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    if (realm == nullptr || seed == nullptr)
+        return false;
+
+    const std::string key(reinterpret_cast<const char*>(seed), seed_len);
+    std::vector<std::shared_ptr<rx_seed>> retired;
+
+    {
+        std::lock_guard<std::mutex> lock(realms_mutex);
+
+        auto r = realms.find(realm);
+        if (r == realms.end() || r->second.seeds.count(key) == 0)
+            return false;
+
+        // the new seed becomes current and every other one leaves the realm in the same step: the
+        // previous seed, and seeds prepared for a switch that never came (a reorg or a skipped epoch)
+        for (auto s = r->second.seeds.begin(); s != r->second.seeds.end();) {
+            if (s->first != key) {
+                retired.push_back(std::move(s->second));
+                s = r->second.seeds.erase(s);
+            } else {
+                ++s;
+            }
+        }
+
+        // preparations still running for such seeds are dropped when they finish
+        for (auto p = r->second.pending.begin(); p != r->second.pending.end();) {
+            if (p->first != key)
+                p = r->second.pending.erase(p);
+            else
+                ++p;
+        }
+
+        r->second.current = key;
+    }
+
+    // freed here, or by the last hash still running on them
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_realm_release_seed(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    if (realm == nullptr || seed == nullptr)
+        return false;
+
+    std::shared_ptr<rx_seed> released;
+
+    {
+        std::lock_guard<std::mutex> lock(realms_mutex);
+
+        auto r = realms.find(realm);
+        if (r == realms.end())
+            return false;
+
+        auto s = r->second.seeds.find(std::string(reinterpret_cast<const char*>(seed), seed_len));
+        if (s == r->second.seeds.end())
+            return false;
+
+        released = s->second;
+        r->second.seeds.erase(s);
+    }
+
+    // freed here, or by the last hash still holding it
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_realm_has_seed(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    return find_seed(realm, seed, seed_len) != nullptr;
+}
+
+extern "C" RX_REALM_API bool rx_realm_is_preparing_seed(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    if (realm == nullptr || seed == nullptr)
+        return false;
+
+    std::lock_guard<std::mutex> lock(realms_mutex);
+
+    auto r = realms.find(realm);
+    return r != realms.end() && r->second.pending.count(std::string(reinterpret_cast<const char*>(seed), seed_len)) != 0;
+}
+
+extern "C" RX_REALM_API bool rx_hash(const char* realm, const uint8_t* seed, uint32_t seed_len,
+    const uint8_t* input, uint32_t input_len, uint8_t* output)
+{
+    if (input == nullptr || output == nullptr)
+        return false;
+
+    const std::shared_ptr<rx_seed> s = find_seed(realm, seed, seed_len);
+    if (s == nullptr)
+        return false;
+
+    hash_one(*s, input, input_len, output);
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_hash_batch(const char* realm, const uint8_t* seed, uint32_t seed_len,
+    const uint8_t* const* inputs, const uint32_t* input_lengths, uint32_t count, uint8_t* outputs)
+{
+    if (inputs == nullptr || input_lengths == nullptr || outputs == nullptr)
+        return false;
+
+    const std::shared_ptr<rx_seed> s = find_seed(realm, seed, seed_len);
+    if (s == nullptr)
+        return false;
+
+    hash_batch(*s, inputs, input_lengths, count, outputs);
+    return true;
+}
+
+struct rx_seed_handle
+{
+    std::shared_ptr<rx_seed> seed;
+};
+
+extern "C" RX_REALM_API rx_seed_handle* rx_seed_open(const char* realm, const uint8_t* seed, uint32_t seed_len)
+{
+    std::shared_ptr<rx_seed> s = find_seed(realm, seed, seed_len);
+    return s != nullptr ? new rx_seed_handle{ std::move(s) } : nullptr;
+}
+
+extern "C" RX_REALM_API void rx_seed_close(rx_seed_handle* handle)
+{
+    delete handle;
+}
+
+extern "C" RX_REALM_API bool rx_seed_hash(const rx_seed_handle* handle, const uint8_t* input, uint32_t input_len, uint8_t* output)
+{
+    if (handle == nullptr || input == nullptr || output == nullptr)
+        return false;
+
+    hash_one(*handle->seed, input, input_len, output);
+    return true;
+}
+
+extern "C" RX_REALM_API bool rx_seed_hash_batch(const rx_seed_handle* handle, const uint8_t* const* inputs,
+    const uint32_t* input_lengths, uint32_t count, uint8_t* outputs)
+{
+    if (handle == nullptr || inputs == nullptr || input_lengths == nullptr || outputs == nullptr)
+        return false;
+
+    hash_batch(*handle->seed, inputs, input_lengths, count, outputs);
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef RX_REALM_H
+#define RX_REALM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef RANDOMX_H
+/*
+ * The part of RandomX's randomx.h (v1.1.10) the realm layer uses. librandomx.a is built from a
+ * checkout by build-libs-linux.sh and the header isn't kept in the tree; if it is on the include
+ * path it is used instead.
+ */
+extern "C" {
+
+typedef enum {
+    RANDOMX_FLAG_DEFAULT = 0,
+    RANDOMX_FLAG_LARGE_PAGES = 1,
+    RANDOMX_FLAG_HARD_AES = 2,
+    RANDOMX_FLAG_FULL_MEM = 4,
+    RANDOMX_FLAG_JIT = 8,
+    RANDOMX_FLAG_SECURE = 16,
+    RANDOMX_FLAG_ARGON2_SSSE3 = 32,
+    RANDOMX_FLAG_ARGON2_AVX2 = 64,
+    RANDOMX_FLAG_ARGON2 = 96
+} randomx_flags;
+
+typedef struct randomx_dataset randomx_dataset;
+typedef struct randomx_cache randomx_cache;
+typedef struct randomx_vm randomx_vm;
+
+randomx_flags randomx_get_flags(void);
+randomx_cache* randomx_alloc_cache(randomx_flags flags);
+void randomx_init_cache(randomx_cache* cache, const void* key, size_t keySize);
+void randomx_release_cache(randomx_cache* cache);
+randomx_dataset* randomx_alloc_dataset(randomx_flags flags);
+unsigned long randomx_dataset_item_count(void);
+void randomx_init_dataset(randomx_dataset* dataset, randomx_cache* cache, unsigned long startItem, unsigned long itemCount);
+void randomx_release_dataset(randomx_dataset* dataset);
+randomx_vm* randomx_create_vm(randomx_flags flags, randomx_cache* cache, randomx_dataset* dataset);
+void randomx_destroy_vm(randomx_vm* machine);
+void randomx_calculate_hash(randomx_vm* machine, const void* input, size_t inputSize, void* output);
+void randomx_calculate_hash_first(randomx_vm* machine, const void* input, size_t inputSize);
+void randomx_calculate_hash_next(randomx_vm* machine, const void* nextInput, size_t nextInputSize, void* output);
+void randomx_calculate_hash_last(randomx_vm* machine, void* output);
+
+}
+#endif
+
+#if defined(_MSC_VER)
+#define RX_REALM_API __declspec(dllexport)
+#else
+#define RX_REALM_API __attribute__((visibility("default")))
+#endif
+
+/*
+ * Realms group the seeds of one pool (one coin). Each (realm, seed) owns a single cache and, in
+ * RANDOMX_FLAG_FULL_MEM mode, a single dataset initialized by `init_threads` threads in parallel
+ * slices. Its VMs all share them and are handed out to hashing threads without locking.
+ * `vm_count` and `init_threads` <= 0 mean one per hardware thread.
+ */
+extern "C" {
+
+/* prepares the seed unless it is ready; waits for a preparation already running instead of repeating it */
+RX_REALM_API bool rx_realm_set_seed(const char* realm, const uint8_t* seed, uint32_t seed_len, int32_t flags,
+    int32_t vm_count, int32_t init_threads);
+
+/* starts preparing the seed on low-priority background threads and returns immediately */
+RX_REALM_API bool rx_realm_prepare_seed(const char* realm, const uint8_t* seed, uint32_t seed_len, int32_t flags,
+    int32_t vm_count, int32_t init_threads);
+
+/*
+ * makes a ready seed the realm's current one and drops every other seed of the realm, as
+ * rx_realm_release_seed would, along with preparations still running for them; returns false if
+ * the seed isn't ready (yet)
+ */
+RX_REALM_API bool rx_realm_activate_seed(const char* realm, const uint8_t* seed, uint32_t seed_len);
+
+/* drops the seed; hashes already running on it finish before its memory is released */
+RX_REALM_API bool rx_realm_release_seed(const char* realm, const uint8_t* seed, uint32_t seed_len);
+
+RX_REALM_API bool rx_realm_has_seed(const char* realm, const uint8_t* seed, uint32_t seed_len);
+
+/* false once a preparation has finished, failed or been dropped by an activation */
+RX_REALM_API bool rx_realm_is_preparing_seed(const char* realm, const uint8_t* seed, uint32_t seed_len);
+
+/* returns false, leaving output untouched, if the seed hasn't been set */
+RX_REALM_API bool rx_hash(const char* realm, const uint8_t* seed, uint32_t seed_len,
+    const uint8_t* input, uint32_t input_len, uint8_t* output);
+
+/* 32 bytes per input to outputs, pipelined on one VM so each hash overlaps the next one's setup */
+RX_REALM_API bool rx_hash_batch(const char* realm, const uint8_t* seed, uint32_t seed_len,
+    const uint8_t* const* inputs, const uint32_t* input_lengths, uint32_t count, uint8_t* outputs);
+
+/*
+ * A seed resolved once, for hashing without the realm and seed lookup of rx_hash. The handle keeps
+ * the seed's VMs alive, also past its release from the realm, until it is closed; null if the seed
+ * hasn't been set. A handle may be used by any number of threads at once.
+ */
+typedef struct rx_seed_handle rx_seed_handle;
+
+RX_REALM_API rx_seed_handle* rx_seed_open(const char* realm, const uint8_t* seed, uint32_t seed_len);
+RX_REALM_API void rx_seed_close(rx_seed_handle* handle);
+
+RX_REALM_API bool rx_seed_hash(const rx_seed_handle* handle, const uint8_t* input, uint32_t input_len, uint8_t* output);
+RX_REALM_API bool rx_seed_hash_batch(const rx_seed_handle* handle, const uint8_t* const* inputs,
+    const uint32_t* input_lengths, uint32_t count, uint8_t* outputs);
+
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*
+ * RandomX realm layer test and benchmark.
+ *
+ * Uses the RandomX reference test vectors for key "test key 000", as the managed RandomXTests
+ * do. Light mode is always
+ * checked; --full also builds the 2 GB dataset in four slices and reports how long that takes.
+ * The seed switch case prepares the next seed in the background and activates it.
+ *
+ *   ./test_rx_realm                run the light-mode cases
+ *   ./test_rx_realm --full         also run them on a full-memory dataset
+ *   ./test_rx_realm --benchmark    time rx_hash, rx_seed_hash and rx_hash_batch on every VM
+ */
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../native_test.h"
+#include "rx_realm.h"
+
+static const char* realm = "xmr";
+static const char* key = "test key 000";
+static const char* input1 = "This is a test";
+static const char* input2 = "Lorem ipsum dolor sit amet";
+static const char* expected1 = "639183aae1bf4c9a35884cb46b09cad9175f04efd7684e7262a0ac1c2f0b4e3f";
+static const char* expected2 = "300a0adb47603dedb42228ccb2b211104f4da45af709cd7547cd049e9489c969";
+
+static const uint8_t* seed = reinterpret_cast<const uint8_t*>(key);
+static const uint32_t seed_len = 12;
+
+static bool check_hash(const char* name, const uint8_t* hash, const char* expected)
+{
+    return test_check_hex(name, hash, 32, expected);
+}
+
+/* the batches hash input 1, input 2 and input 1 again */
+static bool check_batch(const char* name, const uint8_t* batch)
+{
+    const char* expected[3] = { expected1, expected2, expected1 };
+    char hex[65];
+
+    for (int i = 0; i < 3; i++) {
+        test_to_hex(batch + i * 32, 32, hex);
+
+        if (strcmp(hex, expected[i]) != 0)
+            return test_fail(name, "hash %d\n  expected %s\n  got      %s", i, expected[i], hex);
+    }
+
+    return test_pass(name);
+}
+
+static bool run_cases(const char* mode, int32_t flags)
+{
+    uint8_t hash[32];
+    uint8_t batch[3 * 32];
+    bool ok = true;
+    char name[96];
+
+    const double start = test_now_ns();
+
+    snprintf(name, sizeof(name), "%s: rx_realm_set_seed", mode);
+
+    if (!rx_realm_set_seed(realm, seed, seed_len, flags, 2, 4))
+        return test_fail(name, nullptr);
+
+    printf("     %s: seed ready in %.1f s, 4 init threads\n", mode, (test_now_ns() - start) / 1e9);
+
+    // setting the same seed again reuses it
+    ok &= rx_realm_set_seed(realm, seed, seed_len, flags, 2, 4);
+
+    rx_hash(realm, seed, seed_len, reinterpret_cast<const uint8_t*>(input1), strlen(input1), hash);
+    snprintf(name, sizeof(name), "%s: rx_hash input 1", mode);
+    ok &= check_hash(name, hash, expected1);
+
+    rx_hash(realm, seed, seed_len, reinterpret_cast<const uint8_t*>(input2), strlen(input2), hash);
+    snprintf(name, sizeof(name), "%s: rx_hash input 2", mode);
+    ok &= check_hash(name, hash, expected2);
+
+    const uint8_t* inputs[3] = {
+        reinterpret_cast<const uint8_t*>(input1), reinterpret_cast<const uint8_t*>(input2), reinterpret_cast<const uint8_t*>(input1) };
+    const uint32_t lengths[3] = { (uint32_t) strlen(input1), (uint32_t) strlen(input2), (uint32_t) strlen(input1) };
+
+    rx_hash_batch(realm, seed, seed_len, inputs, lengths, 3, batch);
+    snprintf(name, sizeof(name), "%s: rx_hash_batch", mode);
+    ok &= check_batch(name, batch);
+
+    // an unknown seed or realm is reported, not hashed
+    memset(hash, 0xaa, sizeof(hash));
+    snprintf(name, sizeof(name), "%s: no hash on unknown realm", mode);
+    ok &= test_check(name, !rx_hash("other", seed, seed_len, inputs[0], lengths[0], hash) && hash[0] == 0xaa);
+
+    rx_seed_handle* handle = rx_seed_open(realm, seed, seed_len);
+
+    if (handle == nullptr || rx_seed_open("other", seed, seed_len) != nullptr) {
+        snprintf(name, sizeof(name), "%s: rx_seed_open", mode);
+        rx_seed_close(handle);
+        return test_fail(name, nullptr);
+    }
+
+    rx_seed_hash(handle, inputs[1], lengths[1], hash);
+    snprintf(name, sizeof(name), "%s: rx_seed_hash", mode);
+    ok &= check_hash(name, hash, expected2);
+
+    rx_seed_hash_batch(handle, inputs, lengths, 3, batch);
+    snprintf(name, sizeof(name), "%s: rx_seed_hash_batch", mode);
+    ok &= check_batch(name, batch);
+
+    // twice as many threads as VMs: the ones finding every VM busy wait for one to come free
+    std::vector<std::thread> workers;
+    std::vector<uint8_t> contended(4 * 3 * 32);
+
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&, t]() {
+            for (int i = 0; i < 3; i++)
+                rx_seed_hash(handle, inputs[0], lengths[0], contended.data() + (t * 3 + i) * 32);
+        });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+
+    bool contended_ok = true;
+
+    for (int i = 0; i < 4 * 3; i++)
+        contended_ok &= memcmp(contended.data() + i * 32, contended.data(), 32) == 0;
+
+    snprintf(name, sizeof(name), "%s: more hashing threads than VMs", mode);
+    ok &= contended_ok ? check_hash(name, contended.data(), expected1) : test_fail(name, "hashes differ between threads");
+
+    snprintf(name, sizeof(name), "%s: release", mode);
+    ok &= test_check(name, rx_realm_release_seed(realm, seed, seed_len) && !rx_realm_has_seed(realm, seed, seed_len) &&
+        !rx_hash(realm, seed, seed_len, inputs[0], lengths[0], hash));
+
+    // an open handle keeps the released seed until it is closed
+    rx_seed_hash(handle, inputs[0], lengths[0], hash);
+    snprintf(name, sizeof(name), "%s: rx_seed_hash after release", mode);
+    ok &= check_hash(name, hash, expected1);
+    rx_seed_close(handle);
+
+    return ok;
+}
+
+static bool run_switch(int32_t flags)
+{
+    static const char* next_key = "test key 001";
+    const uint8_t* next = reinterpret_cast<const uint8_t*>(next_key);
+    uint8_t hash[32];
+    bool ok = true;
+
+    ok &= rx_realm_set_seed(realm, seed, seed_len, flags, 2, 2);
+    ok &= rx_realm_activate_seed(realm, seed, seed_len);
+
+    // the current seed keeps hashing while the next one is prepared
+    ok &= rx_realm_prepare_seed(realm, next, seed_len, flags, 2, 2);
+    ok &= rx_realm_prepare_seed(realm, next, seed_len, flags, 2, 2);
+    ok &= rx_hash(realm, seed, seed_len, reinterpret_cast<const uint8_t*>(input1), strlen(input1), hash);
+    ok &= check_hash("switch: hash during preparation", hash, expected1);
+
+    // joins the background preparation rather than starting another one
+    ok &= rx_realm_set_seed(realm, next, seed_len, flags, 2, 2);
+
+    ok = test_check("switch: activate", ok && rx_realm_activate_seed(realm, next, seed_len) && !rx_realm_has_seed(realm, seed, seed_len) &&
+        rx_realm_has_seed(realm, next, seed_len) && !rx_realm_activate_seed(realm, seed, seed_len));
+
+    // seeds prepared for a switch that never came leave the realm on the next activation
+    static const char* stale_key = "test key 002";
+    const uint8_t* stale = reinterpret_cast<const uint8_t*>(stale_key);
+
+    ok &= rx_realm_set_seed(realm, stale, seed_len, flags, 1, 2);
+    ok &= rx_realm_prepare_seed(realm, seed, seed_len, flags, 1, 2);
+
+    ok &= test_check("switch: activation drops stale seeds", rx_realm_activate_seed(realm, next, seed_len) &&
+        !rx_realm_has_seed(realm, stale, seed_len) && !rx_realm_is_preparing_seed(realm, seed, seed_len) &&
+        rx_realm_has_seed(realm, next, seed_len));
+
+    // a dropped preparation doesn't come back when it finishes, and the seed can be set again
+    ok &= test_check("switch: set after a dropped preparation", rx_realm_set_seed(realm, seed, seed_len, flags, 1, 2) &&
+        rx_realm_has_seed(realm, seed, seed_len) && !rx_realm_is_preparing_seed(realm, seed, seed_len));
+
+    rx_realm_release_seed(realm, seed, seed_len);
+    rx_realm_release_seed(realm, next, seed_len);
+    return ok;
+}
+
+static void run_benchmark(int32_t flags)
+{
+    const uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    const int per_thread = (flags & RANDOMX_FLAG_FULL_MEM) ? 200 : 20;
+
+    rx_realm_set_seed(realm, seed, seed_len, flags, 0, 0);
+    rx_seed_handle* handle = rx_seed_open(realm, seed, seed_len);
+
+    // batch 0 is single hashes on an rx_seed_handle, without the realm lookup of rx_hash
+    for (uint32_t batch_size : { 1u, 0u, 16u }) {
+        const double start = test_now_ns();
+        std::vector<std::thread> workers;
+
+        for (uint32_t t = 0; t < threads; t++) {
+            workers.emplace_back([=]() {
+                const uint32_t n = std::max(1u, batch_size);
+                std::vector<uint8_t> data(76 * n), out(32 * n);
+                std::vector<const uint8_t*> inputs(n);
+                std::vector<uint32_t> lengths(n, 76);
+
+                test_fill(data.data(), data.size());
+
+                for (uint32_t k = 0; k < n; k++)
+                    inputs[k] = data.data() + 76 * k;
+
+                for (int i = 0; i < per_thread; i += n) {
+                    data[39] = static_cast<uint8_t>(i);
+
+                    if (batch_size == 0)
+                        rx_seed_hash(handle, data.data(), 76, out.data());
+                    else if (batch_size == 1)
+                        rx_hash(realm, seed, seed_len, data.data(), 76, out.data());
+                    else
+                        rx_hash_batch(realm, seed, seed_len, inputs.data(), lengths.data(), batch_size, out.data());
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+            worker.join();
+
+        const double elapsed = (test_now_ns() - start) / 1e3;
+        const uint32_t n = std::max(1u, batch_size);
+        const uint32_t hashes = threads * ((per_thread + n - 1) / n) * n;
+
+        printf("randomx %s: %-9s %10.1f us/hash/thread on %u threads\n", (flags & RANDOMX_FLAG_FULL_MEM) ? "full " : "light",
+            batch_size == 0 ? "handle" : batch_size == 1 ? "rx_hash" : "batch 16", elapsed * threads / hashes, threads);
+    }
+
+    rx_seed_close(handle);
+    rx_realm_release_seed(realm, seed, seed_len);
+}
+
+int main(int argc, char** argv)
+{
+    const bool full = argc > 1 && strcmp(argv[1], "--full") == 0;
+    const bool benchmark = test_benchmark_requested(argc, argv);
+    const int32_t flags = randomx_get_flags();
+
+    bool ok = run_cases("light", flags);
+    ok &= run_switch(flags);
+
+    if (full)
+        ok &= run_cases("full", flags | RANDOMX_FLAG_FULL_MEM);
+
+    test_summary("RandomX realm", ok);
+
+    if (ok && benchmark)
+        run_benchmark(flags);
+
+    return ok ? 0 : 1;
+}
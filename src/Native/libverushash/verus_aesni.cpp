@@ -0,0 +1,161 @@
+// VerusHash 2.2 primitives on AES-NI, PCLMULQDQ and SSSE3 (built with -maes -mpclmul -mssse3)
+
+#include "verus_kernels.h"
+
+#include <immintrin.h>
+
+namespace {
+
+#define AES2(s0, s1, rc)                                                \
+    s0 = _mm_aesenc_si128(s0, _mm_loadu_si128((const __m128i*) (rc))); \
+    s1 = _mm_aesenc_si128(s1, _mm_loadu_si128((const __m128i*) (rc) + 1)); \
+    s0 = _mm_aesenc_si128(s0, _mm_loadu_si128((const __m128i*) (rc) + 2)); \
+    s1 = _mm_aesenc_si128(s1, _mm_loadu_si128((const __m128i*) (rc) + 3));
+
+#define AES4(s0, s1, s2, s3, rc)                                        \
+    s0 = _mm_aesenc_si128(s0, _mm_loadu_si128((const __m128i*) (rc))); \
+    s1 = _mm_aesenc_si128(s1, _mm_loadu_si128((const __m128i*) (rc) + 1)); \
+    s2 = _mm_aesenc_si128(s2, _mm_loadu_si128((const __m128i*) (rc) + 2)); \
+    s3 = _mm_aesenc_si128(s3, _mm_loadu_si128((const __m128i*) (rc) + 3)); \
+    s0 = _mm_aesenc_si128(s0, _mm_loadu_si128((const __m128i*) (rc) + 4)); \
+    s1 = _mm_aesenc_si128(s1, _mm_loadu_si128((const __m128i*) (rc) + 5)); \
+    s2 = _mm_aesenc_si128(s2, _mm_loadu_si128((const __m128i*) (rc) + 6)); \
+    s3 = _mm_aesenc_si128(s3, _mm_loadu_si128((const __m128i*) (rc) + 7));
+
+#define MIX2(s0, s1)                       \
+    tmp = _mm_unpacklo_epi32(s0, s1);      \
+    s1 = _mm_unpackhi_epi32(s0, s1);       \
+    s0 = tmp;
+
+#define MIX4(s0, s1, s2, s3)               \
+    tmp = _mm_unpacklo_epi32(s0, s1);      \
+    s0 = _mm_unpackhi_epi32(s0, s1);       \
+    s1 = _mm_unpacklo_epi32(s2, s3);       \
+    s2 = _mm_unpackhi_epi32(s2, s3);       \
+    s3 = _mm_unpacklo_epi32(s0, s2);       \
+    s0 = _mm_unpackhi_epi32(s0, s2);       \
+    s2 = _mm_unpackhi_epi32(s1, tmp);      \
+    s1 = _mm_unpacklo_epi32(s1, tmp);
+
+void haraka512_keyed_aesni(uint8_t* out, const uint8_t* in, const uint8_t* rc)
+{
+    __m128i s0 = _mm_loadu_si128((const __m128i*) in);
+    __m128i s1 = _mm_loadu_si128((const __m128i*) in + 1);
+    __m128i s2 = _mm_loadu_si128((const __m128i*) in + 2);
+    __m128i s3 = _mm_loadu_si128((const __m128i*) in + 3);
+    __m128i tmp;
+
+    for (int i = 0; i < HARAKA_ROUNDS; i++) {
+        AES4(s0, s1, s2, s3, rc + i * 128);
+        MIX4(s0, s1, s2, s3);
+    }
+
+    s0 = _mm_xor_si128(s0, _mm_loadu_si128((const __m128i*) in));
+    s1 = _mm_xor_si128(s1, _mm_loadu_si128((const __m128i*) in + 1));
+    s2 = _mm_xor_si128(s2, _mm_loadu_si128((const __m128i*) in + 2));
+    s3 = _mm_xor_si128(s3, _mm_loadu_si128((const __m128i*) in + 3));
+
+    _mm_storeu_si128((__m128i*) out, _mm_unpackhi_epi64(s0, s1));
+    _mm_storeu_si128((__m128i*) out + 1, _mm_unpacklo_epi64(s2, s3));
+}
+
+void haraka512_aesni(uint8_t* out, const uint8_t* in)
+{
+    haraka512_keyed_aesni(out, in, haraka_rc);
+}
+
+void haraka256_aesni(uint8_t* out, const uint8_t* in)
+{
+    __m128i s0 = _mm_loadu_si128((const __m128i*) in);
+    __m128i s1 = _mm_loadu_si128((const __m128i*) in + 1);
+    __m128i tmp;
+
+    for (int i = 0; i < HARAKA_ROUNDS; i++) {
+        AES2(s0, s1, haraka_rc + i * 64);
+        MIX2(s0, s1);
+    }
+
+    _mm_storeu_si128((__m128i*) out, _mm_xor_si128(s0, _mm_loadu_si128((const __m128i*) in)));
+    _mm_storeu_si128((__m128i*) out + 1, _mm_xor_si128(s1, _mm_loadu_si128((const __m128i*) in + 1)));
+}
+
+struct aesni_ops
+{
+    typedef __m128i vec;
+
+    static vec load(const uint8_t* p)
+    {
+        return _mm_load_si128((const __m128i*) p);
+    }
+
+    static void store(uint8_t* p, vec v)
+    {
+        _mm_store_si128((__m128i*) p, v);
+    }
+
+    static vec xor_(vec a, vec b)
+    {
+        return _mm_xor_si128(a, b);
+    }
+
+    static vec clmul_10(vec a)
+    {
+        return _mm_clmulepi64_si128(a, a, 0x10);
+    }
+
+    static vec mulhrs(vec a, vec b)
+    {
+        return _mm_mulhrs_epi16(a, b);
+    }
+
+    static vec aesenc(vec v, vec key)
+    {
+        return _mm_aesenc_si128(v, key);
+    }
+
+    static void mix2(vec& a, vec& b)
+    {
+        vec tmp;
+        MIX2(a, b);
+    }
+
+    static uint64_t low64(vec v)
+    {
+        return (uint64_t) _mm_cvtsi128_si64(v);
+    }
+
+    static vec from_int32(int32_t x)
+    {
+        return _mm_cvtsi32_si128(x);
+    }
+
+    static uint64_t reduce64(vec a)
+    {
+        // x^64 = x^4 + x^3 + x + 1; the product of the high half spills at most four bits,
+        // folded back through a table of their products
+        const vec c = _mm_cvtsi64_si128((1 << 4) + (1 << 3) + (1 << 1) + (1 << 0));
+        const vec q2 = _mm_clmulepi64_si128(a, c, 0x01);
+        const vec q3 = _mm_shuffle_epi8(_mm_setr_epi8(0, 27, 54, 45, 108, 119, 90, 65,
+            (char) 216, (char) 195, (char) 238, (char) 245, (char) 180, (char) 175, (char) 130, (char) 153),
+            _mm_srli_si128(q2, 8));
+
+        return (uint64_t) _mm_cvtsi128_si64(_mm_xor_si128(q3, _mm_xor_si128(q2, a)));
+    }
+};
+
+}
+
+#include "verus_clhash.h"
+
+uint64_t verusclhash_aesni(uint8_t* key, const uint8_t buf[64], uint64_t key_mask)
+{
+    return verusclhash_sv2_2<aesni_ops>(key, buf, key_mask);
+}
+
+const verus_kernels verus_kernels_aesni = {
+    "aes-ni",
+    haraka512_aesni,
+    haraka512_keyed_aesni,
+    haraka256_aesni,
+    verusclhash_aesni,
+};
@@ -0,0 +1,246 @@
+#pragma once
+
+// Internal: VerusCLHash as of VerusHash 2.2, written once over a set of 128-bit primitives V so
+// that the portable and the AES-NI/PCLMULQDQ builds run the same sequence of operations. Include
+// it only from a translation unit that defines V in an anonymous namespace; V provides
+//
+//   vec                           128-bit value, little-endian like __m128i
+//   load(p), store(p, v)
+//   xor_(a, b)
+//   clmul_10(a)                   carry-less product of a's low and high halves
+//   mulhrs(a, b)                  _mm_mulhrs_epi16
+//   aesenc(v, key)                one AES round
+//   mix2(a, b)                    Haraka256's word interleave
+//   low64(v), from_int32(x)       _mm_cvtsi128_si64, _mm_cvtsi32_si128
+//   reduce64(v)                   reduction modulo x^64 + x^4 + x^3 + x + 1
+
+#include "verus_kernels.h"
+
+namespace {
+
+template <typename V>
+inline void verus_aes2(typename V::vec& s0, typename V::vec& s1, const uint8_t* rc)
+{
+    s0 = V::aesenc(s0, V::load(rc));
+    s1 = V::aesenc(s1, V::load(rc + 16));
+    s0 = V::aesenc(s0, V::load(rc + 32));
+    s1 = V::aesenc(s1, V::load(rc + 48));
+}
+
+/*
+ * 32 rounds, each picking two key entries and one of eight operations from the accumulator,
+ * mixing the 64-byte buffer into the accumulator and writing both key entries back changed.
+ * VerusHash 2.1 hashes buf with its upper half folded into the lower one and turns case 0x18 into
+ * a second keyed loop; 2.2 widens the selector shift of both loops to 64 bits.
+ */
+template <typename V>
+uint64_t verusclhash_sv2_2(uint8_t* key, const uint8_t* buf, uint64_t key_mask)
+{
+    typedef typename V::vec vec;
+
+    const vec b0 = V::load(buf), b1 = V::load(buf + 16), b2 = V::load(buf + 32), b3 = V::load(buf + 48);
+    const vec pbuf_copy[4] = { V::xor_(b0, b2), V::xor_(b1, b3), b2, b3 };
+
+    // bytes to 16-byte entries; the entry after the addressable ones seeds the accumulator
+    key_mask >>= 4;
+    vec acc = V::load(key + (key_mask + 2) * 16);
+
+    for (int i = 0; i < 32; i++) {
+        const uint64_t selector = V::low64(acc);
+
+        uint8_t* prand = key + ((selector >> 5) & key_mask) * 16;
+        uint8_t* prandex = key + ((selector >> 32) & key_mask) * 16;
+
+        const vec* pbuf = pbuf_copy + (selector & 3);
+        const vec* pbuf_other = (selector & 1) ? pbuf - 1 : pbuf + 1;
+
+        switch (selector & 0x1c) {
+            case 0x00: {
+                const vec temp1 = V::load(prandex);
+                const vec add1 = V::xor_(temp1, *pbuf_other);
+                acc = V::xor_(V::clmul_10(add1), acc);
+
+                const vec tempa2 = V::xor_(V::mulhrs(acc, temp1), temp1);
+
+                const vec temp12 = V::load(prand);
+                V::store(prand, tempa2);
+
+                const vec add12 = V::xor_(temp12, *pbuf);
+                acc = V::xor_(V::clmul_10(add12), acc);
+
+                V::store(prandex, V::xor_(V::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 0x04: {
+                const vec temp1 = V::load(prand);
+                const vec temp2 = *pbuf;
+                acc = V::xor_(V::clmul_10(V::xor_(temp1, temp2)), acc);
+                acc = V::xor_(V::clmul_10(temp2), acc);
+
+                const vec tempa2 = V::xor_(V::mulhrs(acc, temp1), temp1);
+
+                const vec temp12 = V::load(prandex);
+                V::store(prandex, tempa2);
+
+                acc = V::xor_(V::xor_(temp12, *pbuf_other), acc);
+
+                V::store(prand, V::xor_(V::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 0x08: {
+                const vec temp1 = V::load(prandex);
+                acc = V::xor_(V::xor_(temp1, *pbuf), acc);
+
+                const vec tempa2 = V::xor_(V::mulhrs(acc, temp1), temp1);
+
+                const vec temp12 = V::load(prand);
+                V::store(prand, tempa2);
+
+                const vec temp22 = *pbuf_other;
+                acc = V::xor_(V::clmul_10(V::xor_(temp12, temp22)), acc);
+                acc = V::xor_(V::clmul_10(temp22), acc);
+
+                V::store(prandex, V::xor_(V::mulhrs(acc, temp12), temp12));
+                break;
+            }
+            case 0x0c: {
+                const vec temp1 = V::load(prand);
+                const vec add1 = V::xor_(temp1, *pbuf_other);
+
+                // bits 2 and 3 are set here, so the divisor is never zero
+                const int32_t divisor = (int32_t) (uint32_t) selector;
+
+                acc = V::xor_(add1, acc);
+
+                const int64_t dividend = (int64_t) V::low64(acc);
+                acc = V::xor_(V::from_int32((int32_t) (dividend % divisor)), acc);
+
+                const vec tempa2 = V::xor_(V::mulhrs(acc, temp1), temp1);
+
+                if (dividend & 1) {
+                    const vec temp12 = V::load(prandex);
+                    V::store(prandex, tempa2);
+
+                    const vec temp22 = *pbuf;
+                    acc = V::xor_(V::clmul_10(V::xor_(temp12, temp22)), acc);
+                    acc = V::xor_(V::clmul_10(temp22), acc);
+
+                    V::store(prand, V::xor_(V::mulhrs(acc, temp12), temp12));
+                } else {
+                    const vec tempb3 = V::load(prandex);
+                    V::store(prandex, tempa2);
+                    V::store(prand, tempb3);
+                }
+                break;
+            }
+            case 0x10: {
+                // three Haraka256 rounds keyed from the key itself
+                vec temp1 = *pbuf_other;
+                vec temp2 = *pbuf;
+
+                for (int r = 0; r < 3; r++) {
+                    verus_aes2<V>(temp1, temp2, prand + r * 64);
+                    V::mix2(temp1, temp2);
+                }
+
+                acc = V::xor_(temp2, V::xor_(temp1, acc));
+
+                const vec tempa1 = V::load(prand);
+                const vec tempa3 = V::xor_(tempa1, V::mulhrs(acc, tempa1));
+
+                const vec tempa4 = V::load(prandex);
+                V::store(prandex, tempa3);
+                V::store(prand, tempa4);
+                break;
+            }
+            case 0x14: {
+                // the monkins loop: one to eight rounds of either a carry-less product or AES
+                const vec* buftmp = pbuf_other;
+                const uint8_t* rc = prand;
+                uint64_t rounds = selector >> 61;
+                uint64_t aesroundoffset = 0;
+
+                do {
+                    if (selector & (((uint64_t) 0x10000000) << rounds)) {
+                        const vec onekey = V::load(rc);
+                        rc += 16;
+
+                        const vec temp2 = (rounds & 1) ? *pbuf : *buftmp;
+                        acc = V::xor_(V::clmul_10(V::xor_(onekey, temp2)), acc);
+                    } else {
+                        vec onekey = V::load(rc);
+                        rc += 16;
+
+                        vec temp2 = (rounds & 1) ? *buftmp : *pbuf;
+                        verus_aes2<V>(onekey, temp2, rc + aesroundoffset * 16);
+                        aesroundoffset += 4;
+                        V::mix2(onekey, temp2);
+
+                        acc = V::xor_(onekey, acc);
+                        acc = V::xor_(temp2, acc);
+                    }
+                } while (rounds--);
+
+                const vec tempa1 = V::load(prand);
+                const vec tempa3 = V::xor_(tempa1, V::mulhrs(acc, tempa1));
+
+                const vec tempa4 = V::load(prandex);
+                V::store(prandex, tempa3);
+                V::store(prand, tempa4);
+                break;
+            }
+            case 0x18: {
+                // like the monkins loop, but each round folds in either the remainder of the key
+                // entry over the selector or a carry-less product of it through mulhrs
+                const vec* buftmp = pbuf_other;
+                const uint8_t* rc = prand;
+                uint64_t rounds = selector >> 61;
+                vec onekey;
+
+                do {
+                    if (selector & (((uint64_t) 0x10000000) << rounds)) {
+                        onekey = V::xor_(V::load(rc), (rounds & 1) ? *pbuf : *buftmp);
+                        rc += 16;
+
+                        // bits 3 and 4 are set here, so the divisor is never zero
+                        const int32_t divisor = (int32_t) (uint32_t) selector;
+                        const int64_t dividend = (int64_t) V::low64(onekey);
+                        acc = V::xor_(V::from_int32((int32_t) (dividend % divisor)), acc);
+                    } else {
+                        onekey = V::clmul_10(V::xor_(V::load(rc), (rounds & 1) ? *buftmp : *pbuf));
+                        rc += 16;
+
+                        acc = V::xor_(V::mulhrs(acc, onekey), acc);
+                    }
+                } while (rounds--);
+
+                const vec tempa4 = V::xor_(V::load(prandex), acc);
+                V::store(prandex, onekey);
+                V::store(prand, tempa4);
+                break;
+            }
+            case 0x1c: {
+                const vec temp2 = V::load(prandex);
+                acc = V::xor_(V::clmul_10(V::xor_(*pbuf, temp2)), acc);
+
+                const vec tempa2 = V::xor_(V::mulhrs(acc, temp2), temp2);
+
+                const vec tempa3 = V::load(prand);
+                V::store(prand, tempa2);
+
+                acc = V::xor_(tempa3, acc);
+                acc = V::xor_(*pbuf_other, acc);
+
+                V::store(prandex, V::xor_(V::mulhrs(acc, tempa3), tempa3));
+                break;
+            }
+        }
+    }
+
+    // lazy length hash of a 1024-bit key over 64 bytes: 64 (x) 1024 carry-less, x^16
+    acc = V::xor_(acc, V::from_int32(0x10000));
+
+    return V::reduce64(acc);
+}
+
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Internal: the VerusHash 2.2 primitives, built once per instruction set.
+//
+// verus_portable.cpp is plain C++ and runs anywhere. verus_aesni.cpp needs AES-NI, PCLMULQDQ and
+// SSSE3. verus_vaes.cpp runs Haraka on VAES, all four 128-bit Haraka512 lanes in one 512-bit
+// register (two Haraka256 lanes in a 256-bit one); it shares the AES-NI CLHash. verushash.cpp
+// picks one set at load time.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "verushash.h"
+
+#define HARAKA_ROUNDS 5
+
+// CLHash addresses the first 1024 * 8 bytes of the VERUS_KEY_SIZE key; the 40 round keys after
+// them let the keyed Haraka512 start at any of those entries
+#define VERUS_CLHASH_KEY_MASK ((uint64_t) (1024 * 8 - 1))
+
+// the part of the key CLHash writes to, restored before each reuse of the key
+#define VERUS_CLHASH_KEY_REFRESH (VERUS_CLHASH_KEY_MASK + 1)
+
+typedef void (*haraka512_fn)(uint8_t* out, const uint8_t* in);
+typedef void (*haraka512_keyed_fn)(uint8_t* out, const uint8_t* in, const uint8_t* rc);
+typedef void (*haraka256_fn)(uint8_t* out, const uint8_t* in);
+
+// mutates the 16-byte aligned key; returns the 64-bit intermediate of VerusHash 2.2
+typedef uint64_t (*verusclhash_fn)(uint8_t* key, const uint8_t buf[64], uint64_t key_mask);
+
+struct verus_kernels
+{
+    const char* isa;
+    haraka512_fn haraka512;
+    haraka512_keyed_fn haraka512_keyed;
+    haraka256_fn haraka256;
+    verusclhash_fn clhash;
+};
+
+// Haraka v2 round constants, 40 x 16 bytes
+extern const uint8_t haraka_rc[40 * 16];
+
+extern const verus_kernels verus_kernels_portable;
+extern const verus_kernels verus_kernels_aesni;
+extern const verus_kernels verus_kernels_vaes;
+
+// the VAES set reuses the AES-NI CLHash, whose AES rounds are on single 128-bit values
+uint64_t verusclhash_aesni(uint8_t* key, const uint8_t buf[64], uint64_t key_mask);
+
+// the set selected for this CPU; tests switch to each set the CPU can run
+const verus_kernels& verus_active_kernels();
+void verus_set_kernels(const verus_kernels& set);
@@ -0,0 +1,62 @@
+// Haraka on VAES (built with -mvaes -mavx512f -mavx2 -maes): Haraka512's four 128-bit lanes
+// share one 512-bit register, so a round is two VAESENC and one word permutation instead of
+// eight AESENC and eight unpacks. Haraka256 runs its two lanes in a 256-bit register.
+
+#include "verus_kernels.h"
+
+#include <immintrin.h>
+
+// GCC 12's avx512fintrin.h hands _mm512_undefined_* to the permutes and then warns about it
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+namespace {
+
+void haraka512_keyed_vaes(uint8_t* out, const uint8_t* in, const uint8_t* rc)
+{
+    // MIX4's unpack sequence as one permutation of the sixteen 32-bit words
+    const __m512i mix4 = _mm512_setr_epi32(3, 11, 7, 15, 8, 0, 12, 4, 9, 1, 13, 5, 2, 10, 6, 14);
+    const __m512i input = _mm512_loadu_si512(in);
+    __m512i s = input;
+
+    for (int i = 0; i < HARAKA_ROUNDS; i++) {
+        s = _mm512_aesenc_epi128(s, _mm512_loadu_si512(rc + i * 128));
+        s = _mm512_aesenc_epi128(s, _mm512_loadu_si512(rc + i * 128 + 64));
+        s = _mm512_permutexvar_epi32(mix4, s);
+    }
+
+    s = _mm512_xor_si512(s, input);
+
+    // upper halves of lanes 0 and 1, lower halves of lanes 2 and 3
+    s = _mm512_permutexvar_epi64(_mm512_setr_epi64(1, 3, 4, 6, 0, 0, 0, 0), s);
+    _mm256_storeu_si256((__m256i*) out, _mm512_castsi512_si256(s));
+}
+
+void haraka512_vaes(uint8_t* out, const uint8_t* in)
+{
+    haraka512_keyed_vaes(out, in, haraka_rc);
+}
+
+void haraka256_vaes(uint8_t* out, const uint8_t* in)
+{
+    const __m256i mix2 = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i input = _mm256_loadu_si256((const __m256i*) in);
+    __m256i s = input;
+
+    for (int i = 0; i < HARAKA_ROUNDS; i++) {
+        s = _mm256_aesenc_epi128(s, _mm256_loadu_si256((const __m256i*) (haraka_rc + i * 64)));
+        s = _mm256_aesenc_epi128(s, _mm256_loadu_si256((const __m256i*) (haraka_rc + i * 64 + 32)));
+        s = _mm256_permutevar8x32_epi32(s, mix2);
+    }
+
+    _mm256_storeu_si256((__m256i*) out, _mm256_xor_si256(s, input));
+}
+
+}
+
+const verus_kernels verus_kernels_vaes = {
+    "vaes",
+    haraka512_vaes,
+    haraka512_keyed_vaes,
+    haraka256_vaes,
+    verusclhash_aesni,
+};
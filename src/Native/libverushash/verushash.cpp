@@ -1,386 +1,362 @@
 #include "verushash.h"
+#include "verus_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstring>
-#include <cstdlib>
-#include <memory>
+#include <functional>
+#include <mutex>
+#include <new>
 #include <thread>
-
-// CPU feature detection
-#include <cpuid.h>
-#include <immintrin.h>
+#include <vector>
 
 // VerusHash constants
 static const char* VERUS_VERSION = "2.2.0";
 
-// Haraka512 round constants (AES-based)
-static const __m128i HARAKA_RC[] = {
-    _mm_set_epi32(0x0e05ae8c, 0x2d345e69, 0x417f1b07, 0xb6707e78),
-    _mm_set_epi32(0xc6f7e2f3, 0x5c12a4a8, 0xfd7c8b85, 0x78a93ab4),
-    _mm_set_epi32(0x8c5f87ad, 0x4c9a4f5e, 0x924fddb2, 0xe1a7c3d1),
-    _mm_set_epi32(0xf43b8f5b, 0x7a94c28e, 0x85f2a641, 0x23a8c9be),
-    _mm_set_epi32(0x5c18b2d4, 0x9a7de8f1, 0xf83c6e2b, 0x41c8d956),
-    _mm_set_epi32(0x2f9db3ac, 0x8e4a7c5f, 0xb5f8d629, 0x73e1a4c2),
-    _mm_set_epi32(0x6b2c8f94, 0xe7d15a3b, 0x1f8c4d26, 0xa5b9e1c7),
-    _mm_set_epi32(0x9c5f2b84, 0x3d7a61e8, 0xf2b4c9a5, 0x8e1d756c)
+/*
+ * VerusHash 2.2
+ *
+ * The input is absorbed 32 bytes at a time: each chunk goes into the upper half of a 64-byte
+ * buffer whose lower half is the running state, and Haraka512 of the buffer becomes the next
+ * state. The last, partial chunk is left in the buffer for Finalize2b, which
+ *
+ *   1. fills the rest of the upper half with repeats of the first 16 bytes of the buffer,
+ *   2. derives an 8832-byte key by chaining Haraka256 from the state,
+ *   3. runs VerusCLHash over the buffer, mutating the key, for a 64-bit intermediate,
+ *   4. fills the upper half after the input with repeats of the intermediate and
+ *   5. hashes the buffer with Haraka512 keyed by the mutated key at an offset taken from
+ *      the intermediate.
+ */
+
+struct verushash_ctx
+{
+    alignas(32) uint8_t buf[2][64];
+    int cur;            // buffer holding the state; the other one receives the next
+    uint32_t pos;       // input bytes pending in the upper half of the current buffer
 };
 
-// VerusHash context structure
-struct verushash_ctx {
-    uint8_t buffer[VERUS_BLOCKSIZE];
-    size_t buffer_len;
-    uint64_t total_len;
-    __m128i state[4];  // 512-bit state
+struct verushash_job
+{
+    verushash_ctx prefix;           // state after the bytes before the nonce
+    std::vector<uint8_t> suffix;    // the bytes after the nonce
+    uint32_t nonce_len;
 };
 
-// CPU feature detection functions
-bool verushash_has_aes_ni() {
-    unsigned int eax, ebx, ecx, edx;
-    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
-        return (ecx & bit_AES) != 0;
-    }
-    return false;
+namespace {
+
+const verus_kernels* kernels = &verus_kernels_portable;
+
+// picked once when the library is loaded
+__attribute__((constructor)) void select_kernels()
+{
+    __builtin_cpu_init();
+
+    if (!__builtin_cpu_supports("aes") || !__builtin_cpu_supports("pclmul") || !__builtin_cpu_supports("ssse3"))
+        return;
+
+    kernels = &verus_kernels_aesni;
+
+    if (__builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2"))
+        kernels = &verus_kernels_vaes;
 }
 
-bool verushash_has_avx2() {
-    unsigned int eax, ebx, ecx, edx;
-    if (__get_cpuid_max(0, NULL) >= 7) {
-        __cpuid_count(7, 0, eax, ebx, ecx, edx);
-        return (ebx & bit_AVX2) != 0;
+/*
+ * Per-thread key buffer, reused across hashes: the key, followed by a pristine copy of the
+ * part CLHash mutates. A hash whose state matches the previous one's restores that part
+ * instead of deriving the key again.
+ */
+struct verus_key
+{
+    alignas(64) uint8_t key[VERUS_KEY_SIZE + VERUS_CLHASH_KEY_REFRESH];
+    uint8_t seed[32];
+    bool valid;
+};
+
+thread_local verus_key thread_key;
+
+uint8_t* prepare_key(const uint8_t* seed)
+{
+    verus_key& k = thread_key;
+
+    if (k.valid && memcmp(k.seed, seed, 32) == 0) {
+        memcpy(k.key, k.key + VERUS_KEY_SIZE, VERUS_CLHASH_KEY_REFRESH);
+        return k.key;
     }
-    return false;
+
+    const uint8_t* src = seed;
+
+    for (uint8_t* dst = k.key; dst < k.key + VERUS_KEY_SIZE; dst += 32) {
+        kernels->haraka256(dst, src);
+        src = dst;
+    }
+
+    memcpy(k.seed, seed, 32);
+    memcpy(k.key + VERUS_KEY_SIZE, k.key, VERUS_CLHASH_KEY_REFRESH);
+    k.valid = true;
+
+    return k.key;
 }
 
-int verushash_optimal_threads() {
-    return std::thread::hardware_concurrency();
+// fills the upper half of buf after the pending input with repeats of size bytes of src
+void fill_extra(uint8_t* buf, uint32_t pos, const void* src, uint32_t size)
+{
+    for (; pos < 32; pos += size)
+        memcpy(buf + 32 + pos, src, (32 - pos) < size ? (32 - pos) : size);
 }
 
-const char* verushash_get_version() {
-    return VERUS_VERSION;
+void verus_reset(verushash_ctx* ctx)
+{
+    memset(ctx->buf, 0, sizeof(ctx->buf));
+    ctx->cur = 0;
+    ctx->pos = 0;
 }
 
-// Software implementation of Haraka512
-void haraka512_software(const uint8_t* input, uint8_t* output) {
-    // Simplified software implementation using basic operations
-    // This is not the full Haraka512 but provides a functional substitute
-    uint32_t state[16];
-    
-    // Load input as 32-bit words
-    for (int i = 0; i < 16; i++) {
-        state[i] = ((uint32_t*)input)[i];
+void verus_write(verushash_ctx* ctx, const uint8_t* data, size_t len)
+{
+    for (size_t done = 0; done < len;) {
+        uint8_t* cur = ctx->buf[ctx->cur];
+        const size_t room = 32 - ctx->pos;
+
+        if (len - done >= room) {
+            memcpy(cur + 32 + ctx->pos, data + done, room);
+            kernels->haraka512(ctx->buf[ctx->cur ^ 1], cur);
+
+            ctx->cur ^= 1;
+            ctx->pos = 0;
+            done += room;
+        } else {
+            memcpy(cur + 32 + ctx->pos, data + done, len - done);
+            ctx->pos += (uint32_t) (len - done);
+            done = len;
+        }
     }
-    
-    // Apply 8 rounds of simple permutations
-    for (int round = 0; round < VERUS_ROUNDS; round++) {
-        // Basic round function with rotations and XORs
-        for (int i = 0; i < 16; i++) {
-            uint32_t x = state[i];
-            x ^= (x << 13) | (x >> 19);  // Rotate left 13
-            x ^= (x >> 17) | (x << 15);  // Rotate right 17
-            x += ((uint32_t*)HARAKA_RC)[i % 8];
-            state[i] = x;
+}
+
+void verus_finalize2b(verushash_ctx* ctx, uint8_t* output)
+{
+    uint8_t* cur = ctx->buf[ctx->cur];
+
+    fill_extra(cur, ctx->pos, cur, 16);
+
+    uint8_t* key = prepare_key(cur);
+    const uint64_t intermediate = kernels->clhash(key, cur, VERUS_CLHASH_KEY_MASK);
+
+    fill_extra(cur, ctx->pos, &intermediate, sizeof(intermediate));
+
+    kernels->haraka512_keyed(output, cur, key + 16 * (intermediate & (VERUS_CLHASH_KEY_MASK >> 4)));
+}
+
+/*
+ * Workers for large batches, one per hardware thread besides the caller, started with the first
+ * batch that needs them. A batch is cut into slices the workers and the calling thread claim
+ * until none are left. One batch runs on the pool at a time; a batch arriving while it is busy is
+ * hashed on its calling thread instead of waiting.
+ */
+class batch_pool
+{
+public:
+    static batch_pool& instance()
+    {
+        // never destroyed: the workers are detached and may outlive static destruction
+        static batch_pool* pool = new batch_pool();
+        return *pool;
+    }
+
+    // runs fn over [0, count) in slices of at most slice items
+    void run(uint32_t count, uint32_t slice, const std::function<void(uint32_t, uint32_t)>& fn)
+    {
+        std::unique_lock<std::mutex> busy(run_lock, std::try_to_lock);
+
+        if (!busy.owns_lock() || workers == 0) {
+            fn(0, count);
+            return;
         }
-        
-        // Simple permutation
-        if (round & 1) {
-            uint32_t temp = state[0];
-            for (int i = 0; i < 15; i++) {
-                state[i] = state[i + 1];
-            }
-            state[15] = temp;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            task_count = count;
+            task_slice = slice;
+            next.store(0);
+            active = workers;
+            generation++;
         }
+        wake.notify_all();
+
+        work(fn, count, slice);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+        task = nullptr;
     }
-    
-    // Feed-forward
-    for (int i = 0; i < 16; i++) {
-        state[i] ^= ((uint32_t*)input)[i];
+
+private:
+    batch_pool()
+    {
+        const unsigned threads = std::thread::hardware_concurrency();
+        workers = threads > 1 ? threads - 1 : 0;
+
+        for (unsigned i = 0; i < workers; i++)
+            std::thread(&batch_pool::worker, this).detach();
     }
-    
-    // Compress to 256 bits
-    for (int i = 0; i < 8; i++) {
-        ((uint32_t*)output)[i] = state[i] ^ state[i + 8];
+
+    void work(const std::function<void(uint32_t, uint32_t)>& fn, uint32_t count, uint32_t slice)
+    {
+        for (uint32_t begin; (begin = next.fetch_add(slice)) < count;)
+            fn(begin, std::min(count, begin + slice));
     }
-}
 
-#ifdef HAVE_AES_NI
-// Haraka512 implementation using AES-NI
-void haraka512_aes_ni(const uint8_t* input, uint8_t* output) {
-    // Load input into 128-bit registers
-    __m128i s0 = _mm_load_si128((__m128i*)(input + 0));
-    __m128i s1 = _mm_load_si128((__m128i*)(input + 16));
-    __m128i s2 = _mm_load_si128((__m128i*)(input + 32));
-    __m128i s3 = _mm_load_si128((__m128i*)(input + 48));
-
-    // Apply 8 rounds of AES operations
-    for (int i = 0; i < VERUS_ROUNDS; i++) {
-        // AES round function
-        s0 = _mm_aesenc_si128(s0, HARAKA_RC[i & 7]);
-        s1 = _mm_aesenc_si128(s1, HARAKA_RC[(i + 1) & 7]);
-        s2 = _mm_aesenc_si128(s2, HARAKA_RC[(i + 2) & 7]);
-        s3 = _mm_aesenc_si128(s3, HARAKA_RC[(i + 3) & 7]);
-
-        // Mix columns using shuffle
-        if (i & 1) {
-            __m128i tmp = s0;
-            s0 = s1;
-            s1 = s2;
-            s2 = s3;
-            s3 = tmp;
+    void worker()
+    {
+        uint64_t seen = 0;
+
+        for (;;) {
+            const std::function<void(uint32_t, uint32_t)>* fn;
+            uint32_t count, slice;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                fn = task;
+                count = task_count;
+                slice = task_slice;
+            }
+
+            work(*fn, count, slice);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0)
+                done.notify_one();
         }
     }
 
-    // Feed-forward and compression
-    s0 = _mm_xor_si128(s0, _mm_load_si128((__m128i*)(input + 0)));
-    s1 = _mm_xor_si128(s1, _mm_load_si128((__m128i*)(input + 16)));
-    s2 = _mm_xor_si128(s2, _mm_load_si128((__m128i*)(input + 32)));
-    s3 = _mm_xor_si128(s3, _mm_load_si128((__m128i*)(input + 48)));
+    unsigned workers;
+
+    std::mutex run_lock;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(uint32_t, uint32_t)>* task = nullptr;
+    uint32_t task_count = 0;
+    uint32_t task_slice = 0;
+    std::atomic<uint32_t> next{0};
+    unsigned active = 0;
+    uint64_t generation = 0;
+};
 
-    // Final compression to 256 bits
-    s0 = _mm_xor_si128(s0, s2);
-    s1 = _mm_xor_si128(s1, s3);
+// below this many nonces the pool's wake-up costs more than it saves
+constexpr uint32_t BATCH_POOL_MIN = 64;
+constexpr uint32_t BATCH_POOL_SLICE = 16;
 
-    // Store result
-    _mm_store_si128((__m128i*)(output + 0), s0);
-    _mm_store_si128((__m128i*)(output + 16), s1);
+void hash_range(const verushash_job* job, const uint8_t* nonces, uint32_t begin, uint32_t end, uint8_t* outputs)
+{
+    for (uint32_t i = begin; i < end; i++) {
+        verushash_ctx ctx = job->prefix;
+
+        verus_write(&ctx, nonces + (size_t) i * job->nonce_len, job->nonce_len);
+        verus_write(&ctx, job->suffix.data(), job->suffix.size());
+        verus_finalize2b(&ctx, outputs + (size_t) i * 32);
+    }
+}
+
+}
+
+const verus_kernels& verus_active_kernels()
+{
+    return *kernels;
+}
+
+void verus_set_kernels(const verus_kernels& set)
+{
+    kernels = &set;
+}
+
+// CPU feature detection functions
+bool verushash_has_aes_ni() {
+    return __builtin_cpu_supports("aes") != 0;
+}
+
+bool verushash_has_avx2() {
+    return __builtin_cpu_supports("avx2") != 0;
+}
+
+const char* verushash_get_version() {
+    return VERUS_VERSION;
+}
+
+const char* verushash_get_isa() {
+    return kernels->isa;
 }
-#endif
 
-// Main Haraka512 function that selects the best implementation
 void haraka512(const uint8_t* input, uint8_t* output) {
-#ifdef HAVE_AES_NI
-    if (verushash_has_aes_ni()) {
-        haraka512_aes_ni(input, output);
-        return;
-    }
-#endif
-    haraka512_software(input, output);
+    kernels->haraka512(output, input);
 }
 
 // VerusHash main function
 void verushash_hash(const uint8_t* input, uint8_t* output, uint32_t input_len) {
-    // Initialize with constants based on input length
-    __m128i state[4];
-    
-    // Set initial state based on input length and VerusHash constants
-    state[0] = _mm_set_epi64x(0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL);
-    state[1] = _mm_set_epi64x(0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL);
-    state[2] = _mm_set_epi64x(0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL);
-    state[3] = _mm_set_epi64x(0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL);
-
-    // Process input in 64-byte blocks
-    const uint8_t* data = input;
-    uint32_t remaining = input_len;
-    
-    while (remaining >= VERUS_BLOCKSIZE) {
-        // Prepare block for Haraka512
-        alignas(16) uint8_t block[VERUS_BLOCKSIZE];
-        memcpy(block, data, VERUS_BLOCKSIZE);
-        
-        // XOR with current state
-        for (int i = 0; i < 4; i++) {
-            __m128i data_chunk = _mm_load_si128((__m128i*)(block + i * 16));
-            state[i] = _mm_xor_si128(state[i], data_chunk);
-        }
-        
-        // Apply Haraka512 permutation
-        alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-        alignas(16) uint8_t temp_output[32];
-        
-        for (int i = 0; i < 4; i++) {
-            _mm_store_si128((__m128i*)(temp_input + i * 16), state[i]);
-        }
-        
-        haraka512(temp_input, temp_output);
-        
-        // Update state with Haraka512 result
-        state[0] = _mm_load_si128((__m128i*)(temp_output + 0));
-        state[1] = _mm_load_si128((__m128i*)(temp_output + 16));
-        
-        data += VERUS_BLOCKSIZE;
-        remaining -= VERUS_BLOCKSIZE;
-    }
-    
-    // Handle remaining bytes with padding
-    if (remaining > 0) {
-        alignas(16) uint8_t padded_block[VERUS_BLOCKSIZE] = {0};
-        memcpy(padded_block, data, remaining);
-        padded_block[remaining] = 0x80;  // Padding
-        
-        // Set length in last 8 bytes
-        *((uint64_t*)(padded_block + VERUS_BLOCKSIZE - 8)) = input_len * 8;
-        
-        // Process final block
-        for (int i = 0; i < 4; i++) {
-            __m128i data_chunk = _mm_load_si128((__m128i*)(padded_block + i * 16));
-            state[i] = _mm_xor_si128(state[i], data_chunk);
-        }
-        
-        alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-        alignas(16) uint8_t temp_output[32];
-        
-        for (int i = 0; i < 4; i++) {
-            _mm_store_si128((__m128i*)(temp_input + i * 16), state[i]);
-        }
-        
-        haraka512(temp_input, temp_output);
-        memcpy(output, temp_output, 32);
-    } else {
-        // No remaining data, output current state
-        alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-        
-        for (int i = 0; i < 4; i++) {
-            _mm_store_si128((__m128i*)(temp_input + i * 16), state[i]);
-        }
-        
-        haraka512(temp_input, output);
-    }
+    verushash_ctx ctx;
+
+    verus_reset(&ctx);
+    verus_write(&ctx, input, input_len);
+    verus_finalize2b(&ctx, output);
 }
 
 // Context-based API implementation
 verushash_ctx* verushash_create_context() {
-    verushash_ctx* ctx = (verushash_ctx*)aligned_alloc(16, sizeof(verushash_ctx));
+    verushash_ctx* ctx = new (std::nothrow) verushash_ctx;
     if (!ctx) return nullptr;
-    
-    memset(ctx->buffer, 0, VERUS_BLOCKSIZE);
-    ctx->buffer_len = 0;
-    ctx->total_len = 0;
-    
-    // Initialize state
-    ctx->state[0] = _mm_set_epi64x(0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL);
-    ctx->state[1] = _mm_set_epi64x(0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL);
-    ctx->state[2] = _mm_set_epi64x(0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL);
-    ctx->state[3] = _mm_set_epi64x(0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL);
-    
+
+    verus_reset(ctx);
     return ctx;
 }
 
 void verushash_destroy_context(verushash_ctx* ctx) {
-    if (ctx) {
-        // Clear sensitive data
-        memset(ctx, 0, sizeof(verushash_ctx));
-        free(ctx);
-    }
+    delete ctx;
 }
 
 void verushash_update(verushash_ctx* ctx, const uint8_t* data, uint32_t len) {
     if (!ctx || !data) return;
-    
-    ctx->total_len += len;
-    
-    // If buffer has data, fill it first
-    if (ctx->buffer_len > 0) {
-        uint32_t needed = VERUS_BLOCKSIZE - ctx->buffer_len;
-        uint32_t to_copy = (len < needed) ? len : needed;
-        
-        memcpy(ctx->buffer + ctx->buffer_len, data, to_copy);
-        ctx->buffer_len += to_copy;
-        data += to_copy;
-        len -= to_copy;
-        
-        // Process full buffer if ready
-        if (ctx->buffer_len == VERUS_BLOCKSIZE) {
-            // XOR buffer with state and apply Haraka512
-            for (int i = 0; i < 4; i++) {
-                __m128i data_chunk = _mm_load_si128((__m128i*)(ctx->buffer + i * 16));
-                ctx->state[i] = _mm_xor_si128(ctx->state[i], data_chunk);
-            }
-            
-            alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-            alignas(16) uint8_t temp_output[32];
-            
-            for (int i = 0; i < 4; i++) {
-                _mm_store_si128((__m128i*)(temp_input + i * 16), ctx->state[i]);
-            }
-            
-            haraka512(temp_input, temp_output);
-            
-            ctx->state[0] = _mm_load_si128((__m128i*)(temp_output + 0));
-            ctx->state[1] = _mm_load_si128((__m128i*)(temp_output + 16));
-            
-            ctx->buffer_len = 0;
-        }
-    }
-    
-    // Process complete blocks
-    while (len >= VERUS_BLOCKSIZE) {
-        // XOR data with state and apply Haraka512
-        for (int i = 0; i < 4; i++) {
-            __m128i data_chunk = _mm_load_si128((__m128i*)(data + i * 16));
-            ctx->state[i] = _mm_xor_si128(ctx->state[i], data_chunk);
-        }
-        
-        alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-        alignas(16) uint8_t temp_output[32];
-        
-        for (int i = 0; i < 4; i++) {
-            _mm_store_si128((__m128i*)(temp_input + i * 16), ctx->state[i]);
-        }
-        
-        haraka512(temp_input, temp_output);
-        
-        ctx->state[0] = _mm_load_si128((__m128i*)(temp_output + 0));
-        ctx->state[1] = _mm_load_si128((__m128i*)(temp_output + 16));
-        
-        data += VERUS_BLOCKSIZE;
-        len -= VERUS_BLOCKSIZE;
-    }
-    
-    // Store remaining data in buffer
-    if (len > 0) {
-        memcpy(ctx->buffer + ctx->buffer_len, data, len);
-        ctx->buffer_len += len;
-    }
+
+    verus_write(ctx, data, len);
 }
 
 void verushash_finalize(verushash_ctx* ctx, uint8_t* output) {
     if (!ctx || !output) return;
-    
-    // Pad the buffer
-    ctx->buffer[ctx->buffer_len] = 0x80;
-    ctx->buffer_len++;
-    
-    // If not enough space for length, pad and process block
-    if (ctx->buffer_len > VERUS_BLOCKSIZE - 8) {
-        memset(ctx->buffer + ctx->buffer_len, 0, VERUS_BLOCKSIZE - ctx->buffer_len);
-        
-        // Process this block
-        for (int i = 0; i < 4; i++) {
-            __m128i data_chunk = _mm_load_si128((__m128i*)(ctx->buffer + i * 16));
-            ctx->state[i] = _mm_xor_si128(ctx->state[i], data_chunk);
-        }
-        
-        alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-        alignas(16) uint8_t temp_output[32];
-        
-        for (int i = 0; i < 4; i++) {
-            _mm_store_si128((__m128i*)(temp_input + i * 16), ctx->state[i]);
-        }
-        
-        haraka512(temp_input, temp_output);
-        
-        ctx->state[0] = _mm_load_si128((__m128i*)(temp_output + 0));
-        ctx->state[1] = _mm_load_si128((__m128i*)(temp_output + 16));
-        
-        // Start new block
-        memset(ctx->buffer, 0, VERUS_BLOCKSIZE);
-        ctx->buffer_len = 0;
-    } else {
-        // Zero remaining bytes except for length
-        memset(ctx->buffer + ctx->buffer_len, 0, VERUS_BLOCKSIZE - 8 - ctx->buffer_len);
-    }
-    
-    // Set length in bits in last 8 bytes
-    *((uint64_t*)(ctx->buffer + VERUS_BLOCKSIZE - 8)) = ctx->total_len * 8;
-    
-    // Process final block
-    for (int i = 0; i < 4; i++) {
-        __m128i data_chunk = _mm_load_si128((__m128i*)(ctx->buffer + i * 16));
-        ctx->state[i] = _mm_xor_si128(ctx->state[i], data_chunk);
-    }
-    
-    alignas(16) uint8_t temp_input[VERUS_BLOCKSIZE];
-    
-    for (int i = 0; i < 4; i++) {
-        _mm_store_si128((__m128i*)(temp_input + i * 16), ctx->state[i]);
+
+    verus_finalize2b(ctx, output);
+}
+
+// Job-scoped batch API implementation
+verushash_job* verushash_job_create(const uint8_t* header, uint32_t header_len, uint32_t nonce_offset, uint32_t nonce_len) {
+    if (!header || nonce_offset > header_len || nonce_len > header_len - nonce_offset) return nullptr;
+
+    verushash_job* job = new (std::nothrow) verushash_job;
+    if (!job) return nullptr;
+
+    verus_reset(&job->prefix);
+    verus_write(&job->prefix, header, nonce_offset);
+
+    job->suffix.assign(header + nonce_offset + nonce_len, header + header_len);
+    job->nonce_len = nonce_len;
+    return job;
+}
+
+void verushash_job_destroy(verushash_job* job) {
+    delete job;
+}
+
+void verushash_hash_batch(const verushash_job* job, const uint8_t* nonces, uint32_t count, uint8_t* outputs) {
+    if (!job || !outputs || (!nonces && job->nonce_len)) return;
+
+    if (count < BATCH_POOL_MIN) {
+        hash_range(job, nonces, 0, count, outputs);
+        return;
     }
-    
-    haraka512(temp_input, output);
+
+    batch_pool::instance().run(count, BATCH_POOL_SLICE, [&](uint32_t begin, uint32_t end) {
+        hash_range(job, nonces, begin, end, outputs);
+    });
 }
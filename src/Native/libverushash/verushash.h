@@ -7,15 +7,14 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 
-// VerusHash 2.2 constants
-#define VERUS_KEY_SIZE 32
+// VerusHash 2.2 constants: the CLHash key derived per hash, and the Haraka512 block
+#define VERUS_KEY_SIZE (1024 * 8 + 40 * 16)
 #define VERUS_BLOCKSIZE 64
-#define VERUS_ROUNDS 8
 
-// Main hashing function
+// Main hashing function: VerusHash 2.2 of input, e.g. a serialized block header with solution
 void verushash_hash(const uint8_t* input, uint8_t* output, uint32_t input_len);
 
-// Context-based streaming API
+// Context-based streaming API, same result as verushash_hash over the concatenated updates
 typedef struct verushash_ctx verushash_ctx;
 
 verushash_ctx* verushash_create_context();
@@ -23,13 +22,28 @@ void verushash_destroy_context(verushash_ctx* ctx);
 void verushash_update(verushash_ctx* ctx, const uint8_t* data, uint32_t len);
 void verushash_finalize(verushash_ctx* ctx, uint8_t* output);
 
-// Haraka512 hash function (core of VerusHash)
+// Job-scoped hashing of inputs that differ only in a nonce: the job keeps the state absorbed up to
+// the nonce, so each hash of a batch only absorbs the nonce and the bytes after it
+typedef struct verushash_job verushash_job;
+
+// header holds any nonce at [nonce_offset, nonce_offset + nonce_len); returns NULL if that range
+// isn't inside the header
+verushash_job* verushash_job_create(const uint8_t* header, uint32_t header_len, uint32_t nonce_offset, uint32_t nonce_len);
+void verushash_job_destroy(verushash_job* job);
+
+// count nonces of the job's nonce_len bytes each, back to back, to 32 bytes per nonce in outputs;
+// large batches are spread over an internal pool of one thread per core
+void verushash_hash_batch(const verushash_job* job, const uint8_t* nonces, uint32_t count, uint8_t* outputs);
+
+// Haraka512 v2 (core of VerusHash): 64 bytes in, 32 out
 void haraka512(const uint8_t* input, uint8_t* output);
 
 // CPU feature detection
 bool verushash_has_aes_ni();
 bool verushash_has_avx2();
-int verushash_optimal_threads();
+
+// Haraka/CLHash implementation selected for this CPU: "vaes", "aes-ni" or "portable"
+const char* verushash_get_isa();
 
 // Library information
 const char* verushash_get_version();
@@ -0,0 +1,125 @@
+/*
+ * Helpers shared by the test programs of the native libraries (test_*.c and test_*.cpp).
+ *
+ * Every test prints one line per check, "ok   name" or "FAIL name" followed by indented
+ * expected/got lines, ends with a summary line and exits non-zero if a check failed. Run with
+ * --benchmark, it then also times what it checked. Inputs that are not protocol vectors are
+ * filled with buf[i] = i * 7 + 1, the pattern native_bench hashes too.
+ *
+ * Plain C99, so the C tests of libmultihash and libblake3 include it as well as the C++ ones.
+ */
+
+#ifndef NATIVE_TEST_H
+#define NATIVE_TEST_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* hex must hold 2 * len + 1 characters */
+static inline void test_to_hex(const uint8_t* in, size_t len, char* hex)
+{
+    static const char digits[] = "0123456789abcdef";
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hex[i * 2] = digits[in[i] >> 4];
+        hex[i * 2 + 1] = digits[in[i] & 0xf];
+    }
+
+    hex[len * 2] = 0;
+}
+
+static inline void test_from_hex(const char* hex, uint8_t* out, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        sscanf(hex + i * 2, "%2hhx", &out[i]);
+}
+
+/* buf[i] = i * 7 + 1 */
+static inline void test_fill(uint8_t* buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = (uint8_t) (i * 7 + 1);
+}
+
+static inline bool test_pass(const char* name)
+{
+    printf("ok   %s\n", name);
+    return true;
+}
+
+/* prints the failed check and, unless detail is null, one indented line of printf-style detail */
+static inline bool test_fail(const char* name, const char* detail, ...)
+{
+    printf("FAIL %s\n", name);
+
+    if (detail != NULL) {
+        va_list args;
+
+        va_start(args, detail);
+        printf("  ");
+        vprintf(detail, args);
+        printf("\n");
+        va_end(args);
+    }
+
+    return false;
+}
+
+static inline bool test_check(const char* name, bool passed)
+{
+    return passed ? test_pass(name) : test_fail(name, NULL);
+}
+
+/* compares len bytes against lowercase hex */
+static inline bool test_check_hex(const char* name, const uint8_t* got, size_t len, const char* expected)
+{
+    char hex[2 * 256 + 1];
+
+    if (len > 256)
+        return test_fail(name, "%zu bytes is more than test_check_hex compares", len);
+
+    test_to_hex(got, len, hex);
+
+    if (strcmp(hex, expected) != 0) {
+        printf("FAIL %s\n  expected %s\n  got      %s\n", name, expected, hex);
+        return false;
+    }
+
+    return test_pass(name);
+}
+
+/* prints the summary line of a test program; returns ok */
+static inline bool test_summary(const char* suite, bool ok)
+{
+    if (ok)
+        printf("All %s checks passed\n", suite);
+    else
+        printf("%s checks FAILED\n", suite);
+
+    return ok;
+}
+
+static inline bool test_benchmark_requested(int argc, char** argv)
+{
+    return argc > 1 && strcmp(argv[1], "--benchmark") == 0;
+}
+
+static inline double test_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+#endif